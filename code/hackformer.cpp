@@ -13,6 +13,19 @@ void initSpatialPartition(GameState* gameState) {
 	gameState->chunks = pushArray(&gameState->levelStorage, EntityChunk, numChunks);
 
 	memset(gameState->chunks, 0, numChunks * sizeof(EntityChunk));
+
+	StaticTileLayer* staticTiles = &gameState->staticTiles;
+	staticTiles->chunkSize = v2(TILE_WIDTH_IN_METERS, TILE_HEIGHT_WITHOUT_OVERHANG_IN_METERS) * STATIC_TILE_CHUNK_SIZE;
+	staticTiles->chunksWidth = (s32)ceil(gameState->mapSize.x / staticTiles->chunkSize.x);
+	staticTiles->chunksHeight = (s32)ceil(gameState->mapSize.y / staticTiles->chunkSize.y);
+	staticTiles->glowTime = 0;
+
+	s32 numStaticTileChunks = staticTiles->chunksWidth * staticTiles->chunksHeight;
+	staticTiles->chunks = pushArray(&gameState->levelStorage, StaticTileChunk, numStaticTileChunks);
+	memset(staticTiles->chunks, 0, numStaticTileChunks * sizeof(StaticTileChunk));
+
+	initProjectilePool(gameState);
+	resetBroadPhase(gameState);
 }
 
 void loadWaypoints(IOStream* stream, Entity* entity, GameState* gameState) {
@@ -212,7 +225,133 @@ void loadHackMap(GameState* gameState, char* fileName) {
 	freeIostream(stream);
 }
 
+//NOTE: The textures of these entities are only kept resident in the levels which have them (see 
+//		requestLevelTextures), every other texture is always resident. The textures of spawned entities and 
+//		projectiles are included with the entity which makes them.
+struct LevelTextureAssets {
+	EntityType type;
+	AssetId assets[24]; //Ends with 0
+};
+
+#define TROJAN_TEXTURE_ASSETS Asset_trojanShoot, Asset_trojanDisappear, Asset_trojanFull, Asset_trojanBolt, \
+							  Asset_trojanBoltDeath
+#define TRAWLER_TEXTURE_ASSETS Asset_trawlerRightFrame, Asset_trawlerBody, Asset_trawlerWheel, Asset_trawlerShoot, \
+							   Asset_trawlerBootUp, Asset_trawlerBolt, Asset_trawlerBoltDeath
+#define SHRIKE_TEXTURE_ASSETS Asset_shrikeShoot, Asset_shrikeStand, Asset_shrikeBootUp, Asset_trawlerBolt, \
+							  Asset_trawlerBoltDeath
+
+static LevelTextureAssets globalLevelTextureAssets[] = {
+	{EntityType_trojan, {TROJAN_TEXTURE_ASSETS}},
+	{EntityType_trawler, {TRAWLER_TEXTURE_ASSETS}},
+	{EntityType_shrike, {SHRIKE_TEXTURE_ASSETS}},
+	{EntityType_motherShip, {Asset_motherShipEmitter, Asset_motherShipBase, Asset_motherShipRotator1, 
+							 Asset_motherShipRotator2, Asset_motherShipRotator3, Asset_motherShipProjectileSmoking, 
+							 Asset_motherShipShoot, Asset_motherShipProjectileDeath, 
+							 TRAWLER_TEXTURE_ASSETS, SHRIKE_TEXTURE_ASSETS}},
+	{EntityType_laserBase, {Asset_virus3BaseOff, Asset_virus3BaseOn, Asset_virus3TopOff, Asset_virus3TopOn, 
+							Asset_virus3LaserBeam}},
+};
+
+#undef TROJAN_TEXTURE_ASSETS
+#undef TRAWLER_TEXTURE_ASSETS
+#undef SHRIKE_TEXTURE_ASSETS
+
+void setLevelTextureAssets(RenderGroup* group, EntityType type, TextureSet set, bool32 inSet) {
+	for(s32 entryIndex = 0; entryIndex < arrayCount(globalLevelTextureAssets); entryIndex++) {
+		LevelTextureAssets* entry = globalLevelTextureAssets + entryIndex;
+
+		if(entry->type == type) {
+			for(s32 assetIndex = 0; entry->assets[assetIndex]; assetIndex++) {
+				setAssetTextureSet(group, entry->assets[assetIndex], set, inSet);
+			}
+		}
+	}
+}
+
+//NOTE: This takes the textures which are only used by some levels out of TextureSet_always
+void initLevelTextureSets(GameState* gameState) {
+	RenderGroup* group = gameState->renderGroup;
+
+	for(s32 entryIndex = 0; entryIndex < arrayCount(globalLevelTextureAssets); entryIndex++) {
+		setLevelTextureAssets(group, globalLevelTextureAssets[entryIndex].type, TextureSet_always, false);
+	}
+
+	for(s32 bgIndex = 0; bgIndex < Background_count; bgIndex++) {
+		BackgroundTexture* bt = gameState->backgroundTextures.textures + bgIndex;
+		setAssetTextureSet(group, bt->bgId, TextureSet_always, false);
+		setAssetTextureSet(group, bt->mgId, TextureSet_always, false);
+	}
+}
+
+//NOTE: This replaces the assets in the set with the ones which are needed by the background and the entities 
+//		of the map. The map is only read up to the entity types, nothing is added to the game.
+void requestLevelTextures(GameState* gameState, char* fileName, TextureSet set) {
+	RenderGroup* group = gameState->renderGroup;
+	if(!group->residency.enabled) return;
+
+	clearTextureSet(group, set);
+
+	char filePath[2000];
+	assert(strlen(fileName) < arrayCount(filePath) - 100);
+	sprintf(filePath, "maps/%s.hack", fileName);
+
+	IOStream streamObj = createIostream(gameState, filePath, true);
+	IOStream* stream = &streamObj;
+	if(!stream->file) return;
+
+	//NOTE: The waypoints and messages are read into the level storage and thrown away
+	MemoryArena* scratch = &gameState->levelStorage;
+	size_t scratchAllocated = scratch->allocated;
+
+	s32 mapWidthInTiles, mapHeightInTiles;
+	streamElem(stream, mapWidthInTiles);
+	streamElem(stream, mapHeightInTiles);
+
+	s32 initialEnergy;
+	streamElem(stream, initialEnergy);
+
+	HackAbilities hackAbilities;
+	streamHackAbilities(stream, &hackAbilities);
+
+	BackgroundType bgType;
+	streamElem(stream, bgType);
+	BackgroundTexture* bt = gameState->backgroundTextures.textures + bgType;
+	setAssetTextureSet(group, bt->bgId, set, true);
+	setAssetTextureSet(group, bt->mgId, set, true);
+
+	s32 seekResult = fseek(stream->file, mapWidthInTiles * mapHeightInTiles * sizeof(s32), SEEK_CUR);
+	assert(seekResult == 0);
+
+	s32 numEntities;
+	streamElem(stream, numEntities);
+
+	for(s32 entityIndex = 0; entityIndex < numEntities; entityIndex++) {
+		EntityType entityType;
+		streamElem(stream, entityType);
+
+		V2 p;
+		streamV2(stream, &p);
+
+		if(entityType == EntityType_trojan) {
+			Waypoint* waypoints = NULL;
+			streamWaypoints(stream, &waypoints, scratch, true, false);
+		} 
+		else if(entityType == EntityType_text) {
+			Messages* messages;
+			streamMessages(stream, &messages, scratch);
+		}
+
+		setLevelTextureAssets(group, entityType, set, true);
+	}
+
+	scratch->allocated = scratchAllocated;
+	freeIostream(stream);
+}
+
 void freeLevel(GameState* gameState, bool loadingFromCheckpoint) {
+	//NOTE: The frame which is being drawn can refer to textures and messages in the level storage
+	acquireRenderResources(gameState->renderGroup);
+
 	for (s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
 		freeEntityAtLevelEnd(gameState->entities + entityIndex, gameState, loadingFromCheckpoint);
 	}
@@ -225,6 +364,8 @@ void freeLevel(GameState* gameState, bool loadingFromCheckpoint) {
 	gameState->refNodeFreeList = NULL;
 	gameState->messagesFreeList = NULL;
 	gameState->waypointFreeList = NULL;
+	gameState->tileMoveFreeList = NULL;
+	gameState->tileMoveNodeFreeList = NULL;
 	gameState->fadingOutConsoles = NULL;
 	gameState->targetRefs = NULL;
 	gameState->guardTargetRefs = NULL;
@@ -240,6 +381,7 @@ void freeLevel(GameState* gameState, bool loadingFromCheckpoint) {
 	gameState->consoleEntityRef = 0;
 	gameState->playerRef = 0;
 	gameState->numEntities = 0;
+	gameState->projectiles.count = 0;
 	gameState->fieldSpec.hackEnergy = 0;
 	gameState->levelStorage.allocated = 0;
 
@@ -266,6 +408,24 @@ bool loadCheckPoint(GameState* gameState) {
 	return true;
 }
 
+//NOTE: The gravity and time fields are made again for every level
+void addGlobalFields(GameState* gameState) {
+	double topFieldYOffset = 1.05;
+	{
+		double gravityValues[] = {-9.8, -4.9, 0, 4.9, 9.8};
+		s32 gravityFieldModifyCost = 10;
+		gameState->gravityField = createPrimitiveField(double, gameState, (char*)"gravity", gravityValues, arrayCount(gravityValues), 0, gravityFieldModifyCost);
+		gameState->gravityField->p = v2(2.25, gameState->windowSize.y - topFieldYOffset);
+	}
+
+	{
+		double timeValues[] = {0, 0.2, 0.5, 1, 2};
+		s32 timeFieldModifyCost = 10;
+		gameState->timeField = createPrimitiveField(double, gameState, (char*)"time", timeValues, arrayCount(timeValues), 3, timeFieldModifyCost);
+		gameState->timeField->p = v2(gameState->windowSize.x - 2.4, gameState->windowSize.y - topFieldYOffset);
+	}
+}
+
 void loadLevel(GameState* gameState, s32* mapFileIndex, bool firstLevelLoad, bool loadNextLevel) {
 	//TODO: no need to print the name of every map just to load one map
 	char maps[20][100];
@@ -287,31 +447,20 @@ void loadLevel(GameState* gameState, s32* mapFileIndex, bool firstLevelLoad, boo
 	freeLevel(gameState);
 
 	gameState->random = createRandom(RANDOM_MAX / 2);
+	addGlobalFields(gameState);
 
-	double topFieldYOffset = 1.05;
-	{
-		double gravityValues[] = {-9.8, -4.9, 0, 4.9, 9.8};
-		s32 gravityFieldModifyCost = 10;
-		gameState->gravityField = createPrimitiveField(double, gameState, (char*)"gravity", gravityValues, arrayCount(gravityValues), 0, gravityFieldModifyCost);
-		gameState->gravityField->p = v2(2.25, gameState->windowSize.y - topFieldYOffset);
-	}
-
-	{
-		double timeValues[] = {0, 0.2, 0.5, 1, 2};
-		s32 timeFieldModifyCost = 10;
-		gameState->timeField = createPrimitiveField(double, gameState, (char*)"time", timeValues, arrayCount(timeValues), 3, timeFieldModifyCost);
-		gameState->timeField->p = v2(gameState->windowSize.x - 2.4, gameState->windowSize.y - topFieldYOffset);
-	}
+	//NOTE: The textures of the next level are streamed in while this one is being played
+	requestLevelTextures(gameState, maps[*mapFileIndex], TextureSet_currentLevel);
+	requestLevelTextures(gameState, maps[(*mapFileIndex + 1) % arrayCount(maps)], TextureSet_nextLevel);
 
 	loadHackMap(gameState, maps[*mapFileIndex]);
+	updateTextureResidency(gameState->renderGroup);
 
 	gameState->doingInitialSim = true;
 	gameState->renderGroup->enabled = false;
 
-	double timeStep = 1.0 / 60.0;
-
 	for (s32 frame = 0; frame < 30; frame++) {
-		updateAndRenderEntities(gameState, timeStep);
+		updateAndRenderEntities(gameState, SIM_STEP_SECONDS);
 	}
 
 	gameState->renderGroup->enabled = true;
@@ -419,8 +568,11 @@ void translateButton(Button* button, V2 translation) {
 	button->renderBounds = translateRect(button->renderBounds, translation);
 }
 
-void drawAnimatedBackground(GameState* gameState, Texture* background, Animation* backgroundAnim, double animTime) {
+//NOTE: The frames already have the background in them, so the first one is drawn over the whole screen and the second
+//		one is only blended in where it is different from the first one
+void drawAnimatedBackground(GameState* gameState, CompositedAnimation* composited, double animTime) {
 	R2 windowBounds = r2(v2(0, 0), gameState->windowSize);
+	Animation* backgroundAnim = &composited->anim;
 
 	Texture* frame1 = getAnimationFrame(backgroundAnim, animTime);
 	Texture* frame2 = getAnimationFrame(backgroundAnim, animTime + backgroundAnim->secondsPerFrame);
@@ -430,16 +582,48 @@ void drawAnimatedBackground(GameState* gameState, Texture* background, Animation
 
 	assert(frameIndexPercent >= 0 && frameIndexPercent <= 1);
 
-	int frame1Alpha = (int)(255 * (1 - frameIndexPercent) + 0.5);
-	int frame2Alpha = 255 - frame1Alpha;
-
-	Color frame1Color = createColor(255, 255, 255, frame1Alpha);
+	int frame2Alpha = (int)(255 * frameIndexPercent + 0.5);
 	Color frame2Color = createColor(255, 255, 255, frame2Alpha);
 
-	pushTexture(gameState->renderGroup, background, windowBounds, false, false, DrawOrder_gui, false);
-	pushTexture(gameState->renderGroup, frame1, windowBounds, false, false, DrawOrder_gui, false, Orientation_0, frame1Color);
-	pushTexture(gameState->renderGroup, frame2, windowBounds, false, false, DrawOrder_gui, false, Orientation_0, frame2Color);
+	pushTexture(gameState->renderGroup, frame1, windowBounds, false, false, DrawOrder_gui, false);
+
+	Texture* delta = getCompositedDelta(composited, frame1, frame2);
+
+	if(delta && frame2Alpha) {
+		pushTexture(gameState->renderGroup, delta, windowBounds, false, false, DrawOrder_gui, false, Orientation_0, frame2Color);
+	}
+}
+
+#if LIGHTING_BENCHMARK
+//NOTE: This covers the screen with a grid of moving point lights and a row of sweeping spot lights.
+//		Turn on SHOW_RENDER_STATS to see how many lights reach each screen tile.
+void pushLightingBenchmark(RenderGroup* group, V2 windowSize, double time) {
+	s32 gridWidth = 24;
+	s32 gridHeight = 14;
+	V2 spacing = v2(windowSize.x / gridWidth, windowSize.y / gridHeight);
+
+	for(s32 y = 0; y < gridHeight; y++) {
+		for(s32 x = 0; x < gridWidth; x++) {
+			double phase = time + x * 0.7 + y * 1.3;
+			V2 p = hadamard(v2(x + 0.5, y + 0.5), spacing) + v2(cos(phase), sin(phase)) * 0.3;
+			V3 color = v3(0.5 + 0.5 * sin(phase), 0.5 + 0.5 * sin(phase + TAU / 3), 0.5 + 0.5 * sin(phase + 2 * TAU / 3)) * 0.3;
+
+			PointLight light = createPointLight(v3(p, 0), color, 1.5);
+			pushPointLight(group, &light);
+		}
+	}
+
+	s32 numSpotLights = 64;
+
+	for(s32 lightIndex = 0; lightIndex < numSpotLights; lightIndex++) {
+		V2 p = v2((lightIndex + 0.5) * windowSize.x / numSpotLights, windowSize.y);
+		double angle = -PI / 2 + sin(time + lightIndex * 0.4);
+
+		SpotLight light = createSpotLight(p, v3(1, 1, 0.9) * 0.4, 6, angle, 30);
+		pushSpotLight(group, &light);
+	}
 }
+#endif
 
 void clearInput(Input* input) {
 	input->mouseInPixels = {};
@@ -454,6 +638,20 @@ void clearInput(Input* input) {
 	}
 }
 
+void clearJustPressed(Input* input) {
+	for(s32 keyIndex = 0; keyIndex < arrayCount(input->keys); keyIndex++) {
+		Key* key = input->keys + keyIndex;
+		key->justPressed = false;
+	}
+}
+
+void addJustPressed(Input* input, Input* presses) {
+	for(s32 keyIndex = 0; keyIndex < arrayCount(input->keys); keyIndex++) {
+		Key* key = input->keys + keyIndex;
+		if(presses->keys[keyIndex].justPressed) key->justPressed = true;
+	}
+}
+
 Music loadMusic(MusicState* state, AssetId id) {
 	Music result = {};
 
@@ -501,9 +699,19 @@ void initMusic(MusicState* musicState, GameState* gameState) {
 #endif
 }
 
-GameState* createGameState(s32 windowWidth, s32 windowHeight) {
+char* getSaveFilePath(char* saveFileName, MemoryArena* arena) {
+	char* fileWritePath = SDL_GetPrefPath("DVJ Games", "Hackformer");
+	assert(fileWritePath);
+	char* saveFilePath = pushArray(arena, char, strlen(fileWritePath) + strlen(saveFileName) + 1);
+	assert(saveFilePath);
+	sprintf(saveFilePath, "%s%s", fileWritePath, saveFileName);
+	SDL_free(fileWritePath);
+	return saveFilePath;
+}
+
+GameState* createGameState(s32 windowWidth, s32 windowHeight, RenderBackend backend, size_t textureBudget) {
 	MemoryArena arena_;
-	initArena(&arena_, MEGABYTES(8), true);
+	initArena(&arena_, MEGABYTES(16), true);
 
 	GameState* gameState = pushStruct(&arena_, GameState);
 	gameState->permanentStorage = arena_;
@@ -531,7 +739,12 @@ GameState* createGameState(s32 windowWidth, s32 windowHeight) {
 
 	gameState->renderGroup = createRenderGroup(256 * 1024, &gameState->permanentStorage, gameState->pixelsPerMeter, 
 		gameState->windowWidth, gameState->windowHeight, &gameState->camera,
-		gameState->textures, &gameState->texturesCount, assets);
+		gameState->textures, &gameState->texturesCount, assets, backend,
+		getSaveFilePath((char*)PROGRAM_CACHE_FILE_NAME, &gameState->permanentStorage), 
+		backend == RenderBackend_gl ? textureBudget : 0);
+	gameState->renderGroup->lightingEnabled = ENABLE_LIGHTING;
+
+	initEntityRenderPass(gameState);
 
 	initInputKeyCodes(&gameState->input);
 
@@ -591,8 +804,7 @@ void initPauseMenu(GameState* gameState) {
 
 	RenderGroup* group = gameState->renderGroup;
 
-	pauseMenu->background = loadPNGTexture(group, Asset_pauseMenuBg, false);
-	pauseMenu->backgroundAnim = loadAnimation(group, Asset_pauseMenuAnim, 1280, 720, 1.f, true);
+	pauseMenu->backgroundAnim = loadCompositedAnimation(group, Asset_pauseMenuBg, Asset_pauseMenuAnim, 1280, 720, 1.f, true);
 
 	pauseMenu->quit = createPauseMenuButton(gameState, Asset_pauseMenuQuitButton, v2(15.51, 2.62), 1.5);
 	pauseMenu->restart = createPauseMenuButton(gameState, Asset_pauseMenuRestartButton, v2(6.54, 4.49), 1.1);
@@ -605,8 +817,7 @@ void initMainMenu(GameState* gameState) {
 
 	RenderGroup* group = gameState->renderGroup;
 
-	mainMenu->background = loadPNGTexture(group, Asset_mainMenuBg, false);
-	mainMenu->backgroundAnim = loadAnimation(group, Asset_mainMenuAnim, 1280, 720, 1.f, true);
+	mainMenu->backgroundAnim = loadCompositedAnimation(group, Asset_mainMenuBg, Asset_mainMenuAnim, 1280, 720, 1.f, true);
 
 	double mainMenuButtonHeight = 0.6;
 	mainMenu->play = createPauseMenuButton(gameState, Asset_mainMenuPlayButton, v2(10, 6), mainMenuButtonHeight);
@@ -614,16 +825,6 @@ void initMainMenu(GameState* gameState) {
 	mainMenu->quit = createPauseMenuButton(gameState, Asset_mainMenuQuitButton, v2(12, 3.2), mainMenuButtonHeight);
 }
 
-char* getSaveFilePath(char* saveFileName, MemoryArena* arena) {
-	char* fileWritePath = SDL_GetPrefPath("DVJ Games", "Hackformer");
-	assert(fileWritePath);
-	char* saveFilePath = pushArray(arena, char, strlen(fileWritePath) + strlen(saveFileName) + 1);
-	assert(saveFilePath);
-	sprintf(saveFilePath, "%s%s", fileWritePath, saveFileName);
-	SDL_free(fileWritePath);
-	return saveFilePath;
-}
-
 void loadImages(GameState* gameState) {
 	RenderGroup* renderGroup = gameState->renderGroup;
 
@@ -755,11 +956,203 @@ void loadImages(GameState* gameState) {
 	gameState->checkPointUnreached = loadPNGTexture(renderGroup, Asset_checkPointUnreached);
 }
 
+//NOTE: This is used to log how long each phase of startup took
+struct StartupTimer {
+	u64 startTime;
+	u64 phaseStartTime;
+};
+
+double getSecondsSince(u64 time) {
+	double result = (double)(SDL_GetPerformanceCounter() - time) / (double)SDL_GetPerformanceFrequency();
+	return result;
+}
+
+void logStartupPhase(StartupTimer* timer, char* name) {
+	printf("Startup %s: %.1fms\n", name, getSecondsSince(timer->phaseStartTime) * 1000.0);
+	timer->phaseStartTime = SDL_GetPerformanceCounter();
+}
+
+//NOTE: This is the level which -benchmark simulates after the shipped levels. It has a floor and a ceiling of tiles
+//		with columns of heavy tiles between them. The gravity is flipped every BENCHMARK_GRAVITY_FLIP_STEPS, so the 
+//		columns keep falling into each other instead of going to sleep.
+void loadBenchmarkLevel(GameState* gameState, s32 numBodies) {
+	freeLevel(gameState);
+
+	gameState->random = createRandom(RANDOM_MAX / 2);
+	addGlobalFields(gameState);
+
+	V2 tileSize = v2(TILE_WIDTH_IN_METERS, TILE_HEIGHT_WITHOUT_OVERHANG_IN_METERS);
+	s32 numColumns = (numBodies + BENCHMARK_STACK_HEIGHT - 1) / BENCHMARK_STACK_HEIGHT + 1;
+	s32 numRows = (s32)(gameState->windowSize.y / tileSize.y);
+	assert(numRows >= BENCHMARK_STACK_HEIGHT + 3);
+
+	gameState->mapSize = hadamard(v2(numColumns, numRows), tileSize);
+	gameState->worldSize = maxComponents(gameState->mapSize, gameState->windowSize);
+
+	initSpatialPartition(gameState);
+
+	Entity* testEntity = addEntity(gameState, EntityType_test, DrawOrder_test, v2(0, 0), v2(0, 0));
+	setFlags(testEntity, EntityFlag_noMovementByDefault);
+	gameState->testEntityRef = testEntity->ref;
+
+	for(s32 column = 0; column < numColumns; column++) {
+		addTile(gameState, hadamard(v2(column + 0.5, 0.5), tileSize), Tile_middle, false, false);
+		addTile(gameState, hadamard(v2(column + 0.5, numRows - 0.5), tileSize), Tile_middle, false, true);
+	}
+
+	//NOTE: The first column is left empty for the player
+	addPlayer(gameState, hadamard(v2(0.5, 1.5), tileSize) + v2(0, 0.5));
+
+	s32 bodiesAdded = 0;
+
+	for(s32 column = 1; column < numColumns; column++) {
+		for(s32 row = 1; row <= BENCHMARK_STACK_HEIGHT && bodiesAdded < numBodies; row++) {
+			addHeavyTile(gameState, hadamard(v2(column + 0.5, row + 0.5), tileSize) + v2(0, 0.5), false, false);
+			bodiesAdded++;
+		}
+	}
+
+	gameState->gravity = v2(0, -9.8);
+}
+
+//NOTE: Returns the average time per step in seconds
+double benchmarkSteps(GameState* gameState, s32 steps, bool flipGravity) {
+	gameState->renderGroup->enabled = false;
+	u64 startTime = SDL_GetPerformanceCounter();
+
+	for(s32 step = 0; step < steps; step++) {
+		if(flipGravity && step > 0 && step % BENCHMARK_GRAVITY_FLIP_STEPS == 0) {
+			gameState->gravity = -gameState->gravity;
+		}
+
+		updateAndRenderEntities(gameState, SIM_STEP_SECONDS);
+		removeEntities(gameState);
+	}
+
+	double result = getSecondsSince(startTime) / steps;
+	gameState->renderGroup->enabled = true;
+
+	return result;
+}
+
+void printBenchmarkResult(GameState* gameState, char* levelName, double secondsPerStep) {
+	BroadPhase* broadPhase = &gameState->broadPhase;
+
+	printf("Benchmark %s: %d entities, %.3fms per step, %d broad phase pairs, %d endpoint swaps, %d endpoint refreshes\n", 
+		   levelName, gameState->numEntities, secondsPerStep * 1000.0, broadPhase->numPairs, broadPhase->numSwaps,
+		   broadPhase->numRefreshes);
+}
+
+//NOTE: Simulates every shipped level and then the synthetic benchmark level for the same number of fixed steps. 
+//		Nothing is drawn and there is no input, so the runs are the same every time. 
+void runBenchmark(GameState* gameState, s32 steps) {
+	char levelName[100];
+
+	for(s32 mapFileIndex = 0; ; mapFileIndex++) {
+		char filePath[200];
+		sprintf(levelName, "level_%d", mapFileIndex + 1);
+		sprintf(filePath, "maps/%s.hack", levelName);
+
+		FILE* file = fopen(filePath, "rb");
+		if(!file) break;
+		fclose(file);
+
+		//NOTE: This clears the checkpoints, so loadLevel doesn't load one from the last level
+		freeLevel(gameState);
+
+		s32 levelIndex = mapFileIndex;
+		loadLevel(gameState, &levelIndex, true, false);
+		gameState->gravity = v2(0, -9.8);
+
+		printBenchmarkResult(gameState, levelName, benchmarkSteps(gameState, steps, false));
+	}
+
+	loadBenchmarkLevel(gameState, BENCHMARK_BODIES);
+	sprintf(levelName, "synthetic_%d", BENCHMARK_BODIES);
+	printBenchmarkResult(gameState, levelName, benchmarkSteps(gameState, steps, true));
+}
+
+//NOTE: The game's threads are stopped (and the streaming file closed) before the GL context and the window are destroyed
+void shutdownGame(GameState* gameState, SDL_Window* window) {
+	shutdownEntityRenderPass(gameState);
+	shutdownRenderGroup(gameState->renderGroup);
+
+	if(gameState->renderGroup->backend == RenderBackend_gl) {
+		SDL_GL_DeleteContext(SDL_GL_GetCurrentContext());
+	}
+
+	if(window) SDL_DestroyWindow(window);
+	SDL_Quit();
+}
+
 int main(int argc, char* argv[]) {
+	//NOTE: -null runs the game without drawing anything (or opening a window), -software draws it on the CPU,
+	//		-nothread draws every frame on the main thread and -texturebudget <megabytes> sets how much texture 
+	//		memory is used before the textures which the level doesn't need are evicted (0 keeps every texture).
+	//		-fullscreen opens a fullscreen window, the game is upscaled to fit it either way.
+	//		-benchmark simulates every level without drawing it and prints the time per step (see runBenchmark), 
+	//		-nobroadphase makes the collision queries search the spatial partition instead of the broad phase.
+	RenderBackend backend = RenderBackend_gl;
+	bool32 benchmark = false;
+	bool32 disableBroadPhase = false;
+	bool32 renderOnThread = RENDER_ON_THREAD;
+	size_t textureBudget = MEGABYTES(TEXTURE_BUDGET_MEGABYTES);
+	bool32 fullscreen = false;
+
+	#ifdef HACKFORMER_MAC
+	//NOTE: The window can only be presented from the main thread on OSX
+	renderOnThread = false;
+	#endif
+
+	for(s32 argIndex = 1; argIndex < argc; argIndex++) {
+		char* arg = argv[argIndex];
+
+		if(!strcmp(arg, "-null")) {
+			backend = RenderBackend_null;
+		} else if(!strcmp(arg, "-software")) {
+			backend = RenderBackend_software;
+		} else if(!strcmp(arg, "-nothread")) {
+			renderOnThread = false;
+		} else if(!strcmp(arg, "-texturebudget") && argIndex + 1 < argc) {
+			textureBudget = MEGABYTES((size_t)atoi(argv[++argIndex]));
+		} else if(!strcmp(arg, "-fullscreen")) {
+			fullscreen = true;
+		} else if(!strcmp(arg, "-benchmark")) {
+			benchmark = true;
+			backend = RenderBackend_null;
+		} else if(!strcmp(arg, "-nobroadphase")) {
+			disableBroadPhase = true;
+		} else {
+			fprintf(stderr, "Unknown option %s (expected -null, -software, -nothread, -texturebudget, -fullscreen, "
+					"-benchmark or -nobroadphase)\n", arg);
+		}
+	}
+
+	StartupTimer startupTimer;
+	startupTimer.startTime = startupTimer.phaseStartTime = SDL_GetPerformanceCounter();
+
+	//NOTE: The game is always laid out for a 1280x720 window. With the GL backend, the window can be any size since 
+	//		the scene is drawn into a scene target which is upscaled to fit it.
 	s32 windowWidth = 1280, windowHeight = 720;
-	SDL_Window* window = createWindow(windowWidth, windowHeight);
+	u32 windowFlags = 0;
+
+	if(backend == RenderBackend_gl) {
+		windowFlags |= SDL_WINDOW_RESIZABLE;
+		if(fullscreen) windowFlags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+	}
+
+	SDL_Window* window = createWindow(windowWidth, windowHeight, backend, windowFlags);
 	SDL_ShowCursor(0);
-	GameState* gameState = createGameState(windowWidth, windowHeight);
+	logStartupPhase(&startupTimer, (char*)"window");
+
+	GameState* gameState = createGameState(windowWidth, windowHeight, backend, textureBudget);
+	gameState->broadPhase.disabled = disableBroadPhase;
+	logStartupPhase(&startupTimer, (char*)"render group");
+
+	ShaderStartupStats* shaderStartup = &gameState->renderGroup->shaderStartup;
+	printf("Startup shaders: %.1fms, Programs from cache: %d, Programs compiled: %d, Shaders compiled: %d\n", 
+		shaderStartup->seconds * 1000.0, shaderStartup->programsLoaded, shaderStartup->programsCompiled, 
+		shaderStartup->shadersCompiled);
 
 	RenderGroup* renderGroup = gameState->renderGroup;
 	Input* input = &gameState->input;
@@ -772,19 +1165,37 @@ int main(int argc, char* argv[]) {
 	gameState->textFont = loadTextFont(renderGroup, &gameState->permanentStorage);
 
 	initBackgroundTextures(&gameState->backgroundTextures);
+	initLevelTextureSets(gameState);
 
 	loadImages(gameState);
+	logStartupPhase(&startupTimer, (char*)"images");
 
 	initFieldSpec(gameState);
 	initDock(gameState);
 	initPauseMenu(gameState);
 	initMainMenu(gameState);
+	logStartupPhase(&startupTimer, (char*)"menus");
 
 	MusicState* musicState = &gameState->musicState;
 	initMusic(musicState, gameState);
+	logStartupPhase(&startupTimer, (char*)"music");
 
 	s32 mapFileIndex = 0;
 	loadLevel(gameState, &mapFileIndex, true, false);
+	logStartupPhase(&startupTimer, (char*)"level");
+
+	initSceneTarget(renderGroup, MIN_RENDER_SCALE);
+
+	//NOTE: The null backend has nothing to draw
+	initRenderThread(renderGroup, window, renderOnThread && backend != RenderBackend_null);
+
+	printf("Startup total: %.1fms\n", getSecondsSince(startupTimer.startTime) * 1000.0);
+
+	if(benchmark) {
+		runBenchmark(gameState, BENCHMARK_STEPS);
+		shutdownGame(gameState, window);
+		return 0;
+	}
 
 	#if SHOW_MAIN_MENU
 	gameState->screenType = ScreenType_mainMenu;
@@ -797,45 +1208,39 @@ int main(int argc, char* argv[]) {
 	bool running = true;
 	double dtForFrame = 0;
 	double maxDtForFrame = 1.0 / 6.0;
-	u32 lastTime = SDL_GetTicks();
-	u32 currentTime;
+	u64 lastFrameCounter = SDL_GetPerformanceCounter();
+
+	//NOTE: The time which has passed but hasn't been simulated yet, it is always less than one step
+	double simAccumulator = 0;
+
+	//NOTE: Keys pressed during frames where no step was simulated, these are handled by the next step
+	Input unsimulatedPresses = {};
 
 	char* saveFilePath = NULL;
 	char* saveFileName = (char*)"test_save.txt";
 
-	//s32 fps = 0;
-	u32 frameTime = 0;
-	//u32 fpsTimer = SDL_GetTicks();
-
-	while(running) {
-		currentTime = SDL_GetTicks();
-		dtForFrame += (double)((currentTime - lastTime) / 1000.0); 
-		lastTime = currentTime;
-
-		u32 frameStartTime = SDL_GetTicks();
-
-		#if 0
-		if(SDL_GetTicks() - fpsTimer >= 1000) {
-			fpsTimer = SDL_GetTicks();
-			gameState->fieldSpec.hackEnergy = (frameTime / fps);
-			fps = 0;
-			frameTime = 0;
-		}
+	//NOTE: K writes the next frame to render_capture_<level>_<n>.hfr, which can be replayed with the render replay tool
+	char renderCaptureFileName[64];
+	s32 renderCaptureCount = 0;
 
-		fps++;
-		#endif
+	#if LIGHTING_BENCHMARK
+	double lightingBenchmarkTime = 0;
+	#endif
 
-		glClearColor(0, 0, 0, 1);
-		glClear(GL_COLOR_BUFFER_BIT);
+	while(running) {
+		u64 frameCounter = SDL_GetPerformanceCounter();
+		dtForFrame = (double)(frameCounter - lastFrameCounter) / (double)SDL_GetPerformanceFrequency();
+		lastFrameCounter = frameCounter;
 
-		dtForFrame = 1.0 / 60.0;
+		//NOTE: Nothing waits for vsync without a window, so each frame is one step to keep headless runs deterministic
+		if(backend == RenderBackend_null) dtForFrame = SIM_STEP_SECONDS;
 
 		if (dtForFrame > maxDtForFrame) dtForFrame = maxDtForFrame;
 		double unpausedDtForFrame = dtForFrame;
 
 		gameState->swapFieldP = gameState->windowSize * 0.5 + v2(0.06, 4.43);
 
-		pollInput(input, &running, gameState->windowHeight, gameState->pixelsPerMeter, &gameState->camera);
+		pollInput(input, &running, gameState->windowWidth, gameState->windowHeight, gameState->pixelsPerMeter, &gameState->camera);
 
 		if(input->pause.justPressed && inGame(gameState)) {
 			togglePause(gameState);
@@ -859,7 +1264,53 @@ int main(int argc, char* argv[]) {
 		bool levelResetRequested = false;
 
 		if(inGame(gameState)) { 
-			updateAndRenderEntities(gameState, dtForFrame);
+			//NOTE: The entities are simulated in fixed steps however often frames are drawn, only the last step of a 
+			//		frame is drawn and the entities are drawn between where they were before and after it
+			s32 simSteps = 0;
+
+			if(dtForFrame > 0) {
+				simAccumulator += dtForFrame;
+				simSteps = (s32)(simAccumulator / SIM_STEP_SECONDS);
+				simAccumulator = max(0, simAccumulator - simSteps * SIM_STEP_SECONDS);
+
+				//NOTE: The steps which are dropped here are lost, so the game slows down instead of falling further behind
+				if(simSteps > MAX_SIM_STEPS_PER_FRAME) simSteps = MAX_SIM_STEPS_PER_FRAME;
+			}
+
+			gameState->renderInterpolation = min(1, simAccumulator / SIM_STEP_SECONDS);
+
+			Input frameInput = *input;
+			addJustPressed(input, &unsimulatedPresses);
+
+			if(simSteps == 0) {
+				unsimulatedPresses = *input;
+				clearJustPressed(input);
+				updateAndRenderEntities(gameState, 0);
+			} else {
+				clearJustPressed(&unsimulatedPresses);
+
+				for(s32 step = 0; step < simSteps; step++) {
+					bool lastStep = step == simSteps - 1;
+					renderGroup->enabled = lastStep;
+
+					updateAndRenderEntities(gameState, SIM_STEP_SECONDS);
+
+					//NOTE: Each key press is only handled by one step
+					clearJustPressed(input);
+					if(!lastStep) removeEntities(gameState);
+				}
+
+				renderGroup->enabled = true;
+			}
+
+			//NOTE: The rest of the frame uses this frame's input
+			*input = frameInput;
+
+		#if LIGHTING_BENCHMARK
+			lightingBenchmarkTime += unpausedDtForFrame;
+			pushLightingBenchmark(renderGroup, gameState->windowSize, lightingBenchmarkTime);
+		#endif
+
 			pushSortEnd(renderGroup);
 
 			//NOTE: Draw the dock before the console
@@ -1022,7 +1473,7 @@ int main(int argc, char* argv[]) {
 		#endif
 
 			if(gameState->screenType == ScreenType_pause) {
-				drawAnimatedBackground(gameState, pauseMenu->background, &pauseMenu->backgroundAnim, pauseMenu->animCounter);				
+				drawAnimatedBackground(gameState, &pauseMenu->backgroundAnim, pauseMenu->animCounter);				
 
 				if (updateAndDrawButton(&pauseMenu->quit, renderGroup, &oldInput, unpausedDtForFrame)) {
 					running = false;
@@ -1047,7 +1498,7 @@ int main(int argc, char* argv[]) {
 			pushSortEnd(renderGroup);
 
 			mainMenu->animCounter += dtForFrame;
-			drawAnimatedBackground(gameState, mainMenu->background, &mainMenu->backgroundAnim, mainMenu->animCounter);
+			drawAnimatedBackground(gameState, &mainMenu->backgroundAnim, mainMenu->animCounter);
 
 			if (updateAndDrawButton(&mainMenu->quit, renderGroup, input, dtForFrame)) {
 				running = false;
@@ -1095,7 +1546,31 @@ int main(int argc, char* argv[]) {
 			pushTexture(renderGroup, cursorImage, cursorBounds, false, false, DrawOrder_gui);
 		}
 		
-		drawRenderGroup(renderGroup, &gameState->fieldSpec);
+		//NOTE: With RENDER_ON_THREAD, this frame is drawn while the next one is simulated, so the stats are from the
+		//		frame before it
+		submitRenderGroup(renderGroup);
+		updateTextureResidency(renderGroup);
+
+#if SHOW_RENDER_STATS
+		RenderStats* renderStats = &renderGroup->lastFrameStats;
+		printf("Draw calls: %d, State changes: %d, State changes avoided: %d, Quads: %d, Lights: %d, Max lights per tile: %d\n", 
+			   renderStats->drawCalls, renderStats->stateChanges, renderStats->stateRequests - renderStats->stateChanges, 
+			   renderStats->quads, renderStats->lights, renderStats->maxLightsPerTile);
+		printf("Entities visible: %d, Entities culled: %d, Elements pushed: %d, Elements culled: %d\n", 
+			   renderStats->cull.entitiesVisible, renderStats->cull.entitiesCulled, 
+			   renderStats->cull.elementsPushed, renderStats->cull.elementsCulled);
+		printf("Console fields culled: %d, Console fields rebuilt: %d\n", 
+			   renderStats->cull.fieldsCulled, renderStats->cull.fieldsRebuilt);
+		if(renderGroup->sceneTarget.enabled) {
+			printf("Render scale: %.2f, GPU time: %.2fms\n", renderStats->renderScale, renderStats->gpuMilliseconds);
+		}
+		if(renderGroup->residency.enabled) {
+			printf("Resident textures: %.1fMB, Texture budget: %.1fMB\n", 
+				   renderGroup->residency.residentBytes / (double)MEGABYTES(1), 
+				   renderGroup->residency.budget / (double)MEGABYTES(1));
+		}
+#endif
+
 		removeEntities(gameState);
 
 		{ //NOTE: This updates the camera position
@@ -1177,18 +1652,22 @@ int main(int argc, char* argv[]) {
 			renderGroup->defaultClipRect = screenSpaceClipRect;
 		}
 
-		dtForFrame = 0;
-
 		if(gameState->screenType == ScreenType_game) {
 			if (input->n.justPressed) {
 				if(!saveFilePath) saveFilePath = getSaveFilePath(saveFileName, &gameState->permanentStorage);
 				saveCompleteGame(gameState, saveFilePath);
 			}
 			if (input->m.justPressed) {
-				freeLevel(gameState);
 				if(!saveFilePath) saveFilePath = getSaveFilePath(saveFileName, &gameState->permanentStorage);
 				loadCompleteGame(gameState, saveFilePath);
 			}
+			if (input->l.justPressed) {
+				renderGroup->lightingEnabled = !renderGroup->lightingEnabled;
+			}
+			if (input->k.justPressed) {
+				sprintf(renderCaptureFileName, "render_capture_%d_%d.hfr", mapFileIndex + 1, renderCaptureCount++);
+				renderGroup->captureFileName = renderCaptureFileName;
+			}
 
 //			if (input->x.justPressed) {
 //				gameState->fieldSpec.hackEnergy += 10;
@@ -1210,12 +1689,9 @@ int main(int argc, char* argv[]) {
 		if(gameState->screenType == ScreenType_pause) {
 			gameState->input = oldInput;
 		}
-
-		u32 frameEndTime = SDL_GetTicks();
-		frameTime += frameEndTime - frameStartTime;
-
-		SDL_GL_SwapWindow(window);
 	}
 
+	shutdownGame(gameState, window);
+
 	return 0;
 }
\ No newline at end of file
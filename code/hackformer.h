@@ -2,7 +2,6 @@
 
 Clean Up
 ---------
-- set metersToPixels dynamically based on screen resolution
 - test remove when outside level to see that it works
 - Heavy tiles should be able to smash entities into the ceiling
 - Clean up moving to first waypoint if not currently on the path
@@ -62,9 +61,21 @@ struct Input;
 #define DRAW_ENTITIES 1
 #define PLAY_MUSIC 0
 #define SHOW_MAIN_MENU 0
-#define ENABLE_LIGHTING 0
+#define ENABLE_LIGHTING 0 //NOTE: This is the default, lighting can be toggled with L
+#define LIGHTING_BENCHMARK 0
 #define DRAW_BACKGROUND 1
 #define DRAW_DOCK 1
+#define SHOW_RENDER_STATS 0
+#define RENDER_ON_THREAD 1 //NOTE: The frame is drawn on a render thread while the next one is simulated
+#define PUSH_ENTITIES_ON_WORKERS 1
+#define TEXTURE_BUDGET_MEGABYTES 256 //NOTE: The default, it can be changed with -texturebudget
+#define SIM_STEP_SECONDS (1.0 / 60.0) //NOTE: The entities are always simulated in steps of this length
+#define MAX_SIM_STEPS_PER_FRAME 4 //NOTE: A frame which takes longer than this slows the game down instead
+#define BENCHMARK_STEPS 600 //NOTE: How many steps -benchmark simulates each level for
+#define BENCHMARK_BODIES 5000 //NOTE: The number of heavy tiles in the synthetic benchmark level
+#define BENCHMARK_STACK_HEIGHT 8
+#define BENCHMARK_GRAVITY_FLIP_STEPS 120
+#define MIN_RENDER_SCALE 0.5 //NOTE: How far the scene's resolution can go down when the GPU can't keep up, 1 keeps it
 
 struct PathNode {
 	bool32 solid;
@@ -96,8 +107,7 @@ struct Button {
 };
 
 struct PauseMenu {
-	Texture* background;
-	Animation backgroundAnim;
+	CompositedAnimation backgroundAnim;
 	double animCounter;
 
 	Button quit;
@@ -107,8 +117,7 @@ struct PauseMenu {
 };
 
 struct MainMenu {
-	Texture* background;
-	Animation backgroundAnim;
+	CompositedAnimation backgroundAnim;
 	double animCounter;
 
 	Button quit;
@@ -192,7 +201,7 @@ struct CursorImages {
 
 struct GameState {
 	s32 numEntities;
-	Entity entities[1000];
+	Entity entities[MAX_ENTITIES];
 
 	//NOTE: 0 is the null reference
 	EntityReference entityRefs_[500];
@@ -235,6 +244,9 @@ struct GameState {
 	Hitbox* hitboxFreeList;
 	Messages* messagesFreeList;
 	Waypoint* waypointFreeList;
+	TileMove* tileMoveFreeList;
+	TileMoveNode* tileMoveNodeFreeList;
+	u32 tileMoveSolveCount;
 
 	ConsoleField* timeField;
 	ConsoleField* gravityField;
@@ -252,6 +264,11 @@ struct GameState {
 	s32 chunksWidth, chunksHeight;
 	V2 chunkSize;
 
+	ProjectilePool projectiles;
+	BroadPhase broadPhase;
+	StaticTileLayer staticTiles;
+	EntityRenderPass entityRenderPass;
+
 	double shootDelay;
 	V2 mapSize;
 	V2 worldSize;
@@ -261,6 +278,7 @@ struct GameState {
 	V2 windowSize;
 
 	V2 gravity;
+	V2 sleepGravity; //The gravity when the sleeping entities were last checked
 
 	AnimNode* playerHack;
 	CharacterAnim* playerAnim;
@@ -303,6 +321,9 @@ struct GameState {
 
 	double collisionBoundsAlpha;
 
+	//NOTE: How far the drawn frame is from the start of the last simulation step to its end, from 0 to 1
+	double renderInterpolation;
+
 	Texture* lights[2];
 	Texture* lightCircle;
 	Texture* lightTriangle;
@@ -52,7 +52,7 @@ int main(int argc, char* argv[]) {
 	u32 currentTime = SDL_GetTicks();
 
 	while(running) {
-		pollInput(&input, &running, windowHeight, TEMP_PIXELS_PER_METER, &camera);
+		pollInput(&input, &running, windowWidth, windowHeight, TEMP_PIXELS_PER_METER, &camera);
 
 		glClearColor(0.4f, 0.4f, 0.4f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
@@ -70,7 +70,7 @@ int main(int argc, char* argv[]) {
 
 		pushTexture(renderGroup, tex, bgBounds, false, DrawOrder_gui, false, Orientation_0, WHITE, 1);
 
-		drawRenderGroup(renderGroup, 0);
+		drawRenderGroup(renderGroup);
 		SDL_GL_SwapWindow(window);
 	}
 
@@ -59,7 +59,7 @@ int main(int argc, char* argv[]) {
 	double pointThickness = 0.05;
 
 	while(running) {
-		pollInput(&input, &running, windowHeight, TEMP_PIXELS_PER_METER, &camera);
+		pollInput(&input, &running, windowWidth, windowHeight, TEMP_PIXELS_PER_METER, &camera);
 
 		glClearColor(0.4f, 0.4f, 0.4f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
@@ -94,7 +94,7 @@ int main(int argc, char* argv[]) {
 				V2 p1 = points[pIndex];
 				V2 p2 = points[(pIndex + 1) % pointsCount];
 
-				pushDashedLine(renderGroup, RED, p1, p2, 0.02, 0.05, 0.05, false);
+				pushDashedLine(renderGroup, renderGroup->frame, RED, p1, p2, 0.02, 0.05, 0.05, false);
 			}
 		}
 
@@ -169,7 +169,7 @@ int main(int argc, char* argv[]) {
 			fclose(file);
 		}
 
-		drawRenderGroup(renderGroup, 0);
+		drawRenderGroup(renderGroup);
 		SDL_GL_SwapWindow(window);
 	}
 
@@ -129,6 +129,15 @@ bool hasValues(ConsoleField* field) {
 	return result;
 }
 
+//NOTE: These are the bounds of the field sprite, the value and its arrows are drawn below it
+R2 getConsoleFieldBounds(ConsoleField* field, FieldSpec* spec) {
+	V2 fieldP = field->p;
+	if(hasValues(field)) fieldP += v2(0, spec->valueSize.y - spec->valueBackgroundPenetration);
+
+	R2 result = rectCenterDiameter(fieldP, spec->fieldSize);
+	return result;
+}
+
 bool shouldDrawField(FieldSpec* spec, ConsoleField* field) {
 	bool result = false;
 
@@ -758,9 +767,8 @@ bool drawConsoleField(ConsoleField* field, RenderGroup* group, Input* input, Fie
 				hasValue = false;
 		}
 
-		V2 fieldP = field->p;
-		if(hasValues(field)) fieldP += v2(0, spec->valueSize.y - spec->valueBackgroundPenetration);
-		R2 fieldBounds = rectCenterDiameter(fieldP, spec->fieldSize);
+		R2 fieldBounds = getConsoleFieldBounds(field, spec);
+		V2 fieldP = getRectCenter(fieldBounds);
 
 		if (drawValue) {
 			if(hasValue) {
@@ -1314,6 +1322,11 @@ bool updateConsole(GameState* gameState, double dt) {
 	if(playerCanHack && newConsoleEntityRequested) {
 		Entity* newConsoleEntity = NULL;
 
+		//NOTE: Pooled projectiles can only be selected, and saved for undo, once they are entities again
+		if(!prevConsoleEntity) {
+			promotePooledProjectiles(gameState);
+		}
+
 		for (s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
 			Entity* testEntity = gameState->entities + entityIndex;
 
@@ -207,4 +207,6 @@ bool32 isSet(ConsoleField* field, u32 flags) {
 	return result;
 }
 
-bool drawConsoleField(ConsoleField*, RenderGroup*, Input*, FieldSpec*, bool, bool, GameState*);
\ No newline at end of file
+bool drawConsoleField(ConsoleField*, RenderGroup*, Input*, FieldSpec*, bool, bool, GameState*);
+bool hasValues(ConsoleField* field);
+R2 getConsoleFieldBounds(ConsoleField* field, FieldSpec* spec);
\ No newline at end of file
@@ -75,7 +75,7 @@ void drawScaledLine(RenderGroup* group, Color lineColor, V2 lineStart, V2 lineEn
 	lineStart = lineStart - lineCenter + newLineCenter; 
 	lineEnd = lineEnd - lineCenter + newLineCenter; 
 
-	pushDashedLine(group, lineColor, lineStart, lineEnd, lineThickness, dashSize, spaceSize, true);
+	pushDashedLine(group, group->frame, lineColor, lineStart, lineEnd, lineThickness, dashSize, spaceSize, true);
 }
 
 void drawScaledTex(RenderGroup* group, Texture* tex, Camera* camera, V2 center, V2 size, bool32 flipX, bool32 flipY) {
@@ -524,7 +524,7 @@ int main(int argc, char* argv[]) {
 	Input* input = &state.input;
 
 	while(running) {
-		pollInput(&state.input, &running, windowHeight, TEMP_PIXELS_PER_METER, &state.camera);
+		pollInput(&state.input, &running, windowWidth, windowHeight, TEMP_PIXELS_PER_METER, &state.camera);
 
 		if(input->esc.justPressed) {
 			cursorMode = CursorMode_moveEntity;
@@ -873,7 +873,7 @@ int main(int argc, char* argv[]) {
 								wp2 = firstPoint;
 							}
 
-							pushDashedLine(renderGroup, RED, wp1->p, wp2->p, 0.02, 0.05, 0.05, true);
+							pushDashedLine(renderGroup, renderGroup->frame, RED, wp1->p, wp2->p, 0.02, 0.05, 0.05, true);
 
 							if(!wp) {
 								break;
@@ -985,7 +985,7 @@ int main(int argc, char* argv[]) {
 		}
 
 		glClear(GL_COLOR_BUFFER_BIT);
-		drawRenderGroup(renderGroup, NULL);
+		drawRenderGroup(renderGroup);
 		
 		moveCamera(input, camera, gameWindowSize);
 		oldScale = camera->scale;
@@ -364,11 +364,17 @@ bool isProjectile(Entity* entity) {
 }
 
 void attemptToRemovePenetrationReferences(Entity*, GameState*);
+void wakeEntity(Entity*, GameState*);
+void refreshBroadPhaseEntity(Entity*, GameState*);
 
 void setEntityP(Entity* entity, V2 newP, GameState* gameState) {
 	removeFromSpatialPartition(entity, gameState);
 	entity->p = newP;
 	addToSpatialPartition(entity, gameState);
+	refreshBroadPhaseEntity(entity, gameState);
+
+	//NOTE: A sleeping entity can still be moved by the entity it is standing on
+	wakeEntity(entity, gameState);
 
 	attemptToRemovePenetrationReferences(entity, gameState);
 }
@@ -419,6 +425,211 @@ bool affectedByGravity(Entity* entity, ConsoleField* movementField) {
 	return result;
 }
 
+//NOTE: An anchor never moves on its own (like a regular tile), so it does not join together the islands
+//		of the entities which are standing on it
+bool isSleepAnchor(Entity* entity) {
+	ConsoleField* movementField = getMovementField(entity);
+	bool result = !movementField && !affectedByGravity(entity, movementField);
+	return result;
+}
+
+bool canEntitySleep(Entity* entity, GameState* gameState) {
+	if(isSet(entity, EntityFlag_remove)) return false;
+	if(isProjectile(entity)) return false;
+
+	//NOTE: Entities which are being hacked are always kept awake so that any field changes take effect
+	if(entity->ref == gameState->consoleEntityRef) return false;
+
+	switch(entity->type) {
+		case EntityType_player:
+		case EntityType_death:
+		case EntityType_bootUp:
+		case EntityType_pickupField:
+		case EntityType_laserBase:
+		case EntityType_laserBeam:
+		case EntityType_motherShipProjectileDeath: {
+			return false;
+		} break;
+
+		case EntityType_disappearingTile:
+		case EntityType_droppingTile:
+		case EntityType_heavyTile:
+		case EntityType_tile: {
+			//NOTE: The tile still has to move to its new offset
+			assert(entity->numFields >= 2);
+			if(entity->fields[0]->selectedIndex != entity->tileXOffset ||
+			   entity->fields[1]->selectedIndex != entity->tileYOffset) return false;
+		} break;
+
+		default: {
+		} break;
+	}
+
+	for(s32 fieldIndex = 0; fieldIndex < entity->numFields; fieldIndex++) {
+		ConsoleField* field = entity->fields[fieldIndex];
+
+		if(isConsoleFieldMovementType(field)) return false;
+
+		switch(field->type) {
+			case ConsoleField_cameraFollows:
+			case ConsoleField_shootsAtTarget:
+			case ConsoleField_spotlight:
+			case ConsoleField_scansForTargets:
+			case ConsoleField_cloaks:
+			case ConsoleField_spawnsTrawlers:
+			case ConsoleField_spawnsShrikes:
+			case ConsoleField_disappearsOnHit:
+			case ConsoleField_dropsOnHit: {
+				return false;
+			} break;
+
+			default: {
+			} break;
+		}
+	}
+
+	return true;
+}
+
+//NOTE: Islands are always woken up as a whole
+void wakeEntity(Entity* entity, GameState* gameState) {
+	if(!isSet(entity, EntityFlag_asleep)) return;
+
+	s32 islandRef = entity->sleepIslandRef;
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* islandEntity = gameState->entities + entityIndex;
+
+		if(isSet(islandEntity, EntityFlag_asleep) && islandEntity->sleepIslandRef == islandRef) {
+			clearFlags(islandEntity, EntityFlag_asleep);
+			islandEntity->sleepTime = 0;
+		}
+	}
+}
+
+void wakeAllEntities(GameState* gameState) {
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+		clearFlags(entity, EntityFlag_asleep);
+		entity->sleepTime = 0;
+	}
+}
+
+//NOTE: This wakes up any sleeping entity which is touching the given entity. It is used when an entity is
+//		removed so that anything it was supporting can start falling again.
+void wakeTouchingEntities(Entity* entity, GameState* gameState) {
+	s32 partitionCenterX = (s32)(entity->p.x / gameState->chunkSize.x);
+	s32 partitionCenterY = (s32)(entity->p.y / gameState->chunkSize.y);
+
+	V2 touchRadius = v2(1, 1) * 0.1;
+
+	for (s32 partitionXOffs = -1; partitionXOffs <= 1; partitionXOffs++) {
+		for (s32 partitionYOffs = -1; partitionYOffs <= 1; partitionYOffs++) {
+			s32 partitionX = partitionCenterX + partitionXOffs;
+			s32 partitionY = partitionCenterY + partitionYOffs;
+
+			if (partitionX >= 0 && 
+				partitionY >= 0 && 
+				partitionX < gameState->chunksWidth && 
+				partitionY < gameState->chunksHeight) {
+
+				EntityChunk* chunk = gameState->chunks + partitionY * gameState->chunksWidth + partitionX;
+
+				for(; chunk; chunk = chunk->next) {
+					for (s32 refIndex = 0; refIndex < chunk->numRefs; refIndex++) {
+						Entity* sleeper = getEntityByRef(gameState, chunk->entityRefs[refIndex]);
+						if(!sleeper || sleeper == entity || !isSet(sleeper, EntityFlag_asleep)) continue;
+
+						bool touching = false;
+
+						for(Hitbox* sleeperHitbox = sleeper->hitboxes; sleeperHitbox && !touching; sleeperHitbox = sleeperHitbox->next) {
+							R2 sleeperBounds = addRadiusTo(getBoundingBox(sleeper, sleeperHitbox), touchRadius);
+
+							for(Hitbox* entityHitbox = entity->hitboxes; entityHitbox; entityHitbox = entityHitbox->next) {
+								if(rectanglesOverlap(sleeperBounds, getBoundingBox(entity, entityHitbox))) {
+									touching = true;
+									break;
+								}
+							}
+						}
+
+						if(touching) wakeEntity(sleeper, gameState);
+					}
+				}
+			}
+		}
+	}
+}
+
+s32 getSleepIslandRoot(s32* islandParents, s32 index) {
+	while(islandParents[index] != index) {
+		islandParents[index] = islandParents[islandParents[index]];
+		index = islandParents[index];
+	}
+
+	return index;
+}
+
+//NOTE: Entities are grouped into islands by their ground references. Once every entity in an island has 
+//		been resting for ENTITY_SLEEP_TIME the whole island is put to sleep. Sleeping entities skip their
+//		ground reference queries and movement until they are woken up by a contact, a hack, a change in 
+//		gravity or the removal of an entity they were touching.
+void updateSleepingIslands(GameState* gameState, double dt) {
+	s32 islandParents[arrayCount(gameState->entities)];
+	bool islandCanSleep[arrayCount(gameState->entities)];
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		islandParents[entityIndex] = entityIndex;
+		islandCanSleep[entityIndex] = true;
+	}
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+		if(isSet(entity, EntityFlag_asleep)) continue;
+
+		bool resting = lengthSq(entity->dP) < square(ENTITY_SLEEP_SPEED);
+
+		if(resting && canEntitySleep(entity, gameState)) {
+			entity->sleepTime += dt;
+		} else {
+			entity->sleepTime = 0;
+		}
+
+		if(isSleepAnchor(entity)) continue;
+
+		for(RefNode* node = entity->groundReferenceList; node; node = node->next) {
+			Entity* top = getEntityByRef(gameState, node->ref);
+
+			if(top && !isSet(top, EntityFlag_asleep)) {
+				s32 entityRoot = getSleepIslandRoot(islandParents, entityIndex);
+				s32 topRoot = getSleepIslandRoot(islandParents, (s32)(top - gameState->entities));
+				islandParents[topRoot] = entityRoot;
+			}
+		}
+	}
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+
+		if(!isSet(entity, EntityFlag_asleep) && entity->sleepTime < ENTITY_SLEEP_TIME) {
+			islandCanSleep[getSleepIslandRoot(islandParents, entityIndex)] = false;
+		}
+	}
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+		if(isSet(entity, EntityFlag_asleep)) continue;
+
+		s32 root = getSleepIslandRoot(islandParents, entityIndex);
+
+		if(islandCanSleep[root]) {
+			setFlags(entity, EntityFlag_asleep);
+			entity->sleepIslandRef = gameState->entities[root].ref;
+			entity->dP = v2(0, 0);
+		}
+	}
+}
+
 bool refNodeListContainsRef(RefNode* list, s32 ref) {
 	RefNode* node = list;
 
@@ -502,12 +713,13 @@ bool createsPickupFieldsOnDeath(Entity* entity) {
 Entity* addPickupField(GameState*, Entity*, ConsoleField*);
 Entity* addDeath(GameState*, V2, V2, DrawOrder, double, CharacterAnim*);
 Entity* addMotherShipProjectileDeath(GameState* gameState, Entity* motherShipProjectile);
+void removePooledProjectiles(GameState* gameState);
 
 void freeEntityAtLevelEnd(Entity* entity, GameState* gameState, bool loadingFromCheckpoint) {
 	Messages* messages = entity->messages;
 	if(messages) {
 		for (s32 messageIndex = 0; messageIndex < messages->count; messageIndex++) {
-			freeTexture(messages->textures + messageIndex);
+			freeTexture(gameState->renderGroup, messages->textures + messageIndex);
 		}
 	}
 
@@ -597,7 +809,7 @@ void freeEntityDuringLevel(Entity* entity, GameState* gameState, bool createdThi
 	Messages* messages = entity->messages;
 	if(messages) {
 		for (s32 messageIndex = 0; messageIndex < messages->count; messageIndex++) {
-			freeTexture(messages->textures + messageIndex);
+			freeTexture(gameState->renderGroup, messages->textures + messageIndex);
 		}
 
 		freeMessages(messages, gameState);
@@ -727,6 +939,8 @@ void removeEntities(GameState* gameState) {
 				}
 			}
 
+			wakeTouchingEntities(entity, gameState);
+			removeStaticTile(entity);
 			freeEntityDuringLevel(entity, gameState);
 
 			gameState->numEntities--;
@@ -745,6 +959,8 @@ void removeEntities(GameState* gameState) {
 			gameState->entities[gameState->numEntities] = {};
 		}
 	}
+
+	removePooledProjectiles(gameState);
 }
 
 EntityReference* allocateEntityReference(GameState* gameState, Entity* entity, EntityReference* next = NULL) {
@@ -794,6 +1010,7 @@ Entity* addEntity(GameState* gameState, EntityType type, DrawOrder drawOrder, V2
 	result->type = type;
 	result->drawOrder = drawOrder;
 	result->p = p;
+	result->prevP = p;
 	result->renderSize = renderSize;
 	result->alpha = 1;
 
@@ -1465,6 +1682,7 @@ void setSelectedText(Entity* text, s32 selectedIndex, GameState* gameState) {
 
 	freeHitboxes(text, gameState);
 	giveEntityRectangularCollisionBounds(text, gameState, 0, 0, text->renderSize.x, text->renderSize.y);
+	refreshBroadPhaseEntity(text, gameState);
 }
 
 Entity* addText(GameState* gameState, V2 p, Messages* messages) {
@@ -1625,6 +1843,313 @@ Entity* addMotherShipProjectileDeath(GameState* gameState, Entity* motherShipPro
 	return result;
 }
 
+EntityType getProjectileKindType(ProjectileKind kind) {
+	EntityType result = EntityType_trojanBolt;
+
+	switch(kind) {
+		case ProjectileKind_trojanBolt: result = EntityType_trojanBolt; break;
+		case ProjectileKind_trawlerBolt:
+		case ProjectileKind_shrikeBolt: result = EntityType_trawlerBolt; break;
+		case ProjectileKind_motherShipProjectile: result = EntityType_motherShipProjectile; break;
+		InvalidDefaultCase;
+	}
+
+	return result;
+}
+
+double getProjectileKindSize(ProjectileKind kind) {
+	double result = 0;
+
+	switch(kind) {
+		case ProjectileKind_trojanBolt: result = TROJAN_BOLT_SIZE; break;
+		case ProjectileKind_trawlerBolt: result = TRAWLER_BOLT_SIZE; break;
+		case ProjectileKind_shrikeBolt: result = SHRIKE_BOLT_SIZE; break;
+		case ProjectileKind_motherShipProjectile: result = MOTHERSHIP_PROJECTILE_SIZE; break;
+		InvalidDefaultCase;
+	}
+
+	return result;
+}
+
+DrawOrder getProjectileKindDrawOrder(ProjectileKind kind) {
+	DrawOrder result = DrawOrder_trojanBolt;
+
+	switch(kind) {
+		case ProjectileKind_trojanBolt: result = DrawOrder_trojanBolt; break;
+		case ProjectileKind_trawlerBolt:
+		case ProjectileKind_shrikeBolt: result = DrawOrder_trawlerBolt; break;
+		case ProjectileKind_motherShipProjectile: result = DrawOrder_motherShipProjectile; break;
+		InvalidDefaultCase;
+	}
+
+	return result;
+}
+
+void initProjectileProxy(ProjectileProxy* proxy, GameState* gameState) {
+	*proxy = {};
+	Entity* entity = &proxy->entity;
+
+	for(s32 kindIndex = 0; kindIndex < ProjectileKind_count; kindIndex++) {
+		ProjectileKind kind = (ProjectileKind)kindIndex;
+
+		entity->type = getProjectileKindType(kind);
+		entity->renderSize = v2(1, 1) * getProjectileKindSize(kind);
+		entity->hitboxes = NULL;
+
+		switch(kind) {
+			case ProjectileKind_trojanBolt: addTrojanBoltHitbox(entity, gameState); break;
+			case ProjectileKind_trawlerBolt:
+			case ProjectileKind_shrikeBolt: addTrawlerBoltHitbox(entity, gameState); break;
+			case ProjectileKind_motherShipProjectile: addMotherShipProjectileHitbox(entity, gameState); break;
+			InvalidDefaultCase;
+		}
+
+		proxy->hitboxes[kindIndex] = entity->hitboxes;
+	}
+
+	entity->hitboxes = NULL;
+	proxy->index = -1;
+}
+
+//NOTE: This is called whenever the spatial partition is created for a new level
+void initProjectilePool(GameState* gameState) {
+	ProjectilePool* pool = &gameState->projectiles;
+
+	pool->count = 0;
+	pool->numSorted = 0;
+
+	s32 numChunks = gameState->chunksWidth * gameState->chunksHeight;
+	pool->chunkStarts = pushArray(&gameState->levelStorage, s32, numChunks + 1);
+	memset(pool->chunkStarts, 0, (numChunks + 1) * sizeof(s32));
+
+	//NOTE: Every pooled projectile shares this field, a new one is created whenever a pickup field is made from it
+	pool->killField = createConsoleField(gameState, (char*)"kills_enemies", ConsoleField_killsOnHit, 5);
+
+	initProjectileProxy(&pool->moving, gameState);
+	initProjectileProxy(&pool->fixed, gameState);
+}
+
+bool isProjectileProxy(Entity* entity, GameState* gameState) {
+	ProjectilePool* pool = &gameState->projectiles;
+	bool result = entity == &pool->moving.entity || entity == &pool->fixed.entity;
+	return result;
+}
+
+void loadProjectileProxy(ProjectileProxy* proxy, s32 index, GameState* gameState) {
+	ProjectilePool* pool = &gameState->projectiles;
+	assert(index >= 0 && index < pool->count);
+
+	ProjectileKind kind = pool->kind[index];
+	Entity* entity = &proxy->entity;
+
+	proxy->index = index;
+
+	entity->ref = pool->ref[index];
+	entity->type = getProjectileKindType(kind);
+	entity->drawOrder = getProjectileKindDrawOrder(kind);
+	entity->flags = EntityFlag_removeWhenOutsideLevel|EntityFlag_hackable;
+	if(kind == ProjectileKind_motherShipProjectile) setFlags(entity, EntityFlag_noMovementByDefault);
+	if(pool->removed[index]) setFlags(entity, EntityFlag_remove);
+
+	entity->p = pool->p[index];
+	entity->dP = pool->dP[index];
+	entity->rotation = pool->rotation[index];
+	entity->renderSize = v2(1, 1) * getProjectileKindSize(kind);
+	entity->clickBox = rectCenterDiameter(v2(0, 0), entity->renderSize);
+	entity->hitboxes = proxy->hitboxes[kind];
+	entity->spawnerRef = pool->spawnerRef[index];
+	entity->animTime = pool->animTime[index];
+	entity->alpha = 1;
+
+	entity->numFields = 1;
+	entity->fields[0] = pool->killField;
+
+	switch(kind) {
+		case ProjectileKind_trojanBolt: {
+			entity->defaultTex = gameState->trojanImages.projectile;
+			entity->characterAnim = gameState->trojanImages.projectileDeath;
+			entity->emissivity = 1;
+		} break;
+
+		case ProjectileKind_trawlerBolt:
+		case ProjectileKind_shrikeBolt: {
+			entity->defaultTex = gameState->trawlerImages.projectile;
+			entity->characterAnim = gameState->trawlerImages.projectileDeath;
+			entity->emissivity = 1;
+		} break;
+
+		case ProjectileKind_motherShipProjectile: {
+			entity->defaultTex = NULL;
+			entity->characterAnim = NULL;
+			entity->emissivity = 0;
+		} break;
+
+		InvalidDefaultCase;
+	}
+}
+
+void storeProjectileProxy(ProjectileProxy* proxy, GameState* gameState) {
+	ProjectilePool* pool = &gameState->projectiles;
+
+	s32 index = proxy->index;
+	assert(index >= 0 && index < pool->count);
+
+	Entity* entity = &proxy->entity;
+
+	pool->p[index] = entity->p;
+	pool->dP[index] = entity->dP;
+	pool->rotation[index] = entity->rotation;
+	pool->removed[index] = isSet(entity, EntityFlag_remove);
+}
+
+void storeProjectileProxyIfHit(Entity* hitEntity, GameState* gameState) {
+	ProjectileProxy* proxy = &gameState->projectiles.fixed;
+	if(hitEntity == &proxy->entity) storeProjectileProxy(proxy, gameState);
+}
+
+Entity* addProjectileEntity(GameState* gameState, ProjectileKind kind, V2 p, V2 target, s32 shooterRef, double speed) {
+	Entity* result = NULL;
+
+	switch(kind) {
+		case ProjectileKind_trojanBolt: result = addTrojanBolt(gameState, p, target, shooterRef, speed); break;
+		case ProjectileKind_trawlerBolt: result = addTrawlerBolt(gameState, p, target, shooterRef, speed, TRAWLER_BOLT_SIZE); break;
+		case ProjectileKind_shrikeBolt: result = addTrawlerBolt(gameState, p, target, shooterRef, speed, SHRIKE_BOLT_SIZE); break;
+		case ProjectileKind_motherShipProjectile: result = addMotherShipProjectile(gameState, p, target, shooterRef, speed); break;
+		InvalidDefaultCase;
+	}
+
+	return result;
+}
+
+void spawnProjectile(GameState* gameState, ProjectileKind kind, V2 p, V2 target, s32 shooterRef, double speed) {
+	ProjectilePool* pool = &gameState->projectiles;
+
+	//NOTE: The projectile is still created if the pool is full, it just isn't pooled
+	if(pool->count >= MAX_POOLED_PROJECTILES) {
+		addProjectileEntity(gameState, kind, p, target, shooterRef, speed);
+		return;
+	}
+
+	s32 index = pool->count++;
+
+	pool->kind[index] = kind;
+	pool->ref[index] = gameState->refCount_++;
+	pool->spawnerRef[index] = shooterRef;
+	pool->p[index] = p;
+	pool->prevP[index] = p;
+	pool->dP[index] = normalize(target - p) * speed;
+	pool->animTime[index] = 0;
+	pool->removed[index] = false;
+
+	//NOTE: This matches the rotation which initProjectile gives to the bolts
+	if(kind == ProjectileKind_motherShipProjectile) pool->rotation[index] = 0;
+	else pool->rotation[index] = getRad(pool->dP[index]) + PI;
+}
+
+//NOTE: The pooled projectiles are turned into regular entities before hacking starts so that they can be
+//		selected, and so that the hack saves (which only store the entity list) contain them.
+void promotePooledProjectiles(GameState* gameState) {
+	ProjectilePool* pool = &gameState->projectiles;
+
+	for(s32 index = 0; index < pool->count; index++) {
+		V2 p = pool->p[index];
+		V2 dP = pool->dP[index];
+
+		Entity* entity = addProjectileEntity(gameState, pool->kind[index], p, p + dP, pool->spawnerRef[index], length(dP));
+
+		entity->dP = dP;
+		entity->rotation = pool->rotation[index];
+		entity->animTime = pool->animTime[index];
+
+		if(pool->removed[index]) setFlags(entity, EntityFlag_remove);
+	}
+
+	pool->count = 0;
+	pool->numSorted = 0;
+}
+
+//NOTE: This buckets the pooled projectiles by spatial chunk with a counting sort, so that collision queries
+//		only have to look at the projectiles in the chunks they touch.
+void sortPooledProjectiles(GameState* gameState) {
+	ProjectilePool* pool = &gameState->projectiles;
+
+	s32 numChunks = gameState->chunksWidth * gameState->chunksHeight;
+	s32* chunkStarts = pool->chunkStarts;
+
+	memset(chunkStarts, 0, (numChunks + 1) * sizeof(s32));
+
+	for(s32 index = 0; index < pool->count; index++) {
+		EntityChunk* chunk = getSpatialChunk(pool->p[index], gameState);
+		if(chunk) chunkStarts[chunk - gameState->chunks + 1]++;
+	}
+
+	for(s32 chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+		chunkStarts[chunkIndex + 1] += chunkStarts[chunkIndex];
+	}
+
+	//NOTE: Filling in the buckets moves each start to the start of the next bucket, so they are shifted back after
+	for(s32 index = 0; index < pool->count; index++) {
+		EntityChunk* chunk = getSpatialChunk(pool->p[index], gameState);
+		if(chunk) pool->sortedIndices[chunkStarts[chunk - gameState->chunks]++] = index;
+	}
+
+	pool->numSorted = chunkStarts[numChunks];
+
+	for(s32 chunkIndex = numChunks; chunkIndex > 0; chunkIndex--) {
+		chunkStarts[chunkIndex] = chunkStarts[chunkIndex - 1];
+	}
+
+	chunkStarts[0] = 0;
+}
+
+void removePooledProjectiles(GameState* gameState) {
+	ProjectilePool* pool = &gameState->projectiles;
+	ProjectileProxy* proxy = &pool->moving;
+	Entity* entity = &proxy->entity;
+
+	for(s32 index = 0; index < pool->count; index++) {
+		if(!pool->removed[index]) continue;
+
+		loadProjectileProxy(proxy, index, gameState);
+
+		//NOTE: This does the same thing as freeEntityDuringLevel does for a projectile
+		if(gameState->fieldSpec.hackAbilities.moveFields) {
+			ConsoleField* field = createConsoleField(gameState, (char*)"kills_enemies", ConsoleField_killsOnHit, 5);
+			Entity* pickupField = addPickupField(gameState, entity, field);
+
+			pickupField->dP.x = -30;
+			pickupField->dP.y = 4;
+		}
+
+		if(entity->type == EntityType_motherShipProjectile) {
+			addMotherShipProjectileDeath(gameState, entity);
+		}
+		else if(entity->characterAnim && entity->characterAnim->death) {
+			addDeath(gameState, entity->p, entity->renderSize, entity->drawOrder, entity->rotation, entity->characterAnim);
+		}
+
+		pool->count--;
+
+		if(index != pool->count) {
+			s32 last = pool->count;
+
+			pool->kind[index] = pool->kind[last];
+			pool->ref[index] = pool->ref[last];
+			pool->spawnerRef[index] = pool->spawnerRef[last];
+			pool->p[index] = pool->p[last];
+			pool->prevP[index] = pool->prevP[last];
+			pool->dP[index] = pool->dP[last];
+			pool->rotation[index] = pool->rotation[last];
+			pool->animTime[index] = pool->animTime[last];
+			pool->removed[index] = pool->removed[last];
+		}
+
+		index--;
+	}
+
+	sortPooledProjectiles(gameState);
+}
+
 Entity* addLaserBase_(GameState* gameState, V2 baseP, double height) {
 	Entity* result = addEntity(gameState, EntityType_laserBase, DrawOrder_laserBase, baseP, v2(0.9, 0.65));
 
@@ -2362,6 +2887,11 @@ void toggleCheckpoint(Entity* entity, GameState* gameState, bool toggleReachedFi
 
 void onCollide(Entity* entity, Entity* hitEntity, GameState* gameState, bool* solid, V2 entityVel, V2 collisionNormal, 
 			   bool collisionNormalFromHitEntity) {
+	//NOTE: Anything which can move on its own is woken up when it is hit
+	if(isSet(hitEntity, EntityFlag_asleep) && !isSleepAnchor(hitEntity)) {
+		wakeEntity(hitEntity, gameState);
+	}
+
 	ConsoleField* killField = getField(entity, ConsoleField_killsOnHit); 
 	bool killed = false;
 
@@ -2744,72 +3274,581 @@ void getPolygonCollisionTime(Hitbox* moving, Hitbox* fixed, Entity* movingEntity
 	}
 }
 
-GetCollisionTimeResult getCollisionTime(Entity* entity, GameState* gameState, V2 delta, bool actuallyMoving, 
-										double maxCollisionTime, bool ignorePenetratingEntities) {
-	GetCollisionTimeResult result = {};
-	result.collisionTime = maxCollisionTime;
-	result.solidCollisionTime = maxCollisionTime;
+//NOTE: This adds the collisions between entity and one collider to the result
+void addColliderCollisions(Entity* entity, Entity* collider, GameState* gameState, V2 delta, bool actuallyMoving,
+						   bool ignorePenetratingEntities, GetCollisionTimeResult* result) {
+	bool solidCollision = isSolidCollision(entity, collider, gameState, actuallyMoving);
 
-	if(delta == v2(0, 0)) return result;
+	Hitbox* colliderHitboxList = collider->hitboxes;
 
-	s32 partitionCenterX = (s32)(entity->p.x / gameState->chunkSize.x);
-	s32 partitionCenterY = (s32)(entity->p.y / gameState->chunkSize.y);
+	while(colliderHitboxList) {
+		R2 colliderHitbox = getBoundingBox(collider, colliderHitboxList);
+		R2 paddedColliderHitbox = addRadiusTo(colliderHitbox, v2(fabs(delta.x), fabs(delta.y)));
 
-	for (s32 partitionXOffs = -1; partitionXOffs <= 1; partitionXOffs++) {
-		for (s32 partitionYOffs = -1; partitionYOffs <= 1; partitionYOffs++) {
-			s32 partitionX = partitionCenterX + partitionXOffs;
-			s32 partitionY = partitionCenterY + partitionYOffs;
+		Hitbox* entityHitboxList = entity->hitboxes;
 
-			if (partitionX >= 0 && 
-				partitionY >= 0 && 
-				partitionX < gameState->chunksWidth && 
-				partitionY < gameState->chunksHeight) {
+		while (entityHitboxList) {
+			R2 entityHitbox = getBoundingBox(entity, entityHitboxList);
+		
+			//Broad phase
+			if(rectanglesOverlap(paddedColliderHitbox, entityHitbox)) {
+				if(ignorePenetratingEntities) {
+					entity->ignorePenetrationList = refNode(gameState, collider->ref, entity->ignorePenetrationList);
+				} else {
+					//Narrow phase
+					getPolygonCollisionTime(entityHitboxList, colliderHitboxList, entity, collider, 
+											gameState, result, delta, solidCollision);
+				}
+			}
+				
+			entityHitboxList = entityHitboxList->next;
+		}
 
-				EntityChunk* chunk = gameState->chunks + partitionY * gameState->chunksWidth + partitionX;
+		colliderHitboxList = colliderHitboxList->next;
+	}
+}
 
-				while(chunk) {
-					for (s32 colliderIndex = 0; colliderIndex < chunk->numRefs; colliderIndex++) {
-						Entity* collider = getEntityByRef(gameState, chunk->entityRefs[colliderIndex]);
-						
-						if (collider && collider != entity && collidesWith(entity, collider, gameState, ignorePenetratingEntities)) {
-							bool solidCollision = isSolidCollision(entity, collider, gameState, actuallyMoving);
+//NOTE: Pooled projectiles aren't in the spatial partition, so they are tested through the fixed proxy. If one of
+//		them is hit the proxy is left loaded with it, so the caller can pass it to onCollide like any other entity.
+void addPooledProjectileCollisions(Entity* entity, GameState* gameState, V2 delta, bool actuallyMoving,
+								   bool ignorePenetratingEntities, s32 minChunkX, s32 minChunkY, s32 maxChunkX, s32 maxChunkY,
+								   GetCollisionTimeResult* result) {
+	ProjectilePool* pool = &gameState->projectiles;
+	if(!pool->numSorted) return;
 
-							Hitbox* colliderHitboxList = collider->hitboxes;
+	ProjectileProxy* proxy = &pool->fixed;
+	Entity* collider = &proxy->entity;
+	assert(entity != collider);
 
-							while(colliderHitboxList) {
-								R2 colliderHitbox = getBoundingBox(collider, colliderHitboxList);
-								R2 paddedColliderHitbox = addRadiusTo(colliderHitbox, v2(fabs(delta.x), fabs(delta.y)));
+	s32 movingIndex = entity == &pool->moving.entity ? pool->moving.index : -1;
 
-								Hitbox* entityHitboxList = entity->hitboxes;
+	//NOTE: The proxy might already hold the earliest hit from a previous call with the same result
+	s32 hitIndex = result->hitEntity == collider ? proxy->index : -1;
 
-								while (entityHitboxList) {
-									R2 entityHitbox = getBoundingBox(entity, entityHitboxList);
-								
-									//Broad phase
-									if(rectanglesOverlap(paddedColliderHitbox, entityHitbox)) {
-										if(ignorePenetratingEntities) {
-											entity->ignorePenetrationList = refNode(gameState, collider->ref, entity->ignorePenetrationList);
-										} else {
-											//Narrow phase
-											getPolygonCollisionTime(entityHitboxList, colliderHitboxList, entity, collider, 
-																	gameState, &result, delta, solidCollision);
-										}
+	minChunkX = max(0, minChunkX);
+	minChunkY = max(0, minChunkY);
+	maxChunkX = min(gameState->chunksWidth - 1, maxChunkX);
+	maxChunkY = min(gameState->chunksHeight - 1, maxChunkY);
 
-								
-									}
-										
-									entityHitboxList = entityHitboxList->next;
-								}
-							
+	for(s32 chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+		for(s32 chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+			s32 chunkIndex = chunkY * gameState->chunksWidth + chunkX;
 
-								colliderHitboxList = colliderHitboxList->next;
-							}
-						}
+			for(s32 sortedIndex = pool->chunkStarts[chunkIndex]; sortedIndex < pool->chunkStarts[chunkIndex + 1]; sortedIndex++) {
+				s32 index = pool->sortedIndices[sortedIndex];
+
+				//NOTE: Projectiles spawned this frame aren't sorted yet, and removed ones are swapped out
+				if(index == movingIndex || index >= pool->count || pool->removed[index]) continue;
+
+				loadProjectileProxy(proxy, index, gameState);
+				if(!collidesWith(entity, collider, gameState, ignorePenetratingEntities)) continue;
+
+				double prevCollisionTime = result->collisionTime;
+				addColliderCollisions(entity, collider, gameState, delta, actuallyMoving, ignorePenetratingEntities, result);
+				if(result->collisionTime < prevCollisionTime) hitIndex = index;
+			}
+		}
+	}
+
+	if(hitIndex >= 0 && result->hitEntity == collider) {
+		loadProjectileProxy(proxy, hitIndex, gameState);
+	}
+}
+
+//NOTE: These bounds contain every hitbox of the entity whichever way it is facing, so flipping it doesn't move them
+R2 getBroadPhaseBounds(Entity* entity) {
+	R2 result = r2(entity->p, entity->p);
+
+	for(Hitbox* hitbox = entity->hitboxes; hitbox; hitbox = hitbox->next) {
+		V2 offset = hitbox->collisionOffset;
+		V2 radius = hitbox->collisionSize * 0.5 + v2(fabs(offset.x), fabs(offset.y));
+		R2 hitboxBounds = rectCenterRadius(entity->p, radius);
+
+		result.min = v2(min(result.min.x, hitboxBounds.min.x), min(result.min.y, hitboxBounds.min.y));
+		result.max = v2(max(result.max.x, hitboxBounds.max.x), max(result.max.y, hitboxBounds.max.y));
+	}
+
+	return result;
+}
+
+void addBroadPhaseEndpoints(BroadPhase* broadPhase, Entity* entity, s32 entityIndex) {
+	for(s32 endpointIndex = 0; endpointIndex < 2; endpointIndex++) {
+		broadPhase->endpointIndices[entityIndex][endpointIndex] = broadPhase->numEndpoints;
+
+		BroadPhaseEndpoint* endpoint = broadPhase->endpoints + broadPhase->numEndpoints++;
+		endpoint->ref = entity->ref;
+		endpoint->entityIndex = entityIndex;
+		endpoint->isMax = endpointIndex;
+	}
+}
+
+//NOTE: Min endpoints go before max endpoints at the same x so that touching entities are still paired
+bool endpointsInOrder(BroadPhaseEndpoint* a, BroadPhaseEndpoint* b) {
+	bool result = a->x < b->x || (a->x == b->x && (!a->isMax || b->isMax));
+	return result;
+}
+
+void setBroadPhaseEndpoint(BroadPhase* broadPhase, s32 endpointIndex, BroadPhaseEndpoint endpoint) {
+	broadPhase->endpoints[endpointIndex] = endpoint;
+	broadPhase->endpointIndices[endpoint.entityIndex][endpoint.isMax] = endpointIndex;
+}
+
+//NOTE: Moves the endpoint to where it belongs in the sorted endpoints, returns how many endpoints it moved past
+s32 siftBroadPhaseEndpoint(BroadPhase* broadPhase, s32 endpointIndex) {
+	BroadPhaseEndpoint endpoint = broadPhase->endpoints[endpointIndex];
+	s32 insertIndex = endpointIndex;
+
+	while(insertIndex > 0 && !endpointsInOrder(broadPhase->endpoints + insertIndex - 1, &endpoint)) {
+		setBroadPhaseEndpoint(broadPhase, insertIndex, broadPhase->endpoints[insertIndex - 1]);
+		insertIndex--;
+	}
+
+	while(insertIndex < broadPhase->numEndpoints - 1 && 
+		  !endpointsInOrder(&endpoint, broadPhase->endpoints + insertIndex + 1)) {
+		setBroadPhaseEndpoint(broadPhase, insertIndex, broadPhase->endpoints[insertIndex + 1]);
+		insertIndex++;
+	}
+
+	setBroadPhaseEndpoint(broadPhase, insertIndex, endpoint);
+
+	s32 result = abs(insertIndex - endpointIndex);
+	return result;
+}
+
+//NOTE: This has to be called when the entities aren't going to move until the pairs are invalidated.
+//		The endpoints can be searched by movement queries until the end of the frame.
+void updateBroadPhase(GameState* gameState) {
+	BroadPhase* broadPhase = &gameState->broadPhase;
+
+	broadPhase->pairsValid = false;
+	broadPhase->live = false;
+
+	if(broadPhase->disabled) return;
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		broadPhase->endpointIndices[entityIndex][0] = broadPhase->endpointIndices[entityIndex][1] = -1;
+	}
+
+	//NOTE: This removes the endpoints of entities which were removed or lost their hitboxes
+	bool32 inBroadPhase[arrayCount(gameState->entities)] = {};
+	s32 numEndpoints = 0;
+
+	for(s32 endpointIndex = 0; endpointIndex < broadPhase->numEndpoints; endpointIndex++) {
+		BroadPhaseEndpoint endpoint = broadPhase->endpoints[endpointIndex];
+		Entity* entity = getEntityByRef(gameState, endpoint.ref);
+
+		if(entity && entity->hitboxes) {
+			endpoint.entityIndex = (s32)(entity - gameState->entities);
+			if(!endpoint.isMax) inBroadPhase[endpoint.entityIndex] = true;
+
+			broadPhase->endpoints[numEndpoints++] = endpoint;
+		}
+	}
+
+	broadPhase->numEndpoints = numEndpoints;
+	broadPhase->maxWidth = 0;
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+		if(!entity->hitboxes) continue;
+
+		R2 bounds = addRadiusTo(getBroadPhaseBounds(entity), v2(1, 1) * BROAD_PHASE_PADDING);
+		broadPhase->bounds[entityIndex] = bounds;
+		broadPhase->maxWidth = max(broadPhase->maxWidth, getRectWidth(bounds));
+
+		if(!inBroadPhase[entityIndex]) {
+			addBroadPhaseEndpoints(broadPhase, entity, entityIndex);
+		}
+	}
+
+	for(s32 endpointIndex = 0; endpointIndex < broadPhase->numEndpoints; endpointIndex++) {
+		BroadPhaseEndpoint* endpoint = broadPhase->endpoints + endpointIndex;
+		R2 bounds = broadPhase->bounds[endpoint->entityIndex];
+		endpoint->x = endpoint->isMax ? bounds.max.x : bounds.min.x;
+	}
+
+	//NOTE: The endpoints are almost sorted from the last frame, so an insertion sort is used.
+	broadPhase->numSwaps = 0;
+	broadPhase->numRefreshes = 0;
+
+	for(s32 endpointIndex = 1; endpointIndex < broadPhase->numEndpoints; endpointIndex++) {
+		BroadPhaseEndpoint endpoint = broadPhase->endpoints[endpointIndex];
+		s32 insertIndex = endpointIndex;
+
+		while(insertIndex > 0 && !endpointsInOrder(broadPhase->endpoints + insertIndex - 1, &endpoint)) {
+			broadPhase->endpoints[insertIndex] = broadPhase->endpoints[insertIndex - 1];
+			insertIndex--;
+			broadPhase->numSwaps++;
+		}
+
+		broadPhase->endpoints[insertIndex] = endpoint;
+	}
+
+	for(s32 endpointIndex = 0; endpointIndex < broadPhase->numEndpoints; endpointIndex++) {
+		BroadPhaseEndpoint* endpoint = broadPhase->endpoints + endpointIndex;
+		broadPhase->endpointIndices[endpoint->entityIndex][endpoint->isMax] = endpointIndex;
+	}
+
+	//NOTE: This sweeps along x to find the pairs which also overlap on y
+	s32* pairA = broadPhase->pairA;
+	s32* pairB = broadPhase->pairB;
+	s32 numPairs = 0;
+	bool32 overflowed = false;
+
+	s32 active[arrayCount(gameState->entities)];
+	s32 numActive = 0;
+
+	for(s32 endpointIndex = 0; endpointIndex < broadPhase->numEndpoints; endpointIndex++) {
+		BroadPhaseEndpoint* endpoint = broadPhase->endpoints + endpointIndex;
+		s32 entityIndex = endpoint->entityIndex;
+
+		if(endpoint->isMax) {
+			for(s32 activeIndex = 0; activeIndex < numActive; activeIndex++) {
+				if(active[activeIndex] == entityIndex) {
+					active[activeIndex] = active[--numActive];
+					break;
+				}
+			}
+		} else {
+			R2 bounds = broadPhase->bounds[entityIndex];
+
+			for(s32 activeIndex = 0; activeIndex < numActive; activeIndex++) {
+				R2 activeBounds = broadPhase->bounds[active[activeIndex]];
+
+				if(bounds.min.y <= activeBounds.max.y && bounds.max.y >= activeBounds.min.y) {
+					if(numPairs < MAX_BROAD_PHASE_PAIRS) {
+						pairA[numPairs] = entityIndex;
+						pairB[numPairs] = active[activeIndex];
+						numPairs++;
+					} else {
+						overflowed = true;
+					}
+				}
+			}
+
+			active[numActive++] = entityIndex;
+		}
+	}
+
+	//NOTE: The pairs are bucketed by entity with a counting sort, each pair is stored for both entities
+	s32* pairStarts = broadPhase->pairStarts;
+	memset(pairStarts, 0, (gameState->numEntities + 1) * sizeof(s32));
+
+	for(s32 pairIndex = 0; pairIndex < numPairs; pairIndex++) {
+		pairStarts[pairA[pairIndex] + 1]++;
+		pairStarts[pairB[pairIndex] + 1]++;
+	}
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		pairStarts[entityIndex + 1] += pairStarts[entityIndex];
+	}
+
+	for(s32 pairIndex = 0; pairIndex < numPairs; pairIndex++) {
+		broadPhase->pairs[pairStarts[pairA[pairIndex]]++] = pairB[pairIndex];
+		broadPhase->pairs[pairStarts[pairB[pairIndex]]++] = pairA[pairIndex];
+	}
+
+	for(s32 entityIndex = gameState->numEntities; entityIndex > 0; entityIndex--) {
+		pairStarts[entityIndex] = pairStarts[entityIndex - 1];
+	}
+
+	pairStarts[0] = 0;
+
+	broadPhase->numPairs = numPairs;
+	broadPhase->numEntities = gameState->numEntities;
+
+	//NOTE: If there were too many pairs the ground queries just search the endpoints
+	broadPhase->pairsValid = !overflowed;
+	broadPhase->live = true;
+}
+
+//NOTE: This is called whenever an entity moves. Its endpoints are only moved once it leaves its padded bounds, 
+//		so the padded bounds always contain the entity and the endpoints can still be searched.
+void refreshBroadPhaseEntity(Entity* entity, GameState* gameState) {
+	BroadPhase* broadPhase = &gameState->broadPhase;
+	if(!broadPhase->live || !entity->hitboxes) return;
+
+	//NOTE: Entities which were added after the endpoints were sorted (and the projectile proxies) aren't in them
+	s32 entityIndex = (s32)(entity - gameState->entities);
+	if(entityIndex < 0 || entityIndex >= broadPhase->numEntities) return;
+
+	R2 bounds = getBroadPhaseBounds(entity);
+	R2* paddedBounds = broadPhase->bounds + entityIndex;
+	s32* endpointIndices = broadPhase->endpointIndices[entityIndex];
+
+	if(endpointIndices[0] >= 0 &&
+	   bounds.min.x >= paddedBounds->min.x && bounds.min.y >= paddedBounds->min.y &&
+	   bounds.max.x <= paddedBounds->max.x && bounds.max.y <= paddedBounds->max.y) return;
+
+	*paddedBounds = addRadiusTo(bounds, v2(1, 1) * BROAD_PHASE_PADDING);
+	broadPhase->maxWidth = max(broadPhase->maxWidth, getRectWidth(*paddedBounds));
+
+	//NOTE: The pairs were made from the old bounds
+	broadPhase->pairsValid = false;
+
+	//NOTE: The entity didn't have any hitboxes when the endpoints were sorted
+	if(endpointIndices[0] < 0) {
+		addBroadPhaseEndpoints(broadPhase, entity, entityIndex);
+	}
+
+	broadPhase->endpoints[endpointIndices[0]].x = paddedBounds->min.x;
+	broadPhase->numSwaps += siftBroadPhaseEndpoint(broadPhase, endpointIndices[0]);
+
+	broadPhase->endpoints[endpointIndices[1]].x = paddedBounds->max.x;
+	broadPhase->numSwaps += siftBroadPhaseEndpoint(broadPhase, endpointIndices[1]);
+
+	broadPhase->numRefreshes++;
+}
+
+//NOTE: Writes the entities whose padded bounds overlap bounds to colliders and returns how many there are. 
+//		Returns -1 if the endpoints can't be used, then the spatial partition has to be searched instead.
+s32 queryBroadPhase(GameState* gameState, R2 bounds, Entity** colliders, s32 maxColliders) {
+	BroadPhase* broadPhase = &gameState->broadPhase;
+	if(!broadPhase->live) return -1;
+
+	s32 result = 0;
+
+	//NOTE: Anything which overlaps the bounds has its min endpoint at most maxWidth before them
+	double startX = bounds.min.x - broadPhase->maxWidth;
+	s32 first = 0;
+	s32 last = broadPhase->numEndpoints;
+
+	while(first < last) {
+		s32 middle = (first + last) / 2;
+
+		if(broadPhase->endpoints[middle].x < startX) first = middle + 1;
+		else last = middle;
+	}
+
+	for(s32 endpointIndex = first; endpointIndex < broadPhase->numEndpoints; endpointIndex++) {
+		BroadPhaseEndpoint* endpoint = broadPhase->endpoints + endpointIndex;
+		if(endpoint->x > bounds.max.x) break;
+		if(endpoint->isMax) continue;
+
+		if(rectanglesOverlap(broadPhase->bounds[endpoint->entityIndex], bounds)) {
+			if(result == maxColliders) return -1;
+			colliders[result++] = gameState->entities + endpoint->entityIndex;
+		}
+	}
+
+	for(s32 entityIndex = broadPhase->numEntities; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+
+		if(entity->hitboxes) {
+			if(result == maxColliders) return -1;
+			colliders[result++] = entity;
+		}
+	}
+
+	return result;
+}
+
+void invalidateBroadPhasePairs(GameState* gameState) {
+	gameState->broadPhase.pairsValid = false;
+}
+
+//NOTE: Called at the end of the frame, anything can change the entities before the next frame starts
+void invalidateBroadPhase(GameState* gameState) {
+	gameState->broadPhase.pairsValid = false;
+	gameState->broadPhase.live = false;
+}
+
+void resetBroadPhase(GameState* gameState) {
+	gameState->broadPhase.numEndpoints = 0;
+	invalidateBroadPhase(gameState);
+}
+
+//NOTE: Returns the index of the entity if the broad phase pairs can be used for a query, otherwise -1
+s32 getBroadPhaseIndex(Entity* entity, GameState* gameState, V2 delta) {
+	BroadPhase* broadPhase = &gameState->broadPhase;
+	s32 result = -1;
+
+	if(broadPhase->pairsValid && 
+	   fabs(delta.x) <= BROAD_PHASE_PADDING && 
+	   fabs(delta.y) <= BROAD_PHASE_PADDING) {
+		s32 entityIndex = (s32)(entity - gameState->entities);
+
+		if(entityIndex >= 0 && entityIndex < broadPhase->numEntities) {
+			result = entityIndex;
+		}
+	}
+
+	return result;
+}
+
+GetCollisionTimeResult getCollisionTime(Entity* entity, GameState* gameState, V2 delta, bool actuallyMoving,
+										double maxCollisionTime, bool ignorePenetratingEntities) {
+	GetCollisionTimeResult result = {};
+	result.collisionTime = maxCollisionTime;
+	result.solidCollisionTime = maxCollisionTime;
+
+	if(delta == v2(0, 0)) return result;
+
+	s32 partitionCenterX = (s32)(entity->p.x / gameState->chunkSize.x);
+	s32 partitionCenterY = (s32)(entity->p.y / gameState->chunkSize.y);
+
+	s32 broadPhaseIndex = getBroadPhaseIndex(entity, gameState, delta);
+
+	if(broadPhaseIndex >= 0) {
+		BroadPhase* broadPhase = &gameState->broadPhase;
+
+		for(s32 pairIndex = broadPhase->pairStarts[broadPhaseIndex]; pairIndex < broadPhase->pairStarts[broadPhaseIndex + 1]; pairIndex++) {
+			Entity* collider = gameState->entities + broadPhase->pairs[pairIndex];
+
+			if (collidesWith(entity, collider, gameState, ignorePenetratingEntities)) {
+				addColliderCollisions(entity, collider, gameState, delta, actuallyMoving, ignorePenetratingEntities, &result);
+			}
+		}
+	} else {
+		R2 queryBounds = addRadiusTo(getBroadPhaseBounds(entity), v2(fabs(delta.x), fabs(delta.y)));
+
+		Entity* colliders[MAX_BROAD_PHASE_QUERY_COLLIDERS];
+		s32 numColliders = queryBroadPhase(gameState, queryBounds, colliders, arrayCount(colliders));
+
+		for(s32 colliderIndex = 0; colliderIndex < numColliders; colliderIndex++) {
+			Entity* collider = colliders[colliderIndex];
+
+			if (collider != entity && collidesWith(entity, collider, gameState, ignorePenetratingEntities)) {
+				addColliderCollisions(entity, collider, gameState, delta, actuallyMoving, ignorePenetratingEntities, &result);
+			}
+		}
+
+		if(numColliders < 0) {
+			for (s32 partitionXOffs = -1; partitionXOffs <= 1; partitionXOffs++) {
+				for (s32 partitionYOffs = -1; partitionYOffs <= 1; partitionYOffs++) {
+					s32 partitionX = partitionCenterX + partitionXOffs;
+					s32 partitionY = partitionCenterY + partitionYOffs;
+
+					if (partitionX >= 0 && 
+						partitionY >= 0 && 
+						partitionX < gameState->chunksWidth && 
+						partitionY < gameState->chunksHeight) {
+
+						EntityChunk* chunk = gameState->chunks + partitionY * gameState->chunksWidth + partitionX;
+
+						while(chunk) {
+							for (s32 colliderIndex = 0; colliderIndex < chunk->numRefs; colliderIndex++) {
+								Entity* collider = getEntityByRef(gameState, chunk->entityRefs[colliderIndex]);
+								
+								if (collider && collider != entity && collidesWith(entity, collider, gameState, ignorePenetratingEntities)) {
+									addColliderCollisions(entity, collider, gameState, delta, actuallyMoving, ignorePenetratingEntities, &result);
+								}
+							}
+							chunk = chunk->next;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	addPooledProjectileCollisions(entity, gameState, delta, actuallyMoving, ignorePenetratingEntities,
+								  partitionCenterX - 1, partitionCenterY - 1, partitionCenterX + 1, partitionCenterY + 1, &result);
+
+	return result;
+}
+
+bool clipSweepAxis(double start, double move, double rectMin, double rectMax, double* tMin, double* tMax) {
+	if(move == 0) {
+		bool result = start >= rectMin && start <= rectMax;
+		return result;
+	}
+
+	double t1 = (rectMin - start) / move;
+	double t2 = (rectMax - start) / move;
+
+	if(t1 > t2) {
+		double temp = t1;
+		t1 = t2;
+		t2 = temp;
+	}
+
+	*tMin = max(*tMin, t1);
+	*tMax = min(*tMax, t2);
+
+	bool result = *tMin <= *tMax;
+	return result;
+}
+
+//NOTE: Returns the time (from 0 to 1) at which a circle moving along delta first touches the rectangle,
+//		or 2 if it never does. The circle is treated as a square, so this is conservative.
+double getSweptCircleEntryTime(V2 center, double radius, V2 delta, R2 rect) {
+	R2 padded = addRadiusTo(rect, v2(radius, radius));
+
+	double tMin = 0;
+	double tMax = 1;
+
+	double result = 2;
+
+	if(clipSweepAxis(center.x, delta.x, padded.min.x, padded.max.x, &tMin, &tMax) &&
+	   clipSweepAxis(center.y, delta.y, padded.min.y, padded.max.y, &tMin, &tMax)) {
+		result = tMin;
+	}
+
+	return result;
+}
+
+void addSweptColliderCollisions(Entity* entity, Hitbox* hitbox, V2 center, double radius, Entity* collider, 
+								GameState* gameState, V2 delta, GetCollisionTimeResult* result) {
+	if(collider == entity || !collidesWith(entity, collider, gameState)) return;
+
+	for(Hitbox* colliderHitbox = collider->hitboxes; colliderHitbox; colliderHitbox = colliderHitbox->next) {
+		R2 colliderBounds = getBoundingBox(collider, colliderHitbox);
+		double entryTime = getSweptCircleEntryTime(center, radius, delta, colliderBounds);
+
+		if(entryTime < result->collisionTime) {
+			getPolygonCollisionTime(hitbox, colliderHitbox, entity, collider, gameState, result, delta, false);
+		}
+	}
+}
+
+//NOTE: This is the projectile version of getCollisionTime. Projectiles are small and never collide solidly, 
+//		so each hitbox is swept as a circle against the bounding boxes of everything in the chunks it passes 
+//		through. Only colliders which the circle reaches before the current earliest hit go through the 
+//		polygon narrow phase, so the result is the same as getCollisionTime but far fewer tests are done.
+//		Unlike getCollisionTime, fast projectiles can't skip past the neighbouring chunks.
+GetCollisionTimeResult getProjectileCollisionTime(Entity* entity, GameState* gameState, V2 delta, double maxCollisionTime) {
+	GetCollisionTimeResult result = {};
+	result.collisionTime = maxCollisionTime;
+	result.solidCollisionTime = maxCollisionTime;
+
+	if(delta == v2(0, 0)) return result;
+
+	for(Hitbox* hitbox = entity->hitboxes; hitbox; hitbox = hitbox->next) {
+		V2 center = getHitboxCenter(hitbox, entity);
+		double radius = length(hitbox->collisionSize) * 0.5;
+
+		R2 sweep = addRadiusTo(r2(center, center + delta), v2(radius, radius));
+
+		//NOTE: Colliders are stored in the chunk of their center, so one extra chunk is checked on each side
+		s32 minChunkX = max(0, (s32)floor(sweep.min.x / gameState->chunkSize.x) - 1);
+		s32 minChunkY = max(0, (s32)floor(sweep.min.y / gameState->chunkSize.y) - 1);
+		s32 maxChunkX = min(gameState->chunksWidth - 1, (s32)floor(sweep.max.x / gameState->chunkSize.x) + 1);
+		s32 maxChunkY = min(gameState->chunksHeight - 1, (s32)floor(sweep.max.y / gameState->chunkSize.y) + 1);
+
+		Entity* colliders[MAX_BROAD_PHASE_QUERY_COLLIDERS];
+		s32 numColliders = queryBroadPhase(gameState, sweep, colliders, arrayCount(colliders));
+
+		for(s32 colliderIndex = 0; colliderIndex < numColliders; colliderIndex++) {
+			addSweptColliderCollisions(entity, hitbox, center, radius, colliders[colliderIndex], gameState, delta, &result);
+		}
+
+		if(numColliders < 0) {
+			for(s32 chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+				for(s32 chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+					EntityChunk* chunk = gameState->chunks + chunkY * gameState->chunksWidth + chunkX;
+
+					for(; chunk; chunk = chunk->next) {
+						for (s32 colliderIndex = 0; colliderIndex < chunk->numRefs; colliderIndex++) {
+							Entity* collider = getEntityByRef(gameState, chunk->entityRefs[colliderIndex]);
+							if(collider) addSweptColliderCollisions(entity, hitbox, center, radius, collider, gameState, delta, &result);
+						}
 					}
-					chunk = chunk->next;
 				}
 			}
 		}
+
+		addPooledProjectileCollisions(entity, gameState, delta, true, false, minChunkX, minChunkY, maxChunkX, maxChunkY, &result);
 	}
 
 	return result;
@@ -2876,8 +3915,56 @@ void adjustVelocitiesFromHit(V2 normal, V2* delta, V2* dP, V2* ddP) {
 	}
 }
 
+TileMove* allocateTileMove(GameState* gameState, Entity* tile) {
+	TileMove* result = NULL;
+
+	if(gameState->tileMoveFreeList) {
+		result = gameState->tileMoveFreeList;
+		gameState->tileMoveFreeList = gameState->tileMoveFreeList->next;
+	} else {
+		result = pushStruct(&gameState->levelStorage, TileMove);
+	}
+
+	*result = {};
+	result->tile = tile;
+
+	tile->tileMove = result;
+	tile->tileMoveSolve = gameState->tileMoveSolveCount;
+
+	return result;
+}
+
+TileMoveNode* tileMoveNode(GameState* gameState, TileMove* move, TileMoveNode* next) {
+	TileMoveNode* result = NULL;
+
+	if(gameState->tileMoveNodeFreeList) {
+		result = gameState->tileMoveNodeFreeList;
+		gameState->tileMoveNodeFreeList = gameState->tileMoveNodeFreeList->next;
+	} else {
+		result = pushStruct(&gameState->levelStorage, TileMoveNode);
+	}
+
+	result->move = move;
+	result->next = next;
+
+	return result;
+}
+
+void freeTileMoveNodes(TileMoveNode* node, GameState* gameState) {
+	while(node) {
+		TileMoveNode* next = node->next;
+
+		node->move = NULL;
+		node->next = gameState->tileMoveNodeFreeList;
+		gameState->tileMoveNodeFreeList = node;
+
+		node = next;
+	}
+}
+
+//NOTE: This moves the entity without moving any of the entities which it supports
 //Returns the total movement that is made
-V2 moveRaw(Entity* entity, GameState* gameState, V2 delta, V2* ddP, double rotation) {
+V2 moveSingleRaw(Entity* entity, GameState* gameState, V2 delta, V2* ddP, double rotation) {
 	V2 startP = entity->p;
 
 	double epsilon = 0.005;
@@ -2957,50 +4044,349 @@ V2 moveRaw(Entity* entity, GameState* gameState, V2 delta, V2* ddP, double rotat
 				onCollide(collisionResult.hitEntity, entity, gameState, &solid2, v2(0, 0), 
 					      collisionResult.collisionNormal, collisionResult.collisionNormalFromHitEntity);
 
-				if(!collisionResult.solidEntity && (solid1 || solid2)) {
-					adjustVelocitiesFromHit(collisionResult.collisionNormal, &delta, &entity->dP, ddP);
+				storeProjectileProxyIfHit(collisionResult.hitEntity, gameState);
+
+				if(!collisionResult.solidEntity && (solid1 || solid2)) {
+					adjustVelocitiesFromHit(collisionResult.collisionNormal, &delta, &entity->dP, ddP);
+				}
+			}
+		}
+	}
+
+	V2 totalMovement = (entity->p - startP) * (1 + epsilon);
+	double totalMovementLenSq = lengthSq(totalMovement); 
+
+	if (totalMovementLenSq > 0) {
+		if(entity->type == EntityType_trawler) {
+			double totalMovementLen = sqrt(totalMovementLenSq);
+
+			double diameter = (entity->renderSize.x + entity->renderSize.y) * 0.5;
+			double circumference = PI * diameter;
+
+			double rotationFudge = 20;
+
+			double rot = totalMovementLen / circumference * rotationFudge;
+			if(totalMovement.x > 0) rot *= -1;
+
+			entity->wheelRotation += rot;
+		}
+	}
+
+	return totalMovement;
+}
+
+//NOTE: Moves a tile from the support graph by the movement of the first of its supports that moved. 
+//		Its children are pushed onto the stack once all of their supports in the graph have been moved.
+void moveTileMove(TileMove* move, GameState* gameState, TileMoveNode** stack) {
+	V2 movement = v2(0, 0);
+
+	if(move->hasMovement) {
+		setFlags(move->tile, EntityFlag_movedByGround);
+		movement = moveSingleRaw(move->tile, gameState, move->movement, NULL, move->tile->rotation);
+	}
+
+	move->numParents = -1;
+
+	for(TileMoveNode* child = move->children; child; child = child->next) {
+		TileMove* childMove = child->move;
+		if(childMove->numParents < 0) continue;
+
+		//NOTE: The ground reference could have been removed if the child was moved out of the way 
+		//		while this tile was moving
+		if(!childMove->hasMovement && lengthSq(movement) > 0 &&
+		   refNodeListContainsRef(move->tile->groundReferenceList, childMove->tile->ref)) {
+			childMove->hasMovement = true;
+			childMove->movement = movement;
+		}
+
+		childMove->numParents--;
+
+		if(childMove->numParents == 0) {
+			*stack = tileMoveNode(gameState, childMove, *stack);
+		}
+	}
+}
+
+//NOTE: This moves all of the entities which are supported by the ground (directly or through other entities).
+//		The support graph is built once, then it is walked with an explicit stack in topological order
+//		so that each entity is only moved (and does its collision queries) once, after all of its supports. 
+//		This replaces recursing through the ground reference lists, which was very deep for tall stacks.
+//NOTE: Each tile's collision queries are still made by itself when it is moved, they can't be batched up front 
+//		because where a tile ends up depends on how far the tiles under it were able to move.
+void moveSupportedEntities(Entity* ground, GameState* gameState, V2 movement) {
+	//NOTE: Moving a tile can start another solve, so the nodes are stamped with the solve they belong to
+	gameState->tileMoveSolveCount++;
+
+	TileMove* root = allocateTileMove(gameState, ground);
+	TileMove* lastMove = root;
+
+	for(TileMove* move = root; move; move = move->next) {
+		for(RefNode* node = move->tile->groundReferenceList; node; node = node->next) {
+			Entity* top = getEntityByRef(gameState, node->ref);
+			if (!top || isSet(top, EntityFlag_movedByGround)) continue;
+
+			TileMove* topMove = NULL;
+			if(top->tileMoveSolve == gameState->tileMoveSolveCount) topMove = top->tileMove;
+
+			if(!topMove) {
+				topMove = allocateTileMove(gameState, top);
+				lastMove->next = topMove;
+				lastMove = topMove;
+			}
+
+			topMove->numParents++;
+			move->children = tileMoveNode(gameState, topMove, move->children);
+		}
+	}
+
+	//NOTE: The ground has already been moved, so its movement is just passed on to its children
+	root->numParents = -1;
+
+	for(TileMoveNode* child = root->children; child; child = child->next) {
+		TileMove* childMove = child->move;
+
+		if(!childMove->hasMovement) {
+			childMove->hasMovement = true;
+			childMove->movement = movement;
+		}
+	}
+
+	TileMoveNode* stack = NULL;
+
+	for(TileMoveNode* child = root->children; child; child = child->next) {
+		TileMove* childMove = child->move;
+		childMove->numParents--;
+
+		if(childMove->numParents == 0) {
+			stack = tileMoveNode(gameState, childMove, stack);
+		}
+	}
+
+	TileMove* remaining = root;
+
+	for(;;) {
+		while(stack) {
+			TileMoveNode* top = stack;
+			stack = stack->next;
+
+			TileMove* move = top->move;
+			top->next = NULL;
+			freeTileMoveNodes(top, gameState);
+
+			moveTileMove(move, gameState, &stack);
+		}
+
+		//NOTE: Anything left over is part of a cycle of ground references, so it is just moved in order
+		while(remaining && remaining->numParents < 0) remaining = remaining->next;
+		if(!remaining) break;
+
+		remaining->numParents = 0;
+		stack = tileMoveNode(gameState, remaining, stack);
+	}
+
+	TileMove* move = root;
+
+	while(move) {
+		TileMove* next = move->next;
+
+		freeTileMoveNodes(move->children, gameState);
+		move->children = NULL;
+		move->tile = NULL;
+
+		move->next = gameState->tileMoveFreeList;
+		gameState->tileMoveFreeList = move;
+
+		move = next;
+	}
+}
+
+//Returns the total movement that is made
+V2 moveRaw(Entity* entity, GameState* gameState, V2 delta, V2* ddP, double rotation) {
+	V2 result = moveSingleRaw(entity, gameState, delta, ddP, rotation);
+
+	if(lengthSq(result) > 0) {
+		moveSupportedEntities(entity, gameState, result);
+	}
+
+	return result;
+}
+
+V2 moveRaw(Entity* entity, GameState* gameState, V2 delta, V2* ddP) {
+	V2 result = moveRaw(entity, gameState, delta, ddP, entity->rotation);
+	return result;
+}
+
+//NOTE: This is the fast path for moving projectiles which don't have a movement field. It makes the same 
+//		onCollide calls as moveRaw, but projectiles can't support other entities or be blocked so none of 
+//		that has to be handled.
+void moveProjectile(Entity* entity, GameState* gameState, double dt, double rotation) {
+	assert(isProjectile(entity));
+
+	//NOTE: Collisions with projectiles are never solid, so they can always be rotated
+	entity->rotation = rotation;
+
+	V2 delta = dt * entity->dP;
+	double epsilon = 0.005;
+	double remainingCollisionTime = 1;
+
+	for (s32 moveIteration = 0; moveIteration < 4 && remainingCollisionTime > 0; moveIteration++) {
+		if(delta == v2(0, 0)) break;
+
+		GetCollisionTimeResult collisionResult = getProjectileCollisionTime(entity, gameState, delta, remainingCollisionTime);
+		assert(collisionResult.collisionTime >= 0 && collisionResult.collisionTime <= remainingCollisionTime);
+
+		double collisionTime = collisionResult.collisionTime;
+		remainingCollisionTime -= collisionTime;
+
+		collisionTime = max(0, collisionTime - epsilon);
+		V2 newP = entity->p + collisionTime * delta;
+
+		//NOTE: Pooled projectiles aren't in the spatial partition, the pool is re-sorted every frame instead
+		if(isProjectileProxy(entity, gameState)) entity->p = newP;
+		else setEntityP(entity, newP, gameState);
+
+		if(collisionResult.hitEntity) {
+			bool solid1 = false;
+			bool solid2 = false;
+
+			onCollide(entity, collisionResult.hitEntity, gameState, &solid1, delta, 
+					  collisionResult.collisionNormal, collisionResult.collisionNormalFromHitEntity);
+			onCollide(collisionResult.hitEntity, entity, gameState, &solid2, v2(0, 0), 
+				      collisionResult.collisionNormal, collisionResult.collisionNormalFromHitEntity);
+
+			storeProjectileProxyIfHit(collisionResult.hitEntity, gameState);
+
+			if(solid1 || solid2) {
+				adjustVelocitiesFromHit(collisionResult.collisionNormal, &delta, &entity->dP, NULL);
+			}
+		}
+	}
+}
+
+//NOTE: This does the same work for the pooled projectiles as updateAndRenderEntities does for a projectile entity
+R2 getRenderCullBounds(GameState* gameState) {
+	R2 cameraBounds = translateRect(gameState->renderGroup->windowBounds, gameState->camera.p);
+	R2 result = addRadiusTo(cameraBounds, v2(1, 1) * RENDER_CULL_MARGIN);
+	return result;
+}
+
+//NOTE: This uses the bounds of the entity at any rotation
+bool isEntityBoundsVisible(Entity* entity, R2 cullBounds) {
+	double radius = length(entity->renderSize) * 0.5;
+	bool result = rectanglesOverlap(cullBounds, rectCenterRadius(entity->p, v2(radius, radius)));
+	return result;
+}
+
+//NOTE: Entities are stored in the chunk of their center, so the chunks one past the cull bounds are also checked.
+//		Entities which are outside of the spatial partition or bigger than a chunk are checked on their own.
+void markVisibleEntities(GameState* gameState) {
+	R2 cullBounds = getRenderCullBounds(gameState);
+	double maxChunkedRadius = min(gameState->chunkSize.x, gameState->chunkSize.y);
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+		clearFlags(entity, EntityFlag_visible);
+
+		bool checkOnItsOwn = !getSpatialChunk(entity->p, gameState) || length(entity->renderSize) * 0.5 > maxChunkedRadius;
+
+		if(checkOnItsOwn && isEntityBoundsVisible(entity, cullBounds)) {
+			setFlags(entity, EntityFlag_visible);
+		}
+	}
+
+	s32 minChunkX = max(0, (s32)floor(cullBounds.min.x / gameState->chunkSize.x) - 1);
+	s32 minChunkY = max(0, (s32)floor(cullBounds.min.y / gameState->chunkSize.y) - 1);
+	s32 maxChunkX = min(gameState->chunksWidth - 1, (s32)floor(cullBounds.max.x / gameState->chunkSize.x) + 1);
+	s32 maxChunkY = min(gameState->chunksHeight - 1, (s32)floor(cullBounds.max.y / gameState->chunkSize.y) + 1);
+
+	for(s32 chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+		for(s32 chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+			EntityChunk* chunk = gameState->chunks + chunkY * gameState->chunksWidth + chunkX;
+
+			for(; chunk; chunk = chunk->next) {
+				for (s32 refIndex = 0; refIndex < chunk->numRefs; refIndex++) {
+					Entity* entity = getEntityByRef(gameState, chunk->entityRefs[refIndex]);
+
+					if(entity && isEntityBoundsVisible(entity, cullBounds)) {
+						setFlags(entity, EntityFlag_visible);
+					}
 				}
 			}
 		}
 	}
+}
 
-	//NOTE: This moves all of the entities which are supported by this one (as the ground)
-	RefNode* nextTopEntity = entity->groundReferenceList;
+//NOTE: Frames can be drawn more often than the simulation steps, so things are drawn partway between where they were at
+//		the start of the last step and where they are now
+V2 getRenderP(V2 prevP, V2 p, GameState* gameState) {
+	V2 result = p;
 
-	V2 totalMovement = (entity->p - startP) * (1 + epsilon);
-	double totalMovementLenSq = lengthSq(totalMovement); 
+	if(dstSq(prevP, p) < square(MAX_INTERPOLATION_DISTANCE)) {
+		result = prevP + (p - prevP) * gameState->renderInterpolation;
+	}
 
-	if (totalMovementLenSq > 0) {
-		while (nextTopEntity) {
-			Entity* top = getEntityByRef(gameState, nextTopEntity->ref);
-			if (top && !isSet(top, EntityFlag_movedByGround)) {
-				setFlags(top, EntityFlag_movedByGround);
-				moveRaw(top, gameState, totalMovement, NULL);
+	return result;
+}
+
+void updateAndRenderPooledProjectiles(GameState* gameState, double dt) {
+	ProjectilePool* pool = &gameState->projectiles;
+	ProjectileProxy* proxy = &pool->moving;
+	Entity* entity = &proxy->entity;
+
+	R2 world = r2(v2(0, 0), gameState->worldSize);
+	R2 cullBounds = getRenderCullBounds(gameState);
+	CullStats* cullStats = &gameState->renderGroup->frame->cullStats;
+
+	for(s32 index = 0; index < pool->count; index++) {
+		loadProjectileProxy(proxy, index, gameState);
+
+		if(dt > 0) {
+			pool->prevP[index] = entity->p;
+
+			double rotation = entity->rotation;
+			if(entity->type == EntityType_motherShipProjectile) rotation -= dt * 2.0;
+
+			moveProjectile(entity, gameState, dt, rotation);
+		}
+
+		bool insideLevel = false;
+
+		for(Hitbox* hitbox = entity->hitboxes; hitbox; hitbox = hitbox->next) {
+			if(rectanglesOverlap(world, getBoundingBox(entity, hitbox))) {
+				insideLevel = true;
+				break;
 			}
-			nextTopEntity = nextTopEntity->next;
 		}
 
-		if(entity->type == EntityType_trawler) {
-			double totalMovementLen = sqrt(totalMovementLenSq);
+		if((gameState->gravity.y <= 0 && entity->p.y < -entity->renderSize.y / 2) ||
+		   (gameState->gravity.y >= 0 && entity->p.y > gameState->windowSize.y + entity->renderSize.y / 2)) {
+			insideLevel = false;
+		}
 
-			double diameter = (entity->renderSize.x + entity->renderSize.y) * 0.5;
-			double circumference = PI * diameter;
+		if(!insideLevel) setFlags(entity, EntityFlag_remove);
 
-			double rotationFudge = 20;
+		storeProjectileProxy(proxy, gameState);
+		pool->animTime[index] += dt;
 
-			double rot = totalMovementLen / circumference * rotationFudge;
-			if(totalMovement.x > 0) rot *= -1;
+		#if DRAW_ENTITIES
+		if(isEntityBoundsVisible(entity, cullBounds)) {
+			cullStats->entitiesVisible++;
 
-			entity->wheelRotation += rot;
-		}
-	}
+			Texture* texture = entity->defaultTex;
 
-	return totalMovement;
-}
+			if(entity->type == EntityType_motherShipProjectile) {
+				texture = getAnimationFrame(&gameState->motherShipImages.projectileMoving, pool->animTime[index]);
+			}
 
-V2 moveRaw(Entity* entity, GameState* gameState, V2 delta, V2* ddP) {
-	V2 result = moveRaw(entity, gameState, delta, ddP, entity->rotation);
-	return result;
+			V2 renderP = getRenderP(pool->prevP[index], entity->p, gameState);
+			R2 bounds = rectCenterDiameter(renderP, entity->renderSize);
+			pushTexture(gameState->renderGroup, texture, bounds, entity->rotation, false, false, entity->drawOrder, true,
+						WHITE, entity->emissivity);
+		} else {
+			cullStats->entitiesCulled++;
+		}
+		#endif
+	}
 }
 
 V2 move(Entity* entity, double dt, GameState* gameState, V2 ddP, double rotation) {
@@ -3490,9 +4876,12 @@ V2 computePath(GameState* gameState, Entity* start, Entity* goal) {
 	return start->p;
 }
 
+//NOTE: The camera follows where the entity is drawn, otherwise the entity would shake when frames are drawn between steps
 void centerCameraAround(Entity* entity, GameState* gameState) {
+	V2 renderP = getRenderP(entity->prevP, entity->p, gameState);
+
 	double maxCameraX = max(0, gameState->mapSize.x - gameState->windowSize.x);
-	double x = clamp((double)(entity->p.x - gameState->windowSize.x / 2.0), 0, maxCameraX);
+	double x = clamp((double)(renderP.x - gameState->windowSize.x / 2.0), 0, maxCameraX);
 
 	gameState->camera.newP = v2(x, 0);
 }
@@ -3693,26 +5082,26 @@ Entity* updateSpotlightBasedOnSpotlightField(Entity* entity, GameState* gameStat
 
 	V3 lightColor = v3(1, 1, .9);
 	
-#if ENABLE_LIGHTING
-	lightColor *= (1 - entity->cloakFactor);
-	SpotLight spotLight = createSpotLight(entity->p, lightColor, sightRadius, lightAngle, fov);
-	pushSpotLight(gameState->renderGroup, &spotLight, true);
-#else
-	u8 r = (u8)(255 * lightColor.x);
-	u8 g = (u8)(255 * lightColor.y);
-	u8 b = (u8)(255 * lightColor.z);
-	u8 a = (u8)(25 * (1 - entity->cloakFactor));
+	if(gameState->renderGroup->lightingEnabled) {
+		lightColor *= (1 - entity->cloakFactor);
+		SpotLight spotLight = createSpotLight(entity->p, lightColor, sightRadius, lightAngle, fov);
+		pushSpotLight(gameState->renderGroup, &spotLight, true);
+	} else {
+		u8 r = (u8)(255 * lightColor.x);
+		u8 g = (u8)(255 * lightColor.y);
+		u8 b = (u8)(255 * lightColor.z);
+		u8 a = (u8)(25 * (1 - entity->cloakFactor));
 
-	Color color = createColor(r, g, b, a);
+		Color color = createColor(r, g, b, a);
 
-	V2 boundsOffset = v2(0.5, 0) * sightRadius;
-	boundsOffset = rotate(boundsOffset, lightAngle);
+		V2 boundsOffset = v2(0.5, 0) * sightRadius;
+		boundsOffset = rotate(boundsOffset, lightAngle);
 
-	R2 lightBounds = rectCenterDiameter(entity->p + boundsOffset, v2(1, 1) * sightRadius);
+		R2 lightBounds = rectCenterDiameter(entity->p + boundsOffset, v2(1, 1) * sightRadius);
 
-	pushTexture(gameState->renderGroup, gameState->lightTriangle, lightBounds, lightAngle, false, false, DrawOrder_light,
-				true, color, 1);
-#endif
+		pushTexture(gameState->renderGroup, gameState->lightTriangle, lightBounds, lightAngle, false, false, DrawOrder_light,
+					true, color, 1);
+	}
 
 	Entity* target = getClosestTargetInSight(entity, gameState, sightRadius, fov); 
 
@@ -3796,16 +5185,16 @@ bool shootBasedOnShootingField(Entity* entity, GameState* gameState, double dt,
 						double bulletSpeed = bulletSpeedField->doubleValues[bulletSpeedField->selectedIndex];
 
 						if(shootField->shootEntityType == EntityType_motherShip) {
-							addMotherShipProjectile(gameState, spawnP, target->p, entity->ref, bulletSpeed);
+							spawnProjectile(gameState, ProjectileKind_motherShipProjectile, spawnP, target->p, entity->ref, bulletSpeed);
 						} 
 						else if(shootField->shootEntityType == EntityType_trojan) {
-							addTrojanBolt(gameState, spawnP, target->p, entity->ref, bulletSpeed);
+							spawnProjectile(gameState, ProjectileKind_trojanBolt, spawnP, target->p, entity->ref, bulletSpeed);
 						}
 						else if(shootField->shootEntityType == EntityType_trawler) {
-							addTrawlerBolt(gameState, spawnP, target->p, entity->ref, bulletSpeed, TRAWLER_BOLT_SIZE);
+							spawnProjectile(gameState, ProjectileKind_trawlerBolt, spawnP, target->p, entity->ref, bulletSpeed);
 						}
 						else if(shootField->shootEntityType == EntityType_shrike) {
-							addTrawlerBolt(gameState, spawnP, target->p, entity->ref, bulletSpeed, SHRIKE_BOLT_SIZE);
+							spawnProjectile(gameState, ProjectileKind_shrikeBolt, spawnP, target->p, entity->ref, bulletSpeed);
 						}
 						else {
 							InvalidCodePath;
@@ -3920,19 +5309,19 @@ bool tryPatrolMove(Entity* entity, GameState* gameState, double xMoveAcceleratio
 	return shouldChangeDirection;
 }
 
-void drawCollisionBounds(Entity* entity, RenderGroup* renderGroup, double alpha) {
+void drawCollisionBounds(Entity* entity, V2 renderP, RenderGroup* renderGroup, RenderFrame* frame, double alpha) {
 	Hitbox* hitbox = entity->hitboxes;
 
 	u8 a = (u8)(255.5 * alpha);
 	Color color = createColor(255, 0, 0, a);
 
 	while (hitbox) {
-		V2 hitboxOffset = getHitboxCenter(hitbox, entity);
+		V2 hitboxOffset = getHitboxCenter(hitbox, entity) + renderP - entity->p;
 
 		updateHitboxRotatedPoints(hitbox, entity);
 
 		#if 0
-		pushOutlinedRect(renderGroup, getBoundingBox(entity, hitbox),
+		pushOutlinedRect(renderGroup, frame, getBoundingBox(entity, hitbox),
 						 0.02f, createColor(255, 127, 255, 255), true);
 		#endif
 
@@ -3942,7 +5331,7 @@ void drawCollisionBounds(Entity* entity, RenderGroup* renderGroup, double alpha)
 			V2 p1 = hitbox->rotatedCollisionPoints[pIndex] + hitboxOffset;
 			V2 p2 = hitbox->rotatedCollisionPoints[(pIndex + 1) % hitbox->collisionPointsCount] + hitboxOffset;
 
-			pushDashedLine(renderGroup, color, p1, p2, 0.02, 0.05, 0.05, true);
+			pushDashedLine(renderGroup, frame, color, p1, p2, 0.02, 0.05, 0.05, true);
 			// pushSortEnd(renderGroup);
 
 			// drawRenderGroup(renderGroup, NULL);
@@ -4264,10 +5653,13 @@ void moveEntityBasedOnMovementField(Entity* entity, GameState* gameState, double
 		} 
 
 		if (dt > 0) {
-			if(entity->type == EntityType_motherShipProjectile) {
-				move(entity, dt, gameState, ddP, entity->rotation - dt * 2.0);
+			double rotation = entity->rotation;
+			if(entity->type == EntityType_motherShipProjectile) rotation -= dt * 2.0;
+
+			if(isProjectile(entity) && !movementField) {
+				moveProjectile(entity, gameState, dt, rotation);
 			} else {
-				move(entity, dt, gameState, ddP);
+				move(entity, dt, gameState, ddP, rotation);
 			}
 		}
 	}
@@ -4303,6 +5695,360 @@ s32 isSpawnPossible(ConsoleField* field, Entity* entity, GameState* gameState, b
 	return maxSpawned - numSpawned;
 }
 
+//NOTE: This returns NULL if the tile has to be drawn on its own
+StaticTileChunk* getStaticTileChunk(Entity* entity, GameState* gameState) {
+	StaticTileChunk* result = NULL;
+	StaticTileLayer* layer = &gameState->staticTiles;
+
+	bool canBeStatic = entity->type == EntityType_tile && entity->glowingTex && 
+					   !isSet(entity, EntityFlag_cloaked|EntityFlag_togglingCloak) &&
+					   entity->alpha == 1 && entity->cloakFactor == 0 && entity->rotation == 0 &&
+					   entity->dP == v2(0, 0) && getMovementField(entity) == NULL;
+
+	if(canBeStatic) {
+		s32 chunkX = (s32)floor(entity->p.x / layer->chunkSize.x);
+		s32 chunkY = (s32)floor(entity->p.y / layer->chunkSize.y);
+		s32 chunkIndex = chunkX + chunkY * layer->chunksWidth;
+
+		if(chunkX >= 0 && chunkY >= 0 && chunkX < layer->chunksWidth && chunkY < layer->chunksHeight &&
+		   chunkIndex < MAX_STATIC_MESHES) {
+			result = layer->chunks + chunkIndex;
+		}
+	}
+
+	return result;
+}
+
+void removeStaticTile(Entity* entity) {
+	StaticTileChunk* chunk = entity->staticTileChunk;
+
+	if(chunk) {
+		assert(chunk->numTiles > 0);
+		chunk->numTiles--;
+		chunk->dirty = true;
+		entity->staticTileChunk = NULL;
+	}
+}
+
+//NOTE: This returns true if the tile is drawn by the static tile layer
+bool32 updateStaticTile(Entity* entity, GameState* gameState) {
+	StaticTileLayer* layer = &gameState->staticTiles;
+	StaticTileChunk* chunk = getStaticTileChunk(entity, gameState);
+	double phase = angleIn0Tau(fmod(entity->animTime - layer->glowTime, TAU));
+
+	if(entity->staticTileChunk) {
+		double phaseDifference = fabs(phase - entity->staticTilePhase);
+		phaseDifference = min(phaseDifference, TAU - phaseDifference);
+
+		if(chunk != entity->staticTileChunk || entity->p != entity->staticTileP || phaseDifference > 0.001) {
+			removeStaticTile(entity);
+		}
+	}
+	else if(chunk && chunk->numTiles < MAX_STATIC_TILES_PER_CHUNK) {
+		entity->staticTileChunk = chunk;
+		entity->staticTileP = entity->p;
+		entity->staticTilePhase = phase;
+
+		chunk->numTiles++;
+		chunk->dirty = true;
+	}
+
+	bool32 result = entity->staticTileChunk != NULL;
+	return result;
+}
+
+struct StaticTileQuad {
+	Entity* tile;
+	Texture* texture;
+	double minY;
+	float emissivity;
+	s32 order;
+};
+
+//NOTE: This matches the order that the tiles would be drawn in if they were pushed on their own
+int compareStaticTileQuads(const void* a, const void* b) {
+	StaticTileQuad* quadA = (StaticTileQuad*)a;
+	StaticTileQuad* quadB = (StaticTileQuad*)b;
+
+	int result = quadA->order - quadB->order;
+
+	if(quadA->minY != quadB->minY) {
+		result = quadA->minY < quadB->minY ? -1 : 1;
+	}
+	else if(quadA->texture->texId != quadB->texture->texId) {
+		result = quadA->texture->texId < quadB->texture->texId ? -1 : 1;
+	}
+
+	return result;
+}
+
+void rebuildStaticTileChunk(GameState* gameState, s32 chunkIndex) {
+	StaticTileChunk* chunk = gameState->staticTiles.chunks + chunkIndex;
+	RenderGroup* group = gameState->renderGroup;
+
+	StaticTileQuad quads[MAX_STATIC_MESH_QUADS];
+	s32 numQuads = 0;
+
+	chunk->bounds = r2(v2(0, 0), v2(0, 0));
+
+	for(s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+
+		if(entity->staticTileChunk == chunk) {
+			assert(numQuads + 2 <= arrayCount(quads));
+			R2 bounds = rectCenterDiameter(entity->staticTileP, entity->renderSize);
+
+			if(numQuads) chunk->bounds = r2(minComponents(chunk->bounds.min, bounds.min), maxComponents(chunk->bounds.max, bounds.max));
+			else chunk->bounds = bounds;
+
+			StaticTileQuad* regular = quads + numQuads;
+			regular->tile = entity;
+			regular->texture = entity->glowingTex->regular;
+			regular->minY = bounds.min.y;
+			regular->emissivity = 0;
+			regular->order = numQuads++;
+
+			StaticTileQuad* glowing = quads + numQuads;
+			*glowing = *regular;
+			glowing->texture = entity->glowingTex->glowing;
+			glowing->emissivity = (float)(-1 - entity->staticTilePhase);
+			glowing->order = numQuads++;
+		}
+	}
+
+	qsort(quads, numQuads, sizeof(StaticTileQuad), compareStaticTileQuads);
+
+	beginStaticMesh(group, chunkIndex);
+
+	for(s32 quadIndex = 0; quadIndex < numQuads; quadIndex++) {
+		StaticTileQuad* quad = quads + quadIndex;
+		Entity* tile = quad->tile;
+
+		R2 bounds = rectCenterDiameter(tile->staticTileP, tile->renderSize);
+		bool flipX = isSet(tile, EntityFlag_facesLeft) != 0;
+		bool flipY = isSet(tile, EntityFlag_flipY) != 0;
+
+		addStaticMeshTexture(group, quad->texture, bounds, flipX, flipY, quad->emissivity, WHITE);
+	}
+
+	endStaticMesh(group);
+}
+
+void updateAndRenderStaticTiles(GameState* gameState) {
+	StaticTileLayer* layer = &gameState->staticTiles;
+	s32 numChunks = min(layer->chunksWidth * layer->chunksHeight, MAX_STATIC_MESHES);
+
+	for(s32 chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+		StaticTileChunk* chunk = layer->chunks + chunkIndex;
+
+		if(chunk->dirty) {
+			rebuildStaticTileChunk(gameState, chunkIndex);
+			chunk->dirty = false;
+		}
+
+		if(chunk->numTiles) {
+			pushStaticMesh(gameState->renderGroup, chunkIndex, DrawOrder_tile, chunk->bounds);
+		}
+	}
+
+	gameState->renderGroup->glowTime = (GLfloat)layer->glowTime;
+}
+
+void pushEntityRenderElements(Entity* entity, EntityRenderState* state, GameState* gameState, RenderFrame* frame) {
+	bool fadeAlphaFromDisappearing = state->fadeAlphaFromDisappearing != 0;
+	bool shootingState = state->shooting != 0;
+	bool32 drawnByStaticTiles = state->drawnByStaticTiles;
+	RenderGroup* group = gameState->renderGroup;
+
+	//NOTE: The entity isn't changed here since the entities can be pushed by the workers
+	V2 p = getRenderP(entity->prevP, entity->p, gameState);
+	double rotation = entity->rotation;
+	float emissivity = entity->emissivity;
+
+	#if DRAW_ENTITIES
+
+	if(entity->type == EntityType_shrike) {
+		Texture* tex = getAnimationFrame(&gameState->shrikeStand, entity->animTime);
+		pushEntityTexture(group, frame, tex, entity, p, rotation, emissivity, entity->drawOrder, fadeAlphaFromDisappearing);
+	}
+
+	if (state->texture != NULL) {
+		assert(state->texture->texId);
+		pushEntityTexture(group, frame, state->texture, entity, p, rotation, emissivity, entity->drawOrder, fadeAlphaFromDisappearing);
+	}
+
+	if(entity->glowingTex && !drawnByStaticTiles) {
+		DrawOrder drawOrder = entity->drawOrder;
+		float glowEmissivity = (float)((sin(entity->animTime) + 1.0) * 0.5);
+
+		pushEntityTexture(group, frame, entity->glowingTex->regular, entity, p, rotation, 0, drawOrder, fadeAlphaFromDisappearing);
+		pushEntityTexture(group, frame, entity->glowingTex->glowing, entity, p, rotation, glowEmissivity, drawOrder,   fadeAlphaFromDisappearing);
+	}
+
+	if(entity->type == EntityType_motherShip) {
+		MotherShipImages* images = &gameState->motherShipImages;
+
+		pushEntityTexture(group, frame, images->emitter, entity, p, rotation, emissivity, DrawOrder_motherShip_0, fadeAlphaFromDisappearing);
+		pushEntityTexture(group, frame, images->base, entity, p, rotation, emissivity, DrawOrder_motherShip_1, fadeAlphaFromDisappearing);
+
+		if(shootingState) {
+			Animation* shootAnim = &images->spawning;
+			double duration = getAnimationDuration(shootAnim);
+			double animTime = duration * state->shootTimer;
+
+			Texture* shootTex = getAnimationFrame(shootAnim, animTime);
+			pushEntityTexture(group, frame, shootTex, entity, p, rotation, emissivity, DrawOrder_motherShip_5, fadeAlphaFromDisappearing);
+		}
+
+		pushEntityTexture(group, frame, images->rotators[0], entity, p, 0.5 * entity->animTime, emissivity,   DrawOrder_motherShip_2, fadeAlphaFromDisappearing);
+		pushEntityTexture(group, frame, images->rotators[1], entity, p, -1 * entity->animTime, emissivity,   DrawOrder_motherShip_3, fadeAlphaFromDisappearing);
+		pushEntityTexture(group, frame, images->rotators[2], entity, p, 1.5 * entity->animTime, emissivity,   DrawOrder_motherShip_4, fadeAlphaFromDisappearing);
+	}
+	else if(entity->type == EntityType_trawler) {
+		TrawlerImages* images = &gameState->trawlerImages;
+
+		pushEntityTexture(group, frame, images->frame, entity, p, rotation, emissivity, DrawOrder_trawler_0, fadeAlphaFromDisappearing);
+		pushEntityTexture(group, frame, images->body, entity, p, rotation, emissivity, DrawOrder_trawler_2, fadeAlphaFromDisappearing);
+
+		if(shootingState) {
+			Animation* shootAnim = &images->shoot;
+			double duration = getAnimationDuration(shootAnim);
+			double animTime = duration * state->shootTimer;
+
+			Texture* shootTex = getAnimationFrame(shootAnim, animTime);
+			pushEntityTexture(group, frame, shootTex, entity, p, rotation, emissivity, DrawOrder_trawler_3, fadeAlphaFromDisappearing);
+		}
+
+		pushEntityTexture(group, frame, images->wheel, entity, p, entity->wheelRotation, emissivity,   DrawOrder_trawler_1, fadeAlphaFromDisappearing);
+	}
+
+	#endif
+
+	double collisionBoundsAlpha = gameState->collisionBoundsAlpha;
+	if((isTileType(entity) && getMovementField(entity) == NULL && gameState->fieldSpec.hackAbilities.moveTiles) 
+		|| entity->type == EntityType_player || 
+		entity->ref != gameState->consoleEntityRef) collisionBoundsAlpha = 0;
+
+	#if SHOW_COLLISION_BOUNDS
+		shouldDrawCollisionBounds = true;
+		collisionBoundsAlpha = 1;
+	#endif
+
+	if(collisionBoundsAlpha > 0) {
+		drawCollisionBounds(entity, p, group, frame, collisionBoundsAlpha);
+	}
+
+	#if SHOW_CLICK_BOUNDS
+		if(isSet(entity, EntityFlag_hackable)) {
+			R2 clickBox = translateRect(entity->clickBox, p);
+			pushOutlinedRect(group, frame, clickBox, 0.02f, createColor(127, 255, 255, 255), true);
+		}
+	#endif
+}
+
+//NOTE: The entities are pushed into frame, which is the group's frame on the game thread and the worker's own frame
+//		on a worker thread
+void pushEntityRange(GameState* gameState, RenderFrame* frame, s32 firstEntity, s32 endEntity) {
+	CullStats* cullStats = &frame->cullStats;
+
+	for(s32 entityIndex = firstEntity; entityIndex < endEntity; entityIndex++) {
+		Entity* entity = gameState->entities + entityIndex;
+		EntityRenderState* state = gameState->entityRenderPass.states + entityIndex;
+
+		if(state->visible) {
+			cullStats->entitiesVisible++;
+			pushEntityRenderElements(entity, state, gameState, frame);
+		} else {
+			cullStats->entitiesCulled++;
+		}
+	}
+}
+
+int entityRenderWorkerThread(void* data) {
+	EntityRenderWorker* worker = (EntityRenderWorker*)data;
+	GameState* gameState = worker->gameState;
+
+	while(true) {
+		SDL_SemWait(worker->start);
+		if(gameState->entityRenderPass.quit) break;
+
+		pushEntityRange(gameState, &worker->frame, worker->firstEntity, worker->endEntity);
+		SDL_SemPost(gameState->entityRenderPass.workDone);
+	}
+
+	return 0;
+}
+
+void initEntityRenderPass(GameState* gameState) {
+	EntityRenderPass* pass = &gameState->entityRenderPass;
+
+	#if PUSH_ENTITIES_ON_WORKERS
+	//NOTE: The game thread pushes one of the ranges itself
+	pass->numWorkers = min(SDL_GetCPUCount() - 1, MAX_ENTITY_RENDER_WORKERS);
+	#endif
+
+	if(pass->numWorkers > 0) {
+		pass->workDone = SDL_CreateSemaphore(0);
+		assert(pass->workDone);
+
+		for(s32 workerIndex = 0; workerIndex < pass->numWorkers; workerIndex++) {
+			EntityRenderWorker* worker = pass->workers + workerIndex;
+			worker->gameState = gameState;
+			worker->start = SDL_CreateSemaphore(0);
+			assert(worker->start);
+
+			worker->thread = SDL_CreateThread(entityRenderWorkerThread, "EntityRender", worker);
+			assert(worker->thread);
+		}
+	}
+}
+
+void shutdownEntityRenderPass(GameState* gameState) {
+	EntityRenderPass* pass = &gameState->entityRenderPass;
+	pass->quit = true;
+
+	for(s32 workerIndex = 0; workerIndex < pass->numWorkers; workerIndex++) {
+		SDL_SemPost(pass->workers[workerIndex].start);
+	}
+
+	for(s32 workerIndex = 0; workerIndex < pass->numWorkers; workerIndex++) {
+		EntityRenderWorker* worker = pass->workers + workerIndex;
+		SDL_WaitThread(worker->thread, NULL);
+		SDL_DestroySemaphore(worker->start);
+		worker->thread = NULL;
+	}
+
+	if(pass->numWorkers > 0) SDL_DestroySemaphore(pass->workDone);
+	pass->numWorkers = 0;
+}
+
+void pushEntities(GameState* gameState) {
+	EntityRenderPass* pass = &gameState->entityRenderPass;
+	s32 numEntities = gameState->numEntities;
+
+	s32 numRanges = min(pass->numWorkers + 1, numEntities / MIN_ENTITIES_PER_RENDER_WORKER);
+	if(numRanges < 1) numRanges = 1;
+
+	for(s32 rangeIndex = 1; rangeIndex < numRanges; rangeIndex++) {
+		EntityRenderWorker* worker = pass->workers + rangeIndex - 1;
+		worker->firstEntity = (s32)((s64)numEntities * rangeIndex / numRanges);
+		worker->endEntity = (s32)((s64)numEntities * (rangeIndex + 1) / numRanges);
+		SDL_SemPost(worker->start);
+	}
+
+	pushEntityRange(gameState, gameState->renderGroup->frame, 0, (s32)((s64)numEntities / numRanges));
+
+	for(s32 rangeIndex = 1; rangeIndex < numRanges; rangeIndex++) {
+		SDL_SemWait(pass->workDone);
+	}
+
+	RenderGroup* group = gameState->renderGroup;
+
+	for(s32 rangeIndex = 1; rangeIndex < numRanges; rangeIndex++) {
+		mergeRenderFrame(group->frame, &pass->workers[rangeIndex - 1].frame);
+	}
+}
+
 void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 	bool hacking = getEntityByRef(gameState, gameState->consoleEntityRef) != NULL;
 
@@ -4325,6 +6071,24 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 	double dtForPlayer = hacking ? 0 : dtForFrame;
 	double dtForEntities = dtForPlayer * getDoubleValue(gameState->timeField);
 
+	if(dtForFrame > 0) {
+		for (s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
+			Entity* entity = gameState->entities + entityIndex;
+			entity->prevP = entity->p;
+		}
+	}
+
+	//NOTE: This advances at the same rate as the anim time of the tiles, so their glow phase stays the same
+	gameState->staticTiles.glowTime = angleIn0Tau(fmod(gameState->staticTiles.glowTime + dtForEntities, TAU));
+
+	//NOTE: A change in gravity could make any of the sleeping entities start moving again
+	if(gameState->gravity != gameState->sleepGravity) {
+		wakeAllEntities(gameState);
+		gameState->sleepGravity = gameState->gravity;
+	}
+
+	sortPooledProjectiles(gameState);
+
 	if(!gameState->doingInitialSim) {
 		//TODO: It might be possible to combine the three loops which handle ground reference lists later
 		//TODO: An entities ground reference list could be reset right after it is done being updated and rendered
@@ -4333,7 +6097,10 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 			Entity* entity = gameState->entities + entityIndex;
 
 			entity->timeSinceLastOnGround += dtForEntities;
-			clearFlags(entity, EntityFlag_grounded|EntityFlag_movedByGround);
+
+			//NOTE: Sleeping entities don't redo their ground queries, so they stay grounded
+			if(isSet(entity, EntityFlag_asleep)) clearFlags(entity, EntityFlag_movedByGround);
+			else clearFlags(entity, EntityFlag_grounded|EntityFlag_movedByGround);
 
 			//NOTE: A ground reference between the base and the beam always persists.
 			if(entity->type == EntityType_laserBase) {
@@ -4351,10 +6118,19 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 			}
 		}
 
+		updateBroadPhase(gameState);
+
 		//NOTE: This loops though all the entities to set if they are on the ground at the beginning of the frame
 		//		and to setup their groundReferenceList's
 		for (s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
 			Entity* entity = gameState->entities + entityIndex;
+			if(isSet(entity, EntityFlag_asleep)) continue;
+
+			//NOTE: Collisions with projectiles are never solid, so they can't be the ground or be on the ground
+			if(isProjectile(entity)) {
+				entity->groundNormal = v2(0, 0);
+				continue;
+			}
 
 			Entity* above = getAbove(entity, gameState);
 
@@ -4371,6 +6147,11 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 				entity->groundNormal = v2(0, 0);
 			}
 		}
+
+		updateSleepingIslands(gameState, dtForEntities);
+
+		//NOTE: Entities start moving after this, so the broad phase pairs are out of date
+		invalidateBroadPhasePairs(gameState);
 	} else {
 		for (s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
 			Entity* entity = gameState->entities + entityIndex;
@@ -4383,6 +6164,11 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 	double groundFrictionForPlayer = pow(E, frictionGroundCoefficient * dtForEntities);
 	double groundFrictionForEntities = pow(E, frictionGroundCoefficient * dtForPlayer);
 
+	markVisibleEntities(gameState);
+
+	//NOTE: Entities which are added during the loop haven't been checked for visibility, so they are always drawn
+	s32 numMarkedEntities = gameState->numEntities;
+
 	//NOTE: This loops through all of the entities in the game state to update and render them
 	for (s32 entityIndex = 0; entityIndex < gameState->numEntities; entityIndex++) {
 		Entity* entity = gameState->entities + entityIndex;
@@ -4400,6 +6186,12 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 
 		removeFieldsIfSet(entity->fields, &entity->numFields);
 
+		if(isSet(entity, EntityFlag_asleep) && !canEntitySleep(entity, gameState)) {
+			wakeEntity(entity, gameState);
+		}
+
+		bool32 asleep = isSet(entity, EntityFlag_asleep);
+
 		ConsoleField* spotLightField = NULL;
 		ConsoleField* scanField = NULL;
 		ConsoleField* shootField = NULL;
@@ -4445,23 +6237,26 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 						ConsoleField* radiusField = field->children[0];
 						double radius = getDoubleValue(radiusField);
 
-					#if ENABLE_LIGHTING
-						PointLight light = createPointLight(v3(entity->p, 0), field->lightColor * (1 - entity->cloakFactor), radius);
-						pushPointLight(gameState->renderGroup, &light, true);
-					#else
-						Texture* circle = gameState->lightCircle;
-						R2 lightBounds = rectCenterRadius(entity->p, v2(1, 1) * radius);
-
-						V3 lightColor = field->lightColor;
-						u8 r = (u8)(255 * lightColor.x);
-						u8 g = (u8)(255 * lightColor.y);
-						u8 b = (u8)(255 * lightColor.z);
-						u8 a = (u8)(25 * (1 - entity->cloakFactor));
-
-						Color color = createColor(r, g, b, a);
-						pushTexture(gameState->renderGroup, circle, lightBounds, false, false, DrawOrder_light, true, 
-									Orientation_0, color, 1);
-					#endif
+						//NOTE: The entity's position is only changed below, so this is where it is drawn
+						V2 lightP = getRenderP(entity->prevP, entity->p, gameState);
+
+						if(gameState->renderGroup->lightingEnabled) {
+							PointLight light = createPointLight(v3(lightP, 0), field->lightColor * (1 - entity->cloakFactor), radius);
+							pushPointLight(gameState->renderGroup, &light, true);
+						} else {
+							Texture* circle = gameState->lightCircle;
+							R2 lightBounds = rectCenterRadius(lightP, v2(1, 1) * radius);
+
+							V3 lightColor = field->lightColor;
+							u8 r = (u8)(255 * lightColor.x);
+							u8 g = (u8)(255 * lightColor.y);
+							u8 b = (u8)(255 * lightColor.z);
+							u8 a = (u8)(25 * (1 - entity->cloakFactor));
+
+							Color color = createColor(r, g, b, a);
+							pushTexture(gameState->renderGroup, circle, lightBounds, false, false, DrawOrder_light, true, 
+										Orientation_0, color, 1);
+						}
 					}
 				} break;
                     
@@ -4649,12 +6444,18 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 			}
 		}
 
-		moveEntityBasedOnMovementField(entity, gameState, dt, groundFriction, doingOtherAction, canMoveSpotLight);
+		//NOTE: Sleeping entities can't have a movement field and aren't moving, so they can't leave the level
+		if(!asleep) {
+			moveEntityBasedOnMovementField(entity, gameState, dt, groundFriction, doingOtherAction, canMoveSpotLight);
+		}
 
 		bool insideLevel = false;
 
 		//NOTE: This removes the entity if they are outside of the world
-		if (isSet(entity, EntityFlag_removeWhenOutsideLevel) && !getField(entity, ConsoleField_bobsVertically)) {
+		if (asleep) {
+			insideLevel = true;
+		} 
+		else if (isSet(entity, EntityFlag_removeWhenOutsideLevel) && !getField(entity, ConsoleField_bobsVertically)) {
 			R2 world = r2(v2(0, 0), gameState->worldSize);
 
 			Hitbox* hitboxList = entity->hitboxes;
@@ -5201,104 +7002,29 @@ void updateAndRenderEntities(GameState* gameState, double dtForFrame) {
 			}
 		}
 
-		#if DRAW_ENTITIES
-
-		if(entity->type == EntityType_shrike) {
-			Texture* tex = getAnimationFrame(&gameState->shrikeStand, entity->animTime);
-			pushEntityTexture(gameState->renderGroup, tex, entity, entity->drawOrder, fadeAlphaFromDisappearing);
-		}
-
-		if (texture != NULL) {
-			assert(texture->texId);
-			pushEntityTexture(gameState->renderGroup, texture, entity, entity->drawOrder, fadeAlphaFromDisappearing);
-		}
-
-		if(entity->glowingTex) {
-			DrawOrder drawOrder = entity->drawOrder;
-
-
-			float emissivity = entity->emissivity;
-
-			entity->emissivity = 0;
-			pushEntityTexture(gameState->renderGroup, entity->glowingTex->regular, entity, drawOrder, fadeAlphaFromDisappearing);
-			entity->emissivity = (float)((sin(entity->animTime) + 1.0) * 0.5);
-			pushEntityTexture(gameState->renderGroup, entity->glowingTex->glowing, entity, drawOrder, fadeAlphaFromDisappearing);
-
-			entity->emissivity = emissivity;
-		}
-
-		if(entity->type == EntityType_motherShip) {
-			double rotation = entity->rotation;
-
-			MotherShipImages* images = &gameState->motherShipImages;
-
-			pushEntityTexture(gameState->renderGroup, images->emitter, entity, DrawOrder_motherShip_0, fadeAlphaFromDisappearing);
-			pushEntityTexture(gameState->renderGroup, images->base, entity, DrawOrder_motherShip_1, fadeAlphaFromDisappearing);
-
-			if(shootingState) {
-				Animation* shootAnim = &images->spawning;
-				double duration = getAnimationDuration(shootAnim);
-				double animTime = duration * shootField->shootTimer;
-
-				Texture* shootTex = getAnimationFrame(shootAnim, animTime);
-				pushEntityTexture(gameState->renderGroup, shootTex, entity, DrawOrder_motherShip_5, fadeAlphaFromDisappearing);
-			}
-
-			entity->rotation = 0.5 * entity->animTime;
-			pushEntityTexture(gameState->renderGroup, images->rotators[0], entity, DrawOrder_motherShip_2, fadeAlphaFromDisappearing);
-
-			entity->rotation = -1 * entity->animTime;
-			pushEntityTexture(gameState->renderGroup, images->rotators[1], entity, DrawOrder_motherShip_3, fadeAlphaFromDisappearing);
-
-			entity->rotation = 1.5 * entity->animTime;
-			pushEntityTexture(gameState->renderGroup, images->rotators[2], entity, DrawOrder_motherShip_4, fadeAlphaFromDisappearing);
-
-			entity->rotation = rotation;
-		}
-		else if(entity->type == EntityType_trawler) {
-			double rotation = entity->rotation;
-
-			TrawlerImages* images = &gameState->trawlerImages;
-
-			pushEntityTexture(gameState->renderGroup, images->frame, entity, DrawOrder_trawler_0, fadeAlphaFromDisappearing);
-			pushEntityTexture(gameState->renderGroup, images->body, entity, DrawOrder_trawler_2, fadeAlphaFromDisappearing);
-
-			if(shootingState) {
-				Animation* shootAnim = &images->shoot;
-				double duration = getAnimationDuration(shootAnim);
-				double animTime = duration * shootField->shootTimer;
-
-				Texture* shootTex = getAnimationFrame(shootAnim, animTime);
-				pushEntityTexture(gameState->renderGroup, shootTex, entity, DrawOrder_trawler_3, fadeAlphaFromDisappearing);
-			}
-
-			entity->rotation = entity->wheelRotation;
-			pushEntityTexture(gameState->renderGroup, images->wheel, entity, DrawOrder_trawler_1, fadeAlphaFromDisappearing);
-
-			entity->rotation = rotation;
-		}
+		EntityRenderState* renderState = gameState->entityRenderPass.states + entityIndex;
+		renderState->texture = texture;
+		renderState->visible = entityIndex >= numMarkedEntities || isSet(entity, EntityFlag_visible);
+		renderState->fadeAlphaFromDisappearing = fadeAlphaFromDisappearing;
+		renderState->shooting = shootingState;
+		renderState->shootTimer = shootingState && shootField ? shootField->shootTimer : 0;
+		renderState->drawnByStaticTiles = false;
 
+		#if DRAW_ENTITIES
+		//NOTE: This runs for culled tiles too, so that a tile which moves while off screen still leaves its chunk
+		renderState->drawnByStaticTiles = !gameState->doingInitialSim && updateStaticTile(entity, gameState);
 		#endif
+	}
 
-		double collisionBoundsAlpha = gameState->collisionBoundsAlpha;
-		if((isTileType(entity) && getMovementField(entity) == NULL && gameState->fieldSpec.hackAbilities.moveTiles) 
-			|| entity->type == EntityType_player || 
-			entity->ref != gameState->consoleEntityRef) collisionBoundsAlpha = 0;
+	//NOTE: Nothing is pushed during the simulation steps which aren't drawn
+	if(gameState->renderGroup->enabled) pushEntities(gameState);
 
-		#if SHOW_COLLISION_BOUNDS
-			shouldDrawCollisionBounds = true;
-			collisionBoundsAlpha = 1;
-		#endif
-		
-		if(collisionBoundsAlpha > 0) {
-			drawCollisionBounds(entity, gameState->renderGroup, collisionBoundsAlpha);
-		}
+	updateAndRenderPooledProjectiles(gameState, dtForEntities);
 
-		#if SHOW_CLICK_BOUNDS
-			if(isSet(entity, EntityFlag_hackable)) {
-				R2 clickBox = translateRect(entity->clickBox, entity->p);
-				pushOutlinedRect(gameState->renderGroup, clickBox, 0.02f, createColor(127, 255, 255, 255), true);
-			}
-		#endif
+	//NOTE: Entities can be removed or changed by anything after this, so the endpoints are re-sorted next frame
+	invalidateBroadPhase(gameState);
+
+	if(!gameState->doingInitialSim) {
+		updateAndRenderStaticTiles(gameState);
 	}
 }
@@ -6,6 +6,27 @@
 #define TRAWLER_BOLT_SIZE 0.6
 #define SHRIKE_BOLT_SIZE 0.4
 
+//NOTE: An island of entities is put to sleep once all of them have been moving slower than
+//		ENTITY_SLEEP_SPEED (in meters per second) for ENTITY_SLEEP_TIME seconds
+#define ENTITY_SLEEP_TIME 0.5
+#define ENTITY_SLEEP_SPEED 0.05
+
+//NOTE: The synthetic level which is simulated by -benchmark needs room for 5000 heavy tiles
+#define MAX_ENTITIES 6500
+
+//NOTE: Entities which are further than this (in meters) outside of the screen are not rendered
+#define RENDER_CULL_MARGIN 1.0
+
+//NOTE: The static tile layer is split into chunks of this many tiles on each side
+#define STATIC_TILE_CHUNK_SIZE 16
+#define MAX_STATIC_TILES_PER_CHUNK (MAX_STATIC_MESH_QUADS / 2)
+
+//NOTE: The broad phase pairs can only be used for queries which move less than this. Entities are also allowed to 
+//		move this far before their broad phase endpoints have to be moved.
+#define BROAD_PHASE_PADDING 0.1
+#define MAX_BROAD_PHASE_PAIRS 32768
+#define MAX_BROAD_PHASE_QUERY_COLLIDERS 256
+
 enum EntityFlag {
 	EntityFlag_facesLeft = 1 << 0,
 	EntityFlag_noMovementByDefault = 1 << 1,
@@ -27,6 +48,8 @@ enum EntityFlag {
 	EntityFlag_isCornerTile = 1 << 17,
 	EntityFlag_jumped = 1 << 18,
 	EntityFlag_checkPointReached = 1 << 19,
+	EntityFlag_asleep = 1 << 20,
+	EntityFlag_visible = 1 << 21, //Set at the start of every frame by markVisibleEntities
 };
 
 struct RefNode {
@@ -67,6 +90,9 @@ struct Entity {
 	V2 dP;
 	double rotation;
 
+	//NOTE: Where the entity was at the start of the last simulation step, it is drawn between prevP and p
+	V2 prevP;
+
 	//Used by trawler
 	double wheelRotation;
 
@@ -102,6 +128,12 @@ struct Entity {
 	s32 tileXOffset;
 	s32 tileYOffset;
 
+	//NOTE: Used by tiles which are drawn by the static tile layer, the chunk mesh is rebuilt if p or the 
+	//		glow phase change from when the tile was added to it
+	struct StaticTileChunk* staticTileChunk;
+	V2 staticTileP;
+	double staticTilePhase;
+
 	//Used by any entity that jumps
 	s32 jumpCount;
 	double timeSinceLastOnGround;
@@ -118,6 +150,14 @@ struct Entity {
 	CharacterAnim* characterAnim;
 
 	V2 groundNormal;
+
+	//Used by the sleep system
+	double sleepTime;
+	s32 sleepIslandRef;
+
+	//NOTE: Used by the support graph, tileMove is only this entity's node while tileMoveSolve is the current solve
+	struct TileMove* tileMove;
+	u32 tileMoveSolve;
 };
 
 struct EntityReference {
@@ -125,11 +165,17 @@ struct EntityReference {
 	EntityReference* next;
 };
 
+//NOTE: These make up the support graph which is used to move everything that is standing on a moving entity
 struct TileMoveNode;
 struct TileMove {
 	Entity* tile;
 	TileMoveNode* children;
-	int numParents;
+	int numParents; //-1 once the tile has been moved
+
+	bool32 hasMovement;
+	V2 movement;
+
+	TileMove* next;
 };
 
 struct TileMoveNode {
@@ -137,6 +183,141 @@ struct TileMoveNode {
 	TileMoveNode* next;
 };
 
+enum ProjectileKind {
+	ProjectileKind_trojanBolt,
+	ProjectileKind_trawlerBolt,
+	ProjectileKind_shrikeBolt,
+	ProjectileKind_motherShipProjectile,
+
+	ProjectileKind_count
+};
+
+//NOTE: A pooled projectile is loaded into a proxy whenever it has to go through the regular entity code
+//		(collisions, onCollide, death effects). Proxies are never added to the entity list or the spatial partition.
+struct ProjectileProxy {
+	Entity entity;
+	s32 index;
+	Hitbox* hitboxes[ProjectileKind_count];
+};
+
+#define MAX_POOLED_PROJECTILES 512
+
+//NOTE: Projectiles which haven't been hacked are stored here instead of in the entity list. Their state is kept
+//		in parallel arrays which are swap removed, so shooting and despawning don't allocate anything. All of the
+//		pooled projectiles are turned into regular entities when the player starts hacking.
+struct ProjectilePool {
+	s32 count;
+
+	ProjectileKind kind[MAX_POOLED_PROJECTILES];
+	s32 ref[MAX_POOLED_PROJECTILES];
+	s32 spawnerRef[MAX_POOLED_PROJECTILES];
+	V2 p[MAX_POOLED_PROJECTILES];
+	V2 prevP[MAX_POOLED_PROJECTILES];
+	V2 dP[MAX_POOLED_PROJECTILES];
+	double rotation[MAX_POOLED_PROJECTILES];
+	double animTime[MAX_POOLED_PROJECTILES];
+	bool32 removed[MAX_POOLED_PROJECTILES];
+
+	//NOTE: The projectiles sorted by spatial chunk, this is rebuilt once per frame
+	s32* chunkStarts;
+	s32 sortedIndices[MAX_POOLED_PROJECTILES];
+	s32 numSorted;
+
+	ConsoleField* killField;
+	ProjectileProxy moving;
+	ProjectileProxy fixed;
+};
+
+struct BroadPhaseEndpoint {
+	double x;
+	s32 ref;
+	s32 entityIndex;
+	bool32 isMax;
+};
+
+//NOTE: This is an incremental sweep and prune along the x axis. Every entity's bounds are padded, and its endpoints
+//		are only moved when it leaves its padded bounds, so most moves don't touch them. The endpoints stay sorted
+//		between frames, so re-sorting them is close to linear because most entities barely move. 
+//		The overlapping pairs are made at the start of the frame and used by the ground queries before anything
+//		moves. After that the movement queries binary search the sorted endpoints for their swept bounds.
+struct BroadPhase {
+	s32 numEndpoints;
+	BroadPhaseEndpoint endpoints[2 * MAX_ENTITIES];
+	s32 endpointIndices[MAX_ENTITIES][2]; //The index of the min and max endpoint of each entity, -1 if it has none
+	R2 bounds[MAX_ENTITIES];
+	double maxWidth; //The width of the widest bounds
+
+	//NOTE: The entities overlapping entity i are pairs[pairStarts[i]] to pairs[pairStarts[i + 1] - 1]
+	s32 pairStarts[MAX_ENTITIES + 1];
+	s32 pairs[2 * MAX_BROAD_PHASE_PAIRS];
+	s32 pairA[MAX_BROAD_PHASE_PAIRS];
+	s32 pairB[MAX_BROAD_PHASE_PAIRS];
+	s32 numPairs;
+	s32 numSwaps;
+	s32 numRefreshes;
+
+	bool32 pairsValid;
+	bool32 live; //NOTE: The endpoints match the entities, so they can be searched
+	bool32 disabled; //NOTE: Set by -nobroadphase, then every query searches the spatial partition
+	s32 numEntities; //The number of entities when the endpoints were sorted
+};
+
+struct StaticTileChunk {
+	s32 numTiles;
+	bool32 dirty;
+	R2 bounds; //The render bounds of all of the tiles in the chunk
+};
+
+//NOTE: Tiles which aren't moving or being hacked are drawn from a static mesh per chunk instead of being pushed
+//		every frame. The chunk index is the index of its static mesh in the render group.
+struct StaticTileLayer {
+	StaticTileChunk* chunks;
+	s32 chunksWidth, chunksHeight;
+	V2 chunkSize;
+
+	//NOTE: This is kept in [0, TAU), the glow of a tile is sin(glowTime + staticTilePhase)
+	double glowTime;
+};
+
+//NOTE: Something which moved further than this in one step was teleported (respawned, undone), so it isn't drawn
+//		between where it was and where it is
+#define MAX_INTERPOLATION_DISTANCE 2.0
+
+#define MAX_ENTITY_RENDER_WORKERS 8
+//NOTE: The workers are only used once each of them gets at least this many entities to push
+#define MIN_ENTITIES_PER_RENDER_WORKER 256
+
+//NOTE: This is what the render pass needs from the update of an entity
+struct EntityRenderState {
+	Texture* texture;
+	bool32 visible;
+	bool32 drawnByStaticTiles;
+	bool32 fadeAlphaFromDisappearing;
+	bool32 shooting;
+	double shootTimer;
+};
+
+struct EntityRenderWorker {
+	struct GameState* gameState;
+	RenderFrame frame;
+	s32 firstEntity, endEntity;
+	SDL_sem* start;
+	SDL_Thread* thread;
+};
+
+//NOTE: The entities are pushed once all of them have been updated. The entity list is split into ranges, the game
+//		thread pushes the first one into the group's frame and each worker pushes another one into its own frame.
+//		The worker frames are merged into the group's frame in order, so the elements end up in the same order as
+//		if one thread had pushed all of them.
+struct EntityRenderPass {
+	s32 numWorkers;
+	EntityRenderWorker workers[MAX_ENTITY_RENDER_WORKERS];
+	SDL_sem* workDone;
+	bool32 quit; //Set before the workers' start semaphores are posted to stop them
+
+	EntityRenderState states[MAX_ENTITIES];
+};
+
 struct ProjectPointResult {
 	double hitTime;
 	V2 hitLineNormal;
@@ -204,3 +385,5 @@ void removeTargetRef(int, GameState*);
 void addTargetRef(int, GameState*);
 void addField(Entity*, ConsoleField*);
 void ignoreAllPenetratingEntities(Entity*, GameState*);
+void promotePooledProjectiles(GameState*);
+void removeStaticTile(Entity*);
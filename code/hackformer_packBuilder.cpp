@@ -6,6 +6,30 @@ struct FieldSpec {};
 
 #include "hackformer_renderer.cpp"
 
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#ifdef HACKFORMER_MAC
+	#include "stb_image_write.h"
+#else
+	#include "../build/stb_image_write.h"
+#endif
+
+struct AtlasFrameSource {
+	AssetId id;
+	u32* pixels; //The whole sprite sheet
+	s32 pitch;
+	s32 sheetHeight;
+	bool32 continuous; //See SpriteSheetSpec
+	s32 frameX, frameY; //The top left of the frame in the sprite sheet
+	s32 frameWidth, frameHeight;
+	PackedFrame* packed;
+};
+
+struct ByteBuffer {
+	u8* data;
+	s32 size;
+	s32 capacity;
+};
+
 s32 getFileSize(char* fileName) {
 	FILE* file = fopen(fileName, "rb");
 	assert(file);
@@ -34,6 +58,272 @@ void writeFile(FILE* output, char* inputFileName) {
 	free(mem);
 }
 
+void writeBytes(ByteBuffer* buffer, void* data, s32 size) {
+	if(buffer->size + size > buffer->capacity) {
+		buffer->capacity = max(buffer->capacity * 2, buffer->size + size);
+		buffer->data = (u8*)realloc(buffer->data, buffer->capacity);
+		assert(buffer->data);
+	}
+
+	memcpy(buffer->data + buffer->size, data, size);
+	buffer->size += size;
+}
+
+void writePng(void* context, void* data, int size) {
+	writeBytes((ByteBuffer*)context, data, size);
+}
+
+bool isPngFile(char* fileName) {
+	size_t length = strlen(fileName);
+	bool result = length > 4 && strcmp(fileName + length - 4, ".png") == 0;
+	return result;
+}
+
+//NOTE: This shrinks the frame down to the smallest rectangle which contains all of the pixels with a non zero alpha
+void trimFrame(AtlasFrameSource* source) {
+	s32 minX = source->frameWidth, minY = source->frameHeight;
+	s32 maxX = -1, maxY = -1;
+
+	for(s32 y = 0; y < source->frameHeight; y++) {
+		u32* row = source->pixels + (source->frameY + y) * source->pitch + source->frameX;
+
+		for(s32 x = 0; x < source->frameWidth; x++) {
+			u8 alpha = (u8)(row[x] >> 24);
+
+			if(alpha) {
+				minX = min(minX, x);
+				minY = min(minY, y);
+				maxX = max(maxX, x);
+				maxY = max(maxY, y);
+			}
+		}
+	}
+
+	PackedFrame* packed = source->packed;
+
+	//NOTE: Completely transparent frames still get a single pixel
+	if(maxX < 0) {
+		minX = minY = maxX = maxY = 0;
+	}
+
+	packed->trimX = minX;
+	packed->trimY = minY;
+	packed->width = maxX - minX + 1;
+	packed->height = maxY - minY + 1;
+}
+
+int compareFrameHeights(const void* a, const void* b) {
+	AtlasFrameSource* f1 = (AtlasFrameSource*)a;
+	AtlasFrameSource* f2 = (AtlasFrameSource*)b;
+
+	if(f1->packed->height != f2->packed->height) return f2->packed->height - f1->packed->height;
+	if(f1->id != f2->id) return f1->id - f2->id;
+	return (s32)(f1->packed - f2->packed);
+}
+
+//NOTE: This uses shelf packing, the frames are placed in rows from the tallest to the shortest
+s32 packFrames(AtlasFrameSource* sources, s32 numSources) {
+	qsort(sources, numSources, sizeof(AtlasFrameSource), compareFrameHeights);
+
+	s32 page = 0;
+	s32 x = 0, y = 0;
+	s32 rowHeight = 0;
+
+	for(s32 sourceIndex = 0; sourceIndex < numSources; sourceIndex++) {
+		PackedFrame* packed = sources[sourceIndex].packed;
+
+		s32 width = packed->width + 2 * ATLAS_PADDING;
+		s32 height = packed->height + 2 * ATLAS_PADDING;
+
+		if(x + width > ATLAS_PAGE_SIZE) {
+			x = 0;
+			y += rowHeight;
+			rowHeight = 0;
+		}
+
+		if(y + height > ATLAS_PAGE_SIZE) {
+			page++;
+			x = y = 0;
+			rowHeight = 0;
+		}
+
+		assert(page < MAX_ATLAS_PAGES);
+
+		packed->page = page;
+		packed->x = x + ATLAS_PADDING;
+		packed->y = y + ATLAS_PADDING;
+
+		x += width;
+		rowHeight = max(rowHeight, height);
+	}
+
+	s32 result = numSources ? page + 1 : 0;
+	return result;
+}
+
+//NOTE: The padding around each frame is filled with the pixels next to it in the sheet, clamped to the edges of the 
+//		frame. So a frame which is a separate image repeats its edge pixels, like it did as a separate texture. If the 
+//		sheet is continuous, the padding is clamped to the edges of the sheet instead, so at the edge of a frame the 
+//		filtering samples the next frame's pixels, like it did when the sheet was one texture.
+void copyFrameToPage(AtlasFrameSource* source, u32* page) {
+	PackedFrame* packed = source->packed;
+
+	s32 minX = source->frameX, maxX = source->frameX + source->frameWidth - 1;
+	s32 minY = source->frameY, maxY = source->frameY + source->frameHeight - 1;
+
+	if(source->continuous) {
+		minX = minY = 0;
+		maxX = source->pitch - 1;
+		maxY = source->sheetHeight - 1;
+	}
+
+	for(s32 y = -ATLAS_PADDING; y < packed->height + ATLAS_PADDING; y++) {
+		s32 sheetY = max(minY, min(source->frameY + packed->trimY + y, maxY));
+		u32* srcRow = source->pixels + sheetY * source->pitch;
+		u32* dstRow = page + (packed->y + y) * ATLAS_PAGE_SIZE + packed->x;
+
+		for(s32 x = -ATLAS_PADDING; x < packed->width + ATLAS_PADDING; x++) {
+			s32 sheetX = max(minX, min(source->frameX + packed->trimX + x, maxX));
+			dstRow[x] = srcRow[sheetX];
+		}
+	}
+}
+
+bool shouldPackTexture(AssetId id) {
+	bool result = true;
+
+	for(s32 textureIndex = 0; textureIndex < arrayCount(globalUnpackedTextures); textureIndex++) {
+		if(globalUnpackedTextures[textureIndex] == id) {
+			result = false;
+			break;
+		}
+	}
+
+	return result;
+}
+
+SpriteSheetSpec getSpriteSheetSpec(AssetId id, s32 width, s32 height) {
+	SpriteSheetSpec result = {id, width, height};
+
+	for(s32 sheetIndex = 0; sheetIndex < arrayCount(globalSpriteSheets); sheetIndex++) {
+		if(globalSpriteSheets[sheetIndex].id == id) {
+			result = globalSpriteSheets[sheetIndex];
+			break;
+		}
+	}
+
+	return result;
+}
+
+//NOTE: This packs every png (except for stencils and very large images) into the atlas pages
+ByteBuffer buildTextureAtlas(char filePaths[][1000], s32 numFiles, bool* packed) {
+	PackedAsset assets[Asset_count] = {};
+
+	s32 maxFrames = 4096;
+	AtlasFrameSource* sources = (AtlasFrameSource*)malloc(maxFrames * sizeof(AtlasFrameSource));
+	PackedFrame* frames = (PackedFrame*)malloc(maxFrames * sizeof(PackedFrame));
+	assert(sources && frames);
+
+	u32* sheets[Asset_count] = {};
+	s32 numFrames = 0;
+
+	for(s32 fileIndex = 0; fileIndex < numFiles; fileIndex++) {
+		AssetId id = (AssetId)(fileIndex + 1);
+		char* filePath = filePaths[fileIndex];
+		packed[fileIndex] = false;
+
+		if(!isPngFile(filePath) || !shouldPackTexture(id)) continue;
+
+		int width, height, numComponents;
+		u32* pixels = (u32*)stbi_load(filePath, &width, &height, &numComponents, 4);
+		assert(pixels);
+
+		SpriteSheetSpec spec = getSpriteSheetSpec(id, width, height);
+
+		if(spec.frameWidth > MAX_ATLAS_FRAME_SIZE || spec.frameHeight > MAX_ATLAS_FRAME_SIZE) {
+			stbi_image_free(pixels);
+			continue;
+		}
+
+		//NOTE: This splits up the sheet the same way as extractTextures
+		s32 numCols = width / spec.frameWidth;
+		s32 numRows = height / spec.frameHeight;
+
+		PackedAsset* asset = assets + id;
+		asset->firstFrame = numFrames;
+		asset->numFrames = numCols * numRows;
+		asset->frameWidth = spec.frameWidth;
+		asset->frameHeight = spec.frameHeight;
+
+		for(s32 rowIndex = 0; rowIndex < numRows; rowIndex++) {
+			for(s32 colIndex = 0; colIndex < numCols; colIndex++) {
+				assert(numFrames < maxFrames);
+
+				AtlasFrameSource* source = sources + numFrames;
+				source->id = id;
+				source->pixels = pixels;
+				source->pitch = width;
+				source->sheetHeight = height;
+				source->continuous = spec.continuous;
+				source->frameX = colIndex * spec.frameWidth;
+				source->frameY = rowIndex * spec.frameHeight;
+				source->frameWidth = spec.frameWidth;
+				source->frameHeight = spec.frameHeight;
+				source->packed = frames + numFrames;
+
+				trimFrame(source);
+				numFrames++;
+			}
+		}
+
+		sheets[id] = pixels;
+		packed[fileIndex] = true;
+	}
+
+	s32 numPages = packFrames(sources, numFrames);
+
+	ByteBuffer result = {};
+
+	TextureAtlasHeader header = {numPages, numFrames};
+	writeBytes(&result, &header, sizeof(header));
+	writeBytes(&result, assets, sizeof(assets));
+	writeBytes(&result, frames, numFrames * sizeof(PackedFrame));
+
+	u32* page = (u32*)malloc(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * sizeof(u32));
+	assert(page);
+
+	for(s32 pageIndex = 0; pageIndex < numPages; pageIndex++) {
+		memset(page, 0, ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * sizeof(u32));
+
+		for(s32 sourceIndex = 0; sourceIndex < numFrames; sourceIndex++) {
+			AtlasFrameSource* source = sources + sourceIndex;
+			if(source->packed->page == pageIndex) copyFrameToPage(source, page);
+		}
+
+		ByteBuffer png = {};
+		s32 writeResult = stbi_write_png_to_func(writePng, &png, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 4, page, 
+												 ATLAS_PAGE_SIZE * sizeof(u32));
+		assert(writeResult);
+
+		writeBytes(&result, &png.size, sizeof(png.size));
+		writeBytes(&result, png.data, png.size);
+		free(png.data);
+
+		printf("Atlas page %d: %d bytes\n", pageIndex, png.size);
+	}
+
+	free(page);
+
+	for(s32 assetIndex = 0; assetIndex < Asset_count; assetIndex++) {
+		if(sheets[assetIndex]) stbi_image_free(sheets[assetIndex]);
+	}
+
+	free(sources);
+	free(frames);
+
+	return result;
+}
+
 int main(int argc, char** argv) {
 	char* fileNames[] = {
 		"shaders/stencil.frag",
@@ -41,6 +331,7 @@ int main(int argc, char** argv) {
 		"shaders/forward.frag",
 		"shaders/basic.vert",
 		"shaders/basic.frag",
+		"shaders/upscale.frag",
 
 		"fonts/PTS55f.ttf",
 		"fonts/Roboto-Regular.ttf",
@@ -174,32 +465,43 @@ int main(int argc, char** argv) {
 
 	s32 fileNameCount = arrayCount(fileNames);
 	s32 assetCount = Asset_count - 1;
-	assert(fileNameCount == assetCount);
+	assert(fileNameCount == Asset_textureAtlas - 1);
 
 	char* outputFileName = "assets.bin";
 
 	FILE* file = fopen(outputFileName, "wb");
 	assert(file);
 
-	char* filePaths[arrayCount(fileNames)][1000];
+	char filePaths[arrayCount(fileNames)][1000];
 
 	for(s32 i = 0; i < arrayCount(fileNames); i++) {
-		sprintf((char*)filePaths[i], "res/%s", fileNames[i]);
+		sprintf(filePaths[i], "res/%s", fileNames[i]);
 	}
 
+	//NOTE: The pngs which were put into the atlas aren't written out separately
+	bool packed[arrayCount(fileNames)];
+	ByteBuffer atlas = buildTextureAtlas(filePaths, fileNameCount, packed);
+
 	s32 offset = sizeof(s32) * assetCount;
 
 	for(s32 i = 0; i < assetCount; i++) {
 		size_t written = fwrite(&offset, sizeof(offset), 1, file);
 		assert(written == 1);
-		s32 fileSize = getFileSize((char*)filePaths[i]);
-		offset += fileSize;
+
+		if(i < fileNameCount) {
+			if(!packed[i]) offset += getFileSize(filePaths[i]);
+		} else {
+			offset += atlas.size;
+		}
 	}
 
-	for(s32 i = 0; i < assetCount; i++) {
-		writeFile(file, (char*)filePaths[i]);
+	for(s32 i = 0; i < fileNameCount; i++) {
+		if(!packed[i]) writeFile(file, filePaths[i]);
 	}
 
+	fwrite(atlas.data, atlas.size, 1, file);
+	free(atlas.data);
+
 	fclose(file);
 	return 0;
 } 
\ No newline at end of file
@@ -4,6 +4,7 @@ enum AssetId {
 	Asset_forwardFS,
 	Asset_basicVS,
 	Asset_basicFS,
+	Asset_upscaleFS,
 
 	Asset_consoleFont,
 	Asset_entityFont,
@@ -134,5 +135,92 @@ enum AssetId {
 	Asset_checkPointReached,
 	Asset_checkPointUnreached,
 
+	//NOTE: This is generated by the pack builder, it is not a file in res
+	Asset_textureAtlas,
+
 	Asset_count
 };
+
+#define ATLAS_PAGE_SIZE 2048
+#define MAX_ATLAS_PAGES 16
+#define MAX_ATLAS_FRAME_SIZE 1024
+#define ATLAS_PADDING 1
+
+struct SpriteSheetSpec {
+	AssetId id;
+	s32 frameWidth;
+	s32 frameHeight;
+	bool32 continuous; //The frames are parts of one image instead of separate images (like the frames of an animation)
+};
+
+//NOTE: The background layers are split into vertical strips, only the ones which are on screen are drawn and each one 
+//		is trimmed down to its visible pixels when it is packed. The strip widths have to divide the layer widths.
+//		The layers are continuous sheets, so the filtering at the edge of a strip samples the next strip's pixels 
+//		and there are no seams between the strips.
+#define BACKGROUND_STRIP_WIDTH 256
+#define MIDDLEGROUND_STRIP_WIDTH 255
+#define BACKGROUND_LAYER_HEIGHT 512
+
+//NOTE: The pack builder uses these to split the animations into frames. They have to match the frame sizes passed to 
+//		loadAnimation. Any png which isn't in this list is packed as a single frame.
+static SpriteSheetSpec globalSpriteSheets[] = {
+	{Asset_pauseMenuAnim, 1280, 720},
+	{Asset_mainMenuAnim, 1280, 720},
+	{Asset_playerRunning, 256, 256},
+	{Asset_playerStand, 256, 256},
+	{Asset_playerDeath, 256, 256},
+	{Asset_playerJumpingIntro, 256, 256},
+	{Asset_playerJumping, 256, 256},
+	{Asset_playerJumpingOutro, 256, 256},
+	{Asset_playerHacking, 256, 256},
+	{Asset_shrikeShoot, 256, 256},
+	{Asset_shrikeStand, 256, 256},
+	{Asset_shrikeBootUp, 256, 256},
+	{Asset_trojanShoot, 256, 256},
+	{Asset_trojanDisappear, 256, 256},
+	{Asset_trojanBoltDeath, 128, 128},
+	{Asset_energy, 173, 172},
+	{Asset_motherShipProjectileSmoking, 120, 120},
+	{Asset_motherShipShoot, 512, 512},
+	{Asset_motherShipProjectileDeath, 120, 120},
+	{Asset_trawlerShoot, 256, 256},
+	{Asset_trawlerBootUp, 256, 256},
+	{Asset_trawlerBoltDeath, 128, 128},
+	{Asset_cursorHacking, 64, 64},
+	{Asset_marineCityBg, BACKGROUND_STRIP_WIDTH, BACKGROUND_LAYER_HEIGHT, true},
+	{Asset_marineCityMg, MIDDLEGROUND_STRIP_WIDTH, BACKGROUND_LAYER_HEIGHT, true},
+	{Asset_sunsetCityBg, BACKGROUND_STRIP_WIDTH, BACKGROUND_LAYER_HEIGHT, true},
+	{Asset_sunsetCityMg, MIDDLEGROUND_STRIP_WIDTH, BACKGROUND_LAYER_HEIGHT, true},
+};
+
+//NOTE: Stencils aren't gamma corrected, so they can't be put into the srgb atlas pages
+static AssetId globalUnpackedTextures[] = {
+	Asset_energyBarStencil,
+};
+
+//NOTE: A frame is trimmed to the smallest rectangle which contains all of its visible pixels before it is packed.
+//		(x, y) is the position of the trimmed frame in the page and (trimX, trimY) is its offset in the original frame.
+struct PackedFrame {
+	s32 page;
+	s32 x, y;
+	s32 width, height;
+	s32 trimX, trimY;
+};
+
+//NOTE: numFrames is 0 if the asset isn't in the atlas
+struct PackedAsset {
+	s32 firstFrame;
+	s32 numFrames;
+	s32 frameWidth;
+	s32 frameHeight;
+};
+
+//NOTE: The texture atlas asset is laid out as
+//		TextureAtlasHeader
+//		PackedAsset[Asset_count]
+//		PackedFrame[numFrames]
+//		for each page: s32 png size, png data
+struct TextureAtlasHeader {
+	s32 numPages;
+	s32 numFrames;
+};
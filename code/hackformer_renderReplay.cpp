@@ -0,0 +1,143 @@
+struct FieldSpec {};
+
+#include "hackformer_types.h"
+#include "hackformer_renderer.h"
+
+#include "hackformer_renderer.cpp"
+
+//NOTE: This replays frames which were captured in the game with K. Each frame is drawn a number of times in a row 
+//		and the average time per draw is printed, so changes to the renderer can be compared on the same frames.
+//		With -software the GL context is created by Mesa's software rasterizer (on Windows, Mesa's opengl32.dll 
+//		has to be next to the executable). -null times the command generation on its own, and -cpu draws the frames
+//		with the renderer's CPU backend instead of GL.
+//
+//		hackformer_renderReplay [-software | -null | -cpu] [-iterations n] [-passes n] render_capture_1_0.hfr ...
+
+#define MAX_REPLAY_FRAMES 64
+
+int main(int argc, char* argv[]) {
+	bool software = false;
+	RenderBackend backend = RenderBackend_gl;
+	s32 iterations = 100;
+	s32 passes = 0; //0 replays the frames until the window is closed
+
+	s32 numFrames = 0;
+	char* fileNames[MAX_REPLAY_FRAMES];
+
+	for(s32 argIndex = 1; argIndex < argc; argIndex++) {
+		char* arg = argv[argIndex];
+
+		if(!strcmp(arg, "-software")) {
+			software = true;
+		} else if(!strcmp(arg, "-null")) {
+			backend = RenderBackend_null;
+		} else if(!strcmp(arg, "-cpu")) {
+			backend = RenderBackend_software;
+		} else if(!strcmp(arg, "-iterations") && argIndex + 1 < argc) {
+			iterations = max(1, atoi(argv[++argIndex]));
+		} else if(!strcmp(arg, "-passes") && argIndex + 1 < argc) {
+			passes = max(0, atoi(argv[++argIndex]));
+		} else if(numFrames < MAX_REPLAY_FRAMES) {
+			fileNames[numFrames++] = arg;
+		}
+	}
+
+	if(!numFrames) {
+		fprintf(stderr, "Usage: hackformer_renderReplay [-software | -null | -cpu] [-iterations n] [-passes n] captures...\n");
+		return 1;
+	}
+
+	MemoryArena arena;
+	initArena(&arena, MEGABYTES(256), true);
+
+	RenderCapture* frames = pushArray(&arena, RenderCapture, numFrames);
+
+	//NOTE: The window is the size of the first frame, the rest of the frames have to match it
+	if(!loadRenderCaptureHeader(frames, fileNames[0])) {
+		fprintf(stderr, "%s is not a render capture (or it is from a different version)\n", fileNames[0]);
+		return 1;
+	}
+
+	s32 windowWidth = frames[0].windowWidth;
+	s32 windowHeight = frames[0].windowHeight;
+	double pixelsPerMeter = frames[0].pixelsPerMeter;
+
+	if(software) SDL_setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+
+	SDL_Window* window = createWindow(windowWidth, windowHeight, backend);
+	bool gl = backend == RenderBackend_gl;
+	if(gl) SDL_GL_SetSwapInterval(0); //NOTE: Otherwise every draw would wait for vsync
+
+	Camera camera;
+	initCamera(&camera);
+
+	Texture* textures = pushArray(&arena, Texture, MAX_TEXTURES);
+	s32 texturesCount = 1;
+
+	Assets assets;
+	initAssets(&assets);
+
+	RenderGroup* renderGroup = createRenderGroup(8 * 1024 * 1024, &arena, pixelsPerMeter, windowWidth, windowHeight, 
+		&camera, textures, &texturesCount, &assets, backend);
+	renderGroup->enabled = true;
+
+	s32 firstStaticMesh = 0;
+
+	for(s32 frameIndex = 0; frameIndex < numFrames; frameIndex++) {
+		RenderCapture* frame = frames + frameIndex;
+		frame->arena = &arena;
+		frame->firstStaticMesh = firstStaticMesh;
+
+		if(!loadRenderCapture(renderGroup, frame, fileNames[frameIndex])) {
+			fprintf(stderr, "Failed to load %s\n", fileNames[frameIndex]);
+			return 1;
+		}
+
+		assert(frame->windowWidth == windowWidth && frame->windowHeight == windowHeight);
+		firstStaticMesh += frame->numStaticMeshes;
+
+		printf("Loaded %s: %d elements, %d textures, %d static meshes\n", fileNames[frameIndex], 
+			   frame->numElems, frame->numGLTextures, frame->numStaticMeshes);
+	}
+
+	double secondsPerCount = 1.0 / (double)SDL_GetPerformanceFrequency();
+	bool running = true;
+
+	for(s32 passIndex = 0; running && (!passes || passIndex < passes); passIndex++) {
+		for(s32 frameIndex = 0; running && frameIndex < numFrames; frameIndex++) {
+			RenderCapture* frame = frames + frameIndex;
+
+			double totalSeconds = 0;
+			double maxSeconds = 0;
+
+			for(s32 iteration = 0; iteration < iterations; iteration++) {
+				SDL_Event event;
+				while(SDL_PollEvent(&event)) {
+					if(event.type == SDL_QUIT) running = false;
+				}
+
+				u64 startCount = SDL_GetPerformanceCounter();
+
+				clearScreen(renderGroup);
+
+				replayRenderCapture(renderGroup, frame);
+
+				//NOTE: This makes the time include the GPU work
+				if(gl) glFinish();
+
+				double seconds = (SDL_GetPerformanceCounter() - startCount) * secondsPerCount;
+				totalSeconds += seconds;
+				maxSeconds = max(maxSeconds, seconds);
+
+				presentScreen(renderGroup, window);
+			}
+
+			RenderStats* stats = &renderGroup->stats;
+			printf("%s: %.3fms average, %.3fms max, Draw calls: %d, State changes: %d, Quads: %d\n", 
+				   fileNames[frameIndex], totalSeconds * 1000.0 / iterations, maxSeconds * 1000.0, 
+				   stats->drawCalls, stats->stateChanges, stats->quads);
+		}
+	}
+
+	return 0;
+}
@@ -1,3 +1,5 @@
+#include "hackformer_softwareRenderer.cpp"
+
 s32 getAssetPos(Assets* assets, AssetId id) {
 	s32 result = assets->assetFileOffsets[id];
 	return result;
@@ -32,10 +34,214 @@ void loadShaderSource(RenderGroup* group, AssetId assetId, char* source, s32 max
 	source[length] = 0;
 }
 
-GLuint addShader_(RenderGroup* group, GLenum type, AssetId sourceId, Shader shaderProgram) {
-	char sourceBuffer[4000];
-	char* source = sourceBuffer;
-	loadShaderSource(group, sourceId, source, arrayCount(sourceBuffer));
+//NOTE: FNV-1a
+#define HASH_OFFSET_BASIS 14695981039346656037ULL
+
+u64 hashBytes(u64 hash, void* data, size_t size) {
+	u64 result = hash;
+	u8* bytes = (u8*)data;
+
+	for(size_t byteIndex = 0; byteIndex < size; byteIndex++) {
+		result ^= bytes[byteIndex];
+		result *= 1099511628211ULL;
+	}
+
+	return result;
+}
+
+u64 hashString(u64 hash, char* str) {
+	u64 result = hashBytes(hash, str, strlen(str));
+	return result;
+}
+
+void initProgramCache(ProgramCache* cache, char* filePath) {
+	*cache = {};
+	cache->filePath = filePath;
+
+	#ifdef USE_GLEW
+	cache->binariesSupported = GLEW_ARB_get_program_binary;
+	#else
+	cache->binariesSupported = true;
+	#endif
+
+	if(cache->binariesSupported) {
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		cache->binariesSupported = numFormats > 0;
+	}
+
+	u64 hash = HASH_OFFSET_BASIS;
+	hash = hashString(hash, (char*)glGetString(GL_VENDOR));
+	hash = hashString(hash, (char*)glGetString(GL_RENDERER));
+	hash = hashString(hash, (char*)glGetString(GL_VERSION));
+	cache->driverHash = hash;
+
+	if(!cache->binariesSupported || !filePath) return;
+
+	//NOTE: A missing or unreadable file is just an empty cache
+	FILE* file = fopen(filePath, "rb");
+	if(!file) return;
+
+	fseek(file, 0, SEEK_END);
+	long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	ProgramCacheHeader header;
+	bool32 valid = fread(&header, sizeof(header), 1, file) == 1 &&
+				   header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION &&
+				   header.numBinaries >= 0 && header.numBinaries <= MAX_CACHED_PROGRAMS;
+
+	for(s32 binaryIndex = 0; valid && binaryIndex < header.numBinaries; binaryIndex++) {
+		ProgramBinary* binary = cache->binaries + cache->numBinaries;
+		valid = fread(&binary->header, sizeof(binary->header), 1, file) == 1;
+
+		//NOTE: A truncated or corrupt file can have any length, so it can't be more than what is left of the file
+		if(valid) {
+			long remainingSize = fileSize - ftell(file);
+			valid = binary->header.length > 0 && binary->header.length <= MAX_PROGRAM_BINARY_SIZE &&
+					binary->header.length <= remainingSize;
+		}
+
+		if(valid) {
+			binary->data = malloc(binary->header.length);
+			cache->numBinaries++;
+
+			valid = binary->data && fread(binary->data, binary->header.length, 1, file) == 1;
+		}
+	}
+
+	if(!valid) {
+		fprintf(stderr, "Ignoring invalid program cache %s\n", filePath);
+
+		for(s32 binaryIndex = 0; binaryIndex < cache->numBinaries; binaryIndex++) {
+			free(cache->binaries[binaryIndex].data);
+			cache->binaries[binaryIndex].data = NULL;
+		}
+
+		cache->numBinaries = 0;
+		cache->changed = true;
+	}
+
+	fclose(file);
+}
+
+//NOTE: This returns false if the program has to be compiled
+bool32 loadProgramBinary(ProgramCache* cache, GLuint program, u64 key) {
+	bool32 result = false;
+
+	for(s32 binaryIndex = 0; binaryIndex < cache->numBinaries; binaryIndex++) {
+		ProgramBinary* binary = cache->binaries + binaryIndex;
+
+		if(binary->header.key == key && binary->data) {
+			glProgramBinary(program, binary->header.format, binary->data, binary->header.length);
+
+			GLint linkSuccess = 0;
+			glGetProgramiv(program, GL_LINK_STATUS, &linkSuccess);
+
+			if(linkSuccess == GL_TRUE) {
+				binary->used = true;
+				result = true;
+			} else {
+				//NOTE: The driver rejected the binary, it is replaced once the program is compiled
+				free(binary->data);
+				binary->data = NULL;
+				cache->changed = true;
+			}
+
+			break;
+		}
+	}
+
+	return result;
+}
+
+void saveProgramBinary(ProgramCache* cache, GLuint program, u64 key) {
+	if(!cache->binariesSupported) return;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if(length <= 0) return;
+
+	ProgramBinary* binary = NULL;
+
+	for(s32 binaryIndex = 0; binaryIndex < cache->numBinaries; binaryIndex++) {
+		ProgramBinary* test = cache->binaries + binaryIndex;
+
+		if(test->header.key == key || !test->data) {
+			binary = test;
+			break;
+		}
+	}
+
+	if(!binary) {
+		assert(cache->numBinaries < arrayCount(cache->binaries));
+		binary = cache->binaries + cache->numBinaries++;
+	}
+
+	free(binary->data);
+
+	binary->header.key = key;
+	binary->header.length = length;
+	binary->data = malloc(length);
+	assert(binary->data);
+
+	GLsizei writtenLength = 0;
+	glGetProgramBinary(program, length, &writtenLength, &binary->header.format, binary->data);
+	assert(writtenLength == length);
+
+	binary->used = true;
+	cache->changed = true;
+}
+
+//NOTE: This writes the binaries back if any of them changed and frees the shader objects
+void closeProgramCache(ProgramCache* cache) {
+	for(s32 binaryIndex = 0; binaryIndex < cache->numBinaries; binaryIndex++) {
+		if(!cache->binaries[binaryIndex].used) cache->changed = true;
+	}
+
+	if(cache->changed && cache->binariesSupported && cache->filePath) {
+		FILE* file = fopen(cache->filePath, "wb");
+
+		if(file) {
+			ProgramCacheHeader header = {PROGRAM_CACHE_MAGIC, PROGRAM_CACHE_VERSION, 0};
+
+			for(s32 binaryIndex = 0; binaryIndex < cache->numBinaries; binaryIndex++) {
+				if(cache->binaries[binaryIndex].used) header.numBinaries++;
+			}
+
+			fwrite(&header, sizeof(header), 1, file);
+
+			for(s32 binaryIndex = 0; binaryIndex < cache->numBinaries; binaryIndex++) {
+				ProgramBinary* binary = cache->binaries + binaryIndex;
+
+				if(binary->used) {
+					fwrite(&binary->header, sizeof(binary->header), 1, file);
+					fwrite(binary->data, binary->header.length, 1, file);
+				}
+			}
+
+			fclose(file);
+		} else {
+			fprintf(stderr, "Failed to write the program cache %s\n", cache->filePath);
+		}
+	}
+
+	for(s32 binaryIndex = 0; binaryIndex < cache->numBinaries; binaryIndex++) {
+		free(cache->binaries[binaryIndex].data);
+	}
+
+	for(s32 shaderIndex = 0; shaderIndex < cache->numShaders; shaderIndex++) {
+		glDeleteShader(cache->shaders[shaderIndex].shader);
+	}
+
+	*cache = {};
+}
+
+GLuint getCompiledShader(RenderGroup* group, ProgramCache* cache, GLenum type, AssetId sourceId, char* source) {
+	for(s32 shaderIndex = 0; shaderIndex < cache->numShaders; shaderIndex++) {
+		CompiledShader* compiled = cache->shaders + shaderIndex;
+		if(compiled->sourceId == sourceId) return compiled->shader;
+	}
 
 	GLuint shader = glCreateShader(type);
 	assert(shader);
@@ -54,115 +260,298 @@ GLuint addShader_(RenderGroup* group, GLenum type, AssetId sourceId, Shader shad
 		InvalidCodePath;
 	}
 
-	glAttachShader(shaderProgram.program, shader);
+	assert(cache->numShaders < arrayCount(cache->shaders));
+	CompiledShader* compiled = cache->shaders + cache->numShaders++;
+	compiled->sourceId = sourceId;
+	compiled->shader = shader;
+
+	group->shaderStartup.shadersCompiled++;
 
 	return shader;
 }
 
-Shader createShader(RenderGroup* group, AssetId vsId, AssetId fsId, V2 windowSize) {
+Shader createShader(RenderGroup* group, ProgramCache* cache, AssetId vsId, AssetId fsId, V2 windowSize) {
 	Shader result = {};
 
+	char vsSource[MAX_SHADER_SOURCE_LENGTH];
+	char fsSource[MAX_SHADER_SOURCE_LENGTH];
+	loadShaderSource(group, vsId, vsSource, arrayCount(vsSource));
+	loadShaderSource(group, fsId, fsSource, arrayCount(fsSource));
+
+	u64 key = hashString(hashString(cache->driverHash, vsSource), fsSource);
+
 	result.program = glCreateProgram();
 	assert(result.program);
 
-	GLuint vertexShader = addShader_(group, GL_VERTEX_SHADER, vsId, result);
-	GLuint fragmentShader = addShader_(group, GL_FRAGMENT_SHADER, fsId, result);
+	if(loadProgramBinary(cache, result.program, key)) {
+		group->shaderStartup.programsLoaded++;
+	} else {
+		//NOTE: A program which failed to load a binary is recreated so that nothing about it carries over
+		glDeleteProgram(result.program);
+		result.program = glCreateProgram();
+		assert(result.program);
 
-	glLinkProgram(result.program);
+		GLuint vertexShader = getCompiledShader(group, cache, GL_VERTEX_SHADER, vsId, vsSource);
+		GLuint fragmentShader = getCompiledShader(group, cache, GL_FRAGMENT_SHADER, fsId, fsSource);
 
-	GLint linkSuccess = 0;
-	glGetProgramiv(result.program, GL_LINK_STATUS, &linkSuccess);
+		glAttachShader(result.program, vertexShader);
+		glAttachShader(result.program, fragmentShader);
 
-	if (linkSuccess == GL_FALSE) {
-		GLchar errorBuffer[1024];
-		GLsizei errorLength = 0;
-		glGetProgramInfoLog(result.program, (GLsizei)arrayCount(errorBuffer), &errorLength, errorBuffer);
-		fprintf(stderr, "Failed to link shader: %s\n", errorBuffer);
-		InvalidCodePath;
-	}
+		glBindAttribLocation(result.program, VertexAttribute_p, "p");
+		glBindAttribLocation(result.program, VertexAttribute_uv, "uv");
+		glBindAttribLocation(result.program, VertexAttribute_color, "color");
+		glBindAttribLocation(result.program, VertexAttribute_emissivity, "emissivity");
+
+		if(cache->binariesSupported) {
+			glProgramParameteri(result.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		glLinkProgram(result.program);
+
+		GLint linkSuccess = 0;
+		glGetProgramiv(result.program, GL_LINK_STATUS, &linkSuccess);
 
-	glDetachShader(result.program, vertexShader);
-	glDetachShader(result.program, fragmentShader);
+		if (linkSuccess == GL_FALSE) {
+			GLchar errorBuffer[1024];
+			GLsizei errorLength = 0;
+			glGetProgramInfoLog(result.program, (GLsizei)arrayCount(errorBuffer), &errorLength, errorBuffer);
+			fprintf(stderr, "Failed to link shader: %s\n", errorBuffer);
+			InvalidCodePath;
+		}
 
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+		glDetachShader(result.program, vertexShader);
+		glDetachShader(result.program, fragmentShader);
+
+		saveProgramBinary(cache, result.program, key);
+		group->shaderStartup.programsCompiled++;
+	}
 
 	glUseProgram(result.program);
 	GLint windowSizeUniformLocation = glGetUniformLocation(result.program, "twoOverScreenSize");
 	glUniform2f(windowSizeUniformLocation, (GLfloat)(2.0/windowSize.x), (GLfloat)(2.0/windowSize.y));
 
-	result.tintUniformLocation = glGetUniformLocation(result.program, "tint");
-
 	GLint diffuseLocation = glGetUniformLocation(result.program, "diffuseTexture");
 	glUniform1i(diffuseLocation, 0);
 
 	return result;
 }
 
-ForwardShader createForwardShader(RenderGroup* group, V2 windowSize) {
+ForwardShader createForwardShader(RenderGroup* group, ProgramCache* cache, V2 windowSize) {
 	ForwardShader result = {};
 
-	result.shader = createShader(group, Asset_forwardVS, Asset_forwardFS, windowSize);
+	result.shader = createShader(group, cache, Asset_forwardVS, Asset_forwardFS, windowSize);
 
 	result.ambientUniform = glGetUniformLocation(result.shader.program, "ambient");
+	result.cameraOffsetUniform = glGetUniformLocation(result.shader.program, "cameraOffset");
+	result.glowTimeUniform = glGetUniformLocation(result.shader.program, "glowTime");
+
+	result.lightingEnabledUniform = glGetUniformLocation(result.shader.program, "lightingEnabled");
+
+	return result;
+}
 
-	char uniformName[128];
+//NOTE: This draws all of the quads which have been batched so far. It has to be called before any 
+//		texture, shader, clip rect or uniform change.
+void flushBatch(RenderGroup* group) {
+	s32 numQuads = group->numBatchQuads;
+	if(!numQuads) return;
 
-	for(s32 lightIndex = 0; lightIndex < arrayCount(result.pointLightUniforms); lightIndex++) {
-        const char* uniformPrefix = "pointLights[";
-        
-		PointLightUniforms* lightUniforms = result.pointLightUniforms + lightIndex;
+	if(group->backend != RenderBackend_gl) {
+		if(group->backend == RenderBackend_software) {
+			addSoftwareQuads(group, group->batchVertices, numQuads);
+		}
 
-		sprintf(uniformName, "%s%d].p", uniformPrefix, lightIndex);
-		lightUniforms->p = glGetUniformLocation(result.shader.program, uniformName);
+		group->numBatchQuads = 0;
+		group->stats.drawCalls++;
+		return;
+	}
 
-		sprintf(uniformName, "%s%d].color", uniformPrefix, lightIndex);
-		lightUniforms->color = glGetUniformLocation(result.shader.program, uniformName);
+	s32 numVertices = numQuads * 4;
 
-		sprintf(uniformName, "%s%d].range", uniformPrefix, lightIndex);
-		lightUniforms->range = glGetUniformLocation(result.shader.program, uniformName);
+	if(group->vertexBufferOffset + numVertices > VERTEX_BUFFER_QUADS * 4) {
+		//NOTE: Orphaning the buffer means that the driver doesn't have to wait for the draws which are still using it
+		glBufferData(GL_ARRAY_BUFFER, VERTEX_BUFFER_QUADS * 4 * sizeof(BatchVertex), NULL, GL_STREAM_DRAW);
+		group->vertexBufferOffset = 0;
 	}
 
-	for(s32 lightIndex = 0; lightIndex < arrayCount(result.spotLightUniforms); lightIndex++) {
-        const char* uniformPrefix = "spotLights[";
-        
-		SpotLightUniforms* lightUniforms = result.spotLightUniforms + lightIndex;
+	GLintptr offset = group->vertexBufferOffset * sizeof(BatchVertex);
+	GLsizeiptr size = numVertices * sizeof(BatchVertex);
+
+	//NOTE: This range of the buffer hasn't been used since it was last orphaned, so no synchronization is needed
+	void* dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, 
+								 GL_MAP_WRITE_BIT|GL_MAP_INVALIDATE_RANGE_BIT|GL_MAP_UNSYNCHRONIZED_BIT);
+	assert(dst);
+	memcpy(dst, group->batchVertices, size);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
 
-		sprintf(uniformName, "%s%d].base.p", uniformPrefix, lightIndex);
-		lightUniforms->base.p = glGetUniformLocation(result.shader.program, uniformName);
+	glDrawElementsBaseVertex(GL_TRIANGLES, numQuads * 6, GL_UNSIGNED_SHORT, NULL, group->vertexBufferOffset);
 
-		sprintf(uniformName, "%s%d].base.color", uniformPrefix, lightIndex);
-		lightUniforms->base.color = glGetUniformLocation(result.shader.program, uniformName);
+	group->vertexBufferOffset += numVertices;
+	group->numBatchQuads = 0;
+	group->stats.drawCalls++;
+}
 
-		sprintf(uniformName, "%s%d].dir", uniformPrefix, lightIndex);
-		lightUniforms->dir = glGetUniformLocation(result.shader.program, uniformName);
+//NOTE: The points and uvs go counter clockwise starting from the bottom left
+void applyRenderState(RenderGroup* group);
+
+void writeQuadVertices(BatchVertex* vertex, V2* p, V2* uv, Color color, float emissivity) {
+	for(s32 vertexIndex = 0; vertexIndex < 4; vertexIndex++) {
+		vertex->p[0] = (GLfloat)p[vertexIndex].x;
+		vertex->p[1] = (GLfloat)p[vertexIndex].y;
+		vertex->uv[0] = (GLfloat)uv[vertexIndex].x;
+		vertex->uv[1] = (GLfloat)uv[vertexIndex].y;
+		vertex->color[0] = color.r;
+		vertex->color[1] = color.g;
+		vertex->color[2] = color.b;
+		vertex->color[3] = color.a;
+		vertex->emissivity = emissivity;
+
+		vertex++;
+	}
+}
 
-		sprintf(uniformName, "%s%d].cutoff", uniformPrefix, lightIndex);
-		lightUniforms->cutoff = glGetUniformLocation(result.shader.program, uniformName);
+void addQuadToBatch(RenderGroup* group, V2* p, V2* uv, Color color, float emissivity) {
+	applyRenderState(group);
 
-		sprintf(uniformName, "%s%d].base.range", uniformPrefix, lightIndex);
-		lightUniforms->base.range = glGetUniformLocation(result.shader.program, uniformName);
+	if(group->numBatchQuads == MAX_BATCH_QUADS) {
+		flushBatch(group);
 	}
 
-	return result;
+	BatchVertex* vertex = group->batchVertices + group->numBatchQuads * 4;
+	writeQuadVertices(vertex, p, uv, color, emissivity);
+
+	group->numBatchQuads++;
+	group->stats.quads++;
+}
+
+//NOTE: This sets up the vertex attributes of the bound vertex array to read from the bound array buffer
+void setupVertexAttributes() {
+	glEnableVertexAttribArray(VertexAttribute_p);
+	glVertexAttribPointer(VertexAttribute_p, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, p));
+
+	glEnableVertexAttribArray(VertexAttribute_uv);
+	glVertexAttribPointer(VertexAttribute_uv, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, uv));
+
+	glEnableVertexAttribArray(VertexAttribute_color);
+	glVertexAttribPointer(VertexAttribute_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, color));
+
+	glEnableVertexAttribArray(VertexAttribute_emissivity);
+	glVertexAttribPointer(VertexAttribute_emissivity, 1, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, emissivity));
+}
+
+void initBatch(RenderGroup* group) {
+	glGenVertexArrays(1, &group->vertexArray);
+	glBindVertexArray(group->vertexArray);
+
+	glGenBuffers(1, &group->vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, group->vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, VERTEX_BUFFER_QUADS * 4 * sizeof(BatchVertex), NULL, GL_STREAM_DRAW);
+
+	setupVertexAttributes();
+
+	//NOTE: Every quad uses the same indices, so they are only uploaded once
+	u16* indices = (u16*)malloc(MAX_BATCH_QUADS * 6 * sizeof(u16));
+	assert(indices);
+
+	for(s32 quadIndex = 0; quadIndex < MAX_BATCH_QUADS; quadIndex++) {
+		u16 firstVertex = (u16)(quadIndex * 4);
+		u16* quadIndices = indices + quadIndex * 6;
+
+		quadIndices[0] = firstVertex;
+		quadIndices[1] = firstVertex + 1;
+		quadIndices[2] = firstVertex + 2;
+		quadIndices[3] = firstVertex;
+		quadIndices[4] = firstVertex + 2;
+		quadIndices[5] = firstVertex + 3;
+	}
+
+	glGenBuffers(1, &group->indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, group->indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, MAX_BATCH_QUADS * 6 * sizeof(u16), indices, GL_STATIC_DRAW);
+
+	free(indices);
+
+	//NOTE: Every texture is drawn with the same blending
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void createLightBuffer(GLuint* buffer, GLuint* texture, GLenum format, s32 textureUnit) {
+	glGenBuffers(1, buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+
+	glGenTextures(1, texture);
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, *texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+}
+
+//NOTE: The light buffers stay bound to texture units 1 to 3, every other texture uses unit 0
+void initLightTiles(RenderGroup* group) {
+	LightTiles* tiles = &group->lightTiles;
+
+	tiles->tileSize = LIGHT_TILE_SIZE / group->pixelsPerMeter;
+	tiles->tilesWidth = (group->windowWidth + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+	tiles->tilesHeight = (group->windowHeight + LIGHT_TILE_SIZE - 1) / LIGHT_TILE_SIZE;
+	assert(tiles->tilesWidth * tiles->tilesHeight <= MAX_LIGHT_TILES);
+
+	createLightBuffer(&tiles->dataBuffer, &tiles->dataTexture, GL_RGBA32F, 1);
+	createLightBuffer(&tiles->tileBuffer, &tiles->tileTexture, GL_RG32I, 2);
+	createLightBuffer(&tiles->indexBuffer, &tiles->indexTexture, GL_R32I, 3);
+
+	glActiveTexture(GL_TEXTURE0);
+
+	GLuint program = group->forwardShader.shader.program;
+	glUseProgram(program);
+
+	glUniform1i(glGetUniformLocation(program, "lightData"), 1);
+	glUniform1i(glGetUniformLocation(program, "lightTiles"), 2);
+	glUniform1i(glGetUniformLocation(program, "lightIndices"), 3);
+	glUniform1f(glGetUniformLocation(program, "lightTileSize"), (GLfloat)tiles->tileSize);
+	glUniform2i(glGetUniformLocation(program, "lightTilesSize"), tiles->tilesWidth, tiles->tilesHeight);
+}
+
+void waitForRenderFrame(RenderGroup* group) {
+	if(group->frameInFlight) {
+		SDL_SemWait(group->frameDone);
+		group->frameInFlight = false;
+		group->lastFrameStats = group->stats;
+	}
+}
+
+//NOTE: This has to be called before the game thread changes anything which the render thread reads while it is
+//		drawing (textures, glyph pages, static meshes and the level storage). It waits for the frame which is being
+//		drawn, and the game thread keeps the GL context until the next frame is submitted.
+void acquireRenderResources(RenderGroup* group) {
+	if(group->threaded && !group->resourcesAcquired) {
+		waitForRenderFrame(group);
+
+		if(group->backend == RenderBackend_gl) SDL_GL_MakeCurrent(group->window, group->glContext);
+		group->resourcesAcquired = true;
+	}
 }
 
-void freeTexture(Texture* texture) {
+void freeTexture(RenderGroup* group, Texture* texture) {
 	if(texture->texId) {
-		glDeleteTextures(1, &texture->texId);
+		acquireRenderResources(group);
+
+		if(group->backend == RenderBackend_gl) glDeleteTextures(1, &texture->texId);
+		else if(group->backend == RenderBackend_software) freeSoftwareTexture(group->software, texture->texId);
+
 		texture->texId = 0;
 	}
 }
 
-Texture createTex(RenderGroup* group, s32 width, s32 height, s32 numComponents, void* pixels, bool srgb) {
-	Texture result = {};
+//NOTE: This replaces the storage of a GL texture, the texture name stays the same
+void uploadTex(RenderGroup* group, GLuint texId, s32 width, s32 height, s32 numComponents, void* pixels, bool srgb) {
+	assert(group->backend == RenderBackend_gl);
+	acquireRenderResources(group);
 
-	glEnable(GL_TEXTURE_2D);
-
-	glGenTextures(1, &result.texId);
-	assert(result.texId);
+	//NOTE: The pending quads have to be drawn before the texture binding is changed
+	flushBatch(group);
 
-	glBindTexture(GL_TEXTURE_2D, result.texId);
+	glBindTexture(GL_TEXTURE_2D, texId);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -183,11 +572,34 @@ Texture createTex(RenderGroup* group, s32 width, s32 height, s32 numComponents,
 	GLint internalFormal = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA;
 
 	glTexImage2D(GL_TEXTURE_2D, 0, internalFormal, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+	
+	glBindTexture(GL_TEXTURE_2D, 0);
+	group->appliedState.texture = 0;
+}
+
+Texture createTex(RenderGroup* group, s32 width, s32 height, s32 numComponents, void* pixels, bool srgb) {
+	acquireRenderResources(group);
+
+	Texture result = {};
 
 	result.uv = r2(v2(0, 0), v2(1, 1));
+	result.trim = result.uv;
 	result.size = v2(width, height) * (1.0 / group->pixelsPerMeter);
-	
-	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if(group->backend == RenderBackend_null) {
+		result.texId = ++group->nullTexturesCount;
+		return result;
+	}
+
+	if(group->backend == RenderBackend_software) {
+		result.texId = createSoftwareTexture(group->software, width, height, numComponents, pixels);
+		return result;
+	}
+
+	glGenTextures(1, &result.texId);
+	assert(result.texId);
+
+	uploadTex(group, result.texId, width, height, numComponents, pixels, srgb);
 
 	return result;
 }
@@ -226,105 +638,521 @@ Texture* loadPNGTexture(RenderGroup* group, char* fileName, bool stencil) {
 	return result;
 }
 
-//stencil is false by default
-Texture* loadPNGTexture(RenderGroup* group, AssetId id, bool stencil) {
-	FILE* readStream = group->assets->fileHandle;
-	s32 seekResult = fseek(readStream, getAssetPos(group->assets, id), SEEK_SET);
+//NOTE: This returns the pixels of the resource, they have to be freed with stbi_image_free
+void* decodeTextureResource(FILE* file, TextureResource* resource, s32* numComponents) {
+	s32 seekResult = fseek(file, resource->filePos, SEEK_SET);
 	assert(seekResult == 0);
 
-	Texture* result = loadPNGTexture(group, readStream, stencil);
-	return result;
-}
+	void* result = NULL;
+	int width, height, components;
 
+	if(resource->atlasPage) {
+		s32 pngSize;
+		size_t readCount = fread(&pngSize, sizeof(pngSize), 1, file);
+		assert(readCount == 1);
 
-SDL_RWops* getFilePtrFromMem(Assets* assets, AssetId id, MemoryArena* arena) {
-	SDL_RWops* readStream = seekToAssetPos(assets, id);
-	s32 assetSize = getAssetSize(assets, id);
+		u8* png = (u8*)malloc(pngSize);
+		assert(png);
+		readCount = fread(png, pngSize, 1, file);
+		assert(readCount == 1);
 
-	void* mem = pushSize(arena, assetSize);
-	SDL_RWread(readStream, mem, assetSize, 1);
+		result = stbi_load_from_memory(png, pngSize, &width, &height, &components, 4);
+		components = 4;
+		free(png);
+	} else {
+		result = stbi_load_from_file(file, &width, &height, &components, 0);
+	}
 
-	readStream = SDL_RWFromMem(mem, assetSize);
-	assert(readStream);
+	assert(result);
+	assert(width == resource->width && height == resource->height);
 
-	return readStream;
+	*numComponents = components;
+	return result;
 }
 
-TTF_Font* loadFont(RenderGroup* group, AssetId id, s32 fontSize, MemoryArena* arena) {
-	SDL_RWops* readStream = getFilePtrFromMem(group->assets, id, arena);
+s32 addTextureResource(RenderGroup* group, s32 filePos, s32 width, s32 height, bool32 atlasPage, bool32 stencil) {
+	TextureResidency* residency = &group->residency;
+	assert(residency->numResources < MAX_TEXTURE_RESOURCES);
 
-	TTF_Font* font = TTF_OpenFontRW(readStream, 0, fontSize);
+	s32 result = residency->numResources++;
+	TextureResource* resource = residency->resources + result;
+	*resource = {};
 
-	if (!font) {
-		//const char* error = TTF_GetError();
-		fprintf(stderr, "Failed to load font with id: %d\n", id);
-		InvalidCodePath;
-	}
+	acquireRenderResources(group);
+	glGenTextures(1, &resource->texId);
+	assert(resource->texId);
 
-	TTF_SetFontHinting(font, TTF_HINTING_LIGHT);
+	resource->filePos = filePos;
+	resource->atlasPage = atlasPage;
+	resource->stencil = stencil;
+	resource->width = width;
+	resource->height = height;
+	resource->bytes = (size_t)width * (size_t)height * 4;
 
-	return font;
-	//return NULL;
-}
+	residency->setsChanged = true;
 
-CachedFont loadCachedFont(RenderGroup* group, AssetId id, s32 fontSize, double scaleFactor, MemoryArena* arena) {
-	CachedFont result = {};
-	result.font = loadFont(group, id, (s32)round(fontSize * scaleFactor), arena);
-	result.scaleFactor = scaleFactor;
-	result.lineHeight = fontSize / (group->pixelsPerMeter * scaleFactor);
 	return result;
 }
 
-Texture* extractTextures(RenderGroup* group, AssetId id, s32 frameWidth, s32 frameHeight, s32 frameSpacing, s32* numFrames) {
-	Texture* tex = loadPNGTexture(group, id);
-	
-	s32 texWidth = (s32)(tex->size.x * group->pixelsPerMeter + 0.5);
-	s32 texHeight = (s32)(tex->size.y * group->pixelsPerMeter + 0.5);
-
-	s32 numCols = texWidth / (frameWidth + frameSpacing);
-	s32 numRows = texHeight / (frameHeight + frameSpacing);
-
-	assert(frameWidth > 0);
-	assert(frameHeight > 0);
+void makeTextureResident(RenderGroup* group, TextureResource* resource, void* pixels, s32 numComponents) {
+	assert(!resource->resident);
 
-	//TODO: Add a way to test this
-	//assert(width % numCols == 0);
-	//assert(height % numRows == 0);
+	uploadTex(group, resource->texId, resource->width, resource->height, numComponents, pixels, !resource->stencil);
 
-	*numFrames = numRows * numCols;
-	Texture* result = tex + 1;
+	resource->resident = true;
+	group->residency.residentBytes += resource->bytes;
+}
 
-	V2 frameSize = v2((double)(frameWidth + frameSpacing) / (double)texWidth, 
-		(double)(frameHeight + frameSpacing) / (double)texHeight);
+void evictTextureResource(RenderGroup* group, TextureResource* resource) {
+	assert(resource->resident);
 
-	V2 texSize = v2((double)frameWidth / (double)texWidth, (double)frameHeight/(double)texHeight);
+	//NOTE: Replacing the storage with a single pixel frees it without freeing the texture name
+	u32 pixel = 0;
+	uploadTex(group, resource->texId, 1, 1, 4, &pixel, !resource->stencil);
 
-	V2 frameOffset = v2(frameSpacing / (double)texWidth, frameSpacing / (double)texHeight) * 0.5;
+	resource->resident = false;
+	group->residency.residentBytes -= resource->bytes;
+}
 
-	V2 dataTexSize = hadamard(texSize, tex->size);
+//NOTE: This evicts the resources which aren't in any set, starting with the ones which were needed the longest 
+//		time ago, until extraBytes more fit in the budget
+void evictTextureResources(RenderGroup* group, size_t extraBytes) {
+	TextureResidency* residency = &group->residency;
 
-	for (s32 rowIndex = 0; rowIndex < numRows; rowIndex++) {
-		for (s32 colIndex = 0; colIndex < numCols; colIndex++) {
-			s32 textureIndex = colIndex + rowIndex * numCols;
+	while(residency->residentBytes + extraBytes > residency->budget) {
+		TextureResource* oldest = NULL;
 
-			Texture* data = result + textureIndex;
-			data->texId = tex->texId;
+		for(s32 resourceIndex = 0; resourceIndex < residency->numResources; resourceIndex++) {
+			TextureResource* resource = residency->resources + resourceIndex;
 
-			V2 minCorner = hadamard(v2(colIndex, rowIndex), frameSize) + frameOffset;
-			data->uv = r2(minCorner, minCorner + texSize);
-			data->size = dataTexSize;
+			if(resource->resident && !resource->sets && resourceIndex != residency->streamingResource &&
+			   (!oldest || resource->lastNeeded < oldest->lastNeeded)) {
+				oldest = resource;
+			}
 		}
+
+		if(!oldest) break;
+		evictTextureResource(group, oldest);
 	}
+}
 
-	*group->texturesCount = *group->texturesCount + *numFrames;
-	assert(*group->texturesCount < MAX_TEXTURES);
+int textureStreamThread(void* data) {
+	TextureResidency* residency = (TextureResidency*)data;
 
-	return result;
+	while(true) {
+		SDL_SemWait(residency->streamRequest);
+		if(residency->streamQuit) break;
+
+		TextureResource* resource = residency->resources + residency->streamingResource;
+		residency->streamPixels = decodeTextureResource(residency->streamFile, resource, &residency->streamComponents);
+
+		SDL_SemPost(residency->streamDone);
+	}
+
+	return 0;
 }
 
-Animation loadAnimation(RenderGroup* group, AssetId id, s32 frameWidth, s32 frameHeight, double secondsPerFrame,
-						bool pingPong) {
-	Animation result = {};
+//NOTE: This has to be called after the streaming thread posted streamDone
+void finishTextureStream(RenderGroup* group) {
+	TextureResidency* residency = &group->residency;
+	assert(residency->streamingResource >= 0);
+
+	TextureResource* resource = residency->resources + residency->streamingResource;
+
+	//NOTE: The level could have changed while the resource was being decoded
+	if(resource->sets && !resource->resident) {
+		evictTextureResources(group, resource->bytes);
+		makeTextureResident(group, resource, residency->streamPixels, residency->streamComponents);
+	}
+
+	stbi_image_free(residency->streamPixels);
+	residency->streamPixels = NULL;
+	residency->streamingResource = -1;
+}
+
+//NOTE: The atlas pages and the textures which aren't in the atlas are only uploaded once an asset which uses them is
+//		in a texture set (see updateTextureResidency). This has to be called before any textures are loaded.
+void initTextureResidency(RenderGroup* group, size_t budget) {
+	assert(group->backend == RenderBackend_gl);
+
+	TextureResidency* residency = &group->residency;
+	residency->enabled = true;
+	residency->budget = budget;
+	residency->streamingResource = -1;
+
+	for(s32 assetId = 0; assetId < Asset_count; assetId++) {
+		residency->assetSets[assetId] = TextureSet_always;
+		residency->assetResources[assetId] = -1;
+	}
+
+	residency->streamFile = fopen("assets.bin", "rb");
+	assert(residency->streamFile);
+
+	residency->streamRequest = SDL_CreateSemaphore(0);
+	residency->streamDone = SDL_CreateSemaphore(0);
+	assert(residency->streamRequest && residency->streamDone);
+
+	residency->streamThread = SDL_CreateThread(textureStreamThread, "TextureStream", residency);
+	assert(residency->streamThread);
+}
+
+void shutdownTextureResidency(RenderGroup* group) {
+	TextureResidency* residency = &group->residency;
+	if(!residency->enabled) return;
+
+	//NOTE: The resource which is being streamed has to be decoded before the file can be closed
+	if(residency->streamingResource >= 0) {
+		SDL_SemWait(residency->streamDone);
+		stbi_image_free(residency->streamPixels);
+		residency->streamPixels = NULL;
+		residency->streamingResource = -1;
+	}
+
+	residency->streamQuit = true;
+	SDL_SemPost(residency->streamRequest);
+	SDL_WaitThread(residency->streamThread, NULL);
+	residency->streamThread = NULL;
+
+	fclose(residency->streamFile);
+	residency->streamFile = NULL;
+
+	SDL_DestroySemaphore(residency->streamRequest);
+	SDL_DestroySemaphore(residency->streamDone);
+	residency->enabled = false;
+}
+
+void setAssetTextureSet(RenderGroup* group, AssetId id, TextureSet set, bool32 inSet) {
+	TextureResidency* residency = &group->residency;
+
+	u8 sets = residency->assetSets[id];
+	if(inSet) sets |= set;
+	else sets &= ~set;
+
+	if(sets != residency->assetSets[id]) {
+		residency->assetSets[id] = sets;
+		residency->setsChanged = true;
+	}
+}
+
+void clearTextureSet(RenderGroup* group, TextureSet set) {
+	for(s32 assetId = 0; assetId < Asset_count; assetId++) {
+		setAssetTextureSet(group, (AssetId)assetId, set, false);
+	}
+}
+
+//NOTE: This loads every resource which is needed by TextureSet_always or TextureSet_currentLevel before it returns,
+//		and streams in the ones which are needed by TextureSet_nextLevel. It is called once per frame.
+void updateTextureResidency(RenderGroup* group) {
+	TextureResidency* residency = &group->residency;
+	if(!residency->enabled) return;
+
+	if(residency->setsChanged) {
+		residency->setsChanged = false;
+		residency->generation++;
+
+		for(s32 resourceIndex = 0; resourceIndex < residency->numResources; resourceIndex++) {
+			residency->resources[resourceIndex].sets = 0;
+		}
+
+		for(s32 assetId = 1; assetId < Asset_count; assetId++) {
+			u8 sets = residency->assetSets[assetId];
+			if(!sets) continue;
+
+			if(residency->assetResources[assetId] >= 0) {
+				residency->resources[residency->assetResources[assetId]].sets |= sets;
+			}
+
+			PackedAsset* asset = group->atlas.assets + assetId;
+
+			for(s32 frameIndex = 0; frameIndex < asset->numFrames; frameIndex++) {
+				PackedFrame* frame = group->atlas.frames + asset->firstFrame + frameIndex;
+				residency->resources[group->atlas.pageResources[frame->page]].sets |= sets;
+			}
+		}
+
+		for(s32 resourceIndex = 0; resourceIndex < residency->numResources; resourceIndex++) {
+			TextureResource* resource = residency->resources + resourceIndex;
+			if(resource->sets) resource->lastNeeded = residency->generation;
+		}
+	}
+
+	if(residency->streamingResource >= 0 && SDL_SemTryWait(residency->streamDone) == 0) {
+		finishTextureStream(group);
+	}
+
+	for(s32 resourceIndex = 0; resourceIndex < residency->numResources; resourceIndex++) {
+		TextureResource* resource = residency->resources + resourceIndex;
+
+		if(!resource->resident && (resource->sets & (TextureSet_always|TextureSet_currentLevel))) {
+			if(resourceIndex == residency->streamingResource) {
+				SDL_SemWait(residency->streamDone);
+				finishTextureStream(group);
+			} else {
+				evictTextureResources(group, resource->bytes);
+
+				s32 numComponents;
+				void* pixels = decodeTextureResource(group->assets->fileHandle, resource, &numComponents);
+				makeTextureResident(group, resource, pixels, numComponents);
+				stbi_image_free(pixels);
+			}
+		}
+	}
+
+	//NOTE: The next level is only prefetched while it fits in the budget
+	if(residency->streamingResource < 0) {
+		for(s32 resourceIndex = 0; resourceIndex < residency->numResources; resourceIndex++) {
+			TextureResource* resource = residency->resources + resourceIndex;
+
+			if(!resource->resident && resource->sets) {
+				evictTextureResources(group, resource->bytes);
+
+				if(residency->residentBytes + resource->bytes <= residency->budget) {
+					residency->streamingResource = resourceIndex;
+					SDL_SemPost(residency->streamRequest);
+				}
+
+				break;
+			}
+		}
+	}
+}
+
+void loadTextureAtlas(RenderGroup* group, MemoryArena* arena) {
+	TextureAtlas* atlas = &group->atlas;
+
+	FILE* readStream = group->assets->fileHandle;
+	s32 seekResult = fseek(readStream, getAssetPos(group->assets, Asset_textureAtlas), SEEK_SET);
+	assert(seekResult == 0);
+
+	TextureAtlasHeader header;
+	size_t readCount = fread(&header, sizeof(header), 1, readStream);
+	assert(readCount == 1);
+	assert(header.numPages <= MAX_ATLAS_PAGES);
+
+	readCount = fread(atlas->assets, sizeof(PackedAsset), Asset_count, readStream);
+	assert(readCount == Asset_count);
+
+	atlas->frames = pushArray(arena, PackedFrame, header.numFrames);
+	readCount = fread(atlas->frames, sizeof(PackedFrame), header.numFrames, readStream);
+	assert(readCount == (size_t)header.numFrames);
+
+	atlas->numPages = header.numPages;
+
+	for(s32 pageIndex = 0; pageIndex < header.numPages; pageIndex++) {
+		if(group->residency.enabled) {
+			s32 filePos = (s32)ftell(readStream);
+			s32 pageResource = addTextureResource(group, filePos, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, true, false);
+
+			atlas->pageResources[pageIndex] = pageResource;
+			atlas->pages[pageIndex] = group->residency.resources[pageResource].texId;
+
+			s32 pngSize;
+			readCount = fread(&pngSize, sizeof(pngSize), 1, readStream);
+			assert(readCount == 1);
+
+			seekResult = fseek(readStream, pngSize, SEEK_CUR);
+			assert(seekResult == 0);
+			continue;
+		}
+
+		s32 pngSize;
+		readCount = fread(&pngSize, sizeof(pngSize), 1, readStream);
+		assert(readCount == 1);
+
+		u8* png = (u8*)malloc(pngSize);
+		assert(png);
+		readCount = fread(png, pngSize, 1, readStream);
+		assert(readCount == 1);
+
+		int width, height, numComponents;
+		void* pixels = stbi_load_from_memory(png, pngSize, &width, &height, &numComponents, 4);
+		assert(pixels);
+		assert(width == ATLAS_PAGE_SIZE && height == ATLAS_PAGE_SIZE);
+
+		atlas->pages[pageIndex] = createTex(group, width, height, 4, pixels, true).texId;
+
+		stbi_image_free(pixels);
+		free(png);
+	}
+}
+
+//NOTE: This returns NULL if the asset isn't in the texture atlas
+Texture* getAtlasTextures(RenderGroup* group, AssetId id, s32* numFrames = NULL) {
+	Texture* result = NULL;
+	PackedAsset* asset = group->atlas.assets + id;
+
+	if(asset->numFrames) {
+		result = group->textures + *group->texturesCount;
+		*group->texturesCount = *group->texturesCount + asset->numFrames;
+		assert(*group->texturesCount < MAX_TEXTURES);
+
+		V2 frameSize = v2(asset->frameWidth, asset->frameHeight);
+		double invPageSize = 1.0 / ATLAS_PAGE_SIZE;
+
+		for(s32 frameIndex = 0; frameIndex < asset->numFrames; frameIndex++) {
+			PackedFrame* frame = group->atlas.frames + asset->firstFrame + frameIndex;
+			Texture* tex = result + frameIndex;
+
+			assert(frame->page >= 0 && frame->page < group->atlas.numPages);
+			tex->texId = group->atlas.pages[frame->page];
+
+			V2 size = v2(frame->width, frame->height);
+			V2 pageMin = v2(frame->x, frame->y);
+			tex->uv = r2(pageMin * invPageSize, (pageMin + size) * invPageSize);
+
+			V2 trimMin = v2(frame->trimX / frameSize.x, frame->trimY / frameSize.y);
+			tex->trim = r2(trimMin, trimMin + v2(size.x / frameSize.x, size.y / frameSize.y));
+
+			tex->size = frameSize * (1.0 / group->pixelsPerMeter);
+		}
+
+		if(numFrames) *numFrames = asset->numFrames;
+	}
+
+	return result;
+}
+
+//stencil is false by default
+Texture* loadPNGTexture(RenderGroup* group, AssetId id, bool stencil) {
+	s32 numFrames = 0;
+	Texture* result = getAtlasTextures(group, id, &numFrames);
+
+	if(result) {
+		assert(!stencil);
+		assert(numFrames == 1);
+	} else {
+		FILE* readStream = group->assets->fileHandle;
+		s32 filePos = getAssetPos(group->assets, id);
+		s32 seekResult = fseek(readStream, filePos, SEEK_SET);
+		assert(seekResult == 0);
+
+		if(group->residency.enabled) {
+			//NOTE: Only the size of the texture is read here, it is uploaded by updateTextureResidency
+			int width, height, numComponents;
+			s32 infoResult = stbi_info_from_file(readStream, &width, &height, &numComponents);
+			assert(infoResult);
+
+			assert(group->residency.assetResources[id] < 0);
+			s32 resourceIndex = addTextureResource(group, filePos, width, height, false, stencil);
+			group->residency.assetResources[id] = resourceIndex;
+
+			result = group->textures + *group->texturesCount;
+			*group->texturesCount = *group->texturesCount + 1;
+			assert(*group->texturesCount < MAX_TEXTURES);
+
+			*result = {};
+			result->texId = group->residency.resources[resourceIndex].texId;
+			result->uv = r2(v2(0, 0), v2(1, 1));
+			result->trim = result->uv;
+			result->size = v2(width, height) * (1.0 / group->pixelsPerMeter);
+		} else {
+			result = loadPNGTexture(group, readStream, stencil);
+		}
+	}
+
+	return result;
+}
+
+
+SDL_RWops* getFilePtrFromMem(Assets* assets, AssetId id, MemoryArena* arena) {
+	SDL_RWops* readStream = seekToAssetPos(assets, id);
+	s32 assetSize = getAssetSize(assets, id);
+
+	void* mem = pushSize(arena, assetSize);
+	SDL_RWread(readStream, mem, assetSize, 1);
+
+	readStream = SDL_RWFromMem(mem, assetSize);
+	assert(readStream);
+
+	return readStream;
+}
+
+TTF_Font* loadFont(RenderGroup* group, AssetId id, s32 fontSize, MemoryArena* arena) {
+	SDL_RWops* readStream = getFilePtrFromMem(group->assets, id, arena);
+
+	TTF_Font* font = TTF_OpenFontRW(readStream, 0, fontSize);
+
+	if (!font) {
+		//const char* error = TTF_GetError();
+		fprintf(stderr, "Failed to load font with id: %d\n", id);
+		InvalidCodePath;
+	}
+
+	TTF_SetFontHinting(font, TTF_HINTING_LIGHT);
+
+	return font;
+	//return NULL;
+}
+
+CachedFont loadCachedFont(RenderGroup* group, AssetId id, s32 fontSize, double scaleFactor, MemoryArena* arena) {
+	CachedFont result = {};
+	result.font = loadFont(group, id, (s32)round(fontSize * scaleFactor), arena);
+	result.scaleFactor = scaleFactor;
+	result.lineHeight = fontSize / (group->pixelsPerMeter * scaleFactor);
+	return result;
+}
+
+Texture* extractTextures(RenderGroup* group, AssetId id, s32 frameWidth, s32 frameHeight, s32 frameSpacing, s32* numFrames) {
+	Texture* atlasFrames = getAtlasTextures(group, id, numFrames);
+
+	if(atlasFrames) {
+		//NOTE: The frame size has to match the one in globalSpriteSheets
+		assert(group->atlas.assets[id].frameWidth == frameWidth);
+		assert(group->atlas.assets[id].frameHeight == frameHeight);
+		assert(frameSpacing == 0);
+		return atlasFrames;
+	}
+
+	Texture* tex = loadPNGTexture(group, id);
+	
+	s32 texWidth = (s32)(tex->size.x * group->pixelsPerMeter + 0.5);
+	s32 texHeight = (s32)(tex->size.y * group->pixelsPerMeter + 0.5);
+
+	s32 numCols = texWidth / (frameWidth + frameSpacing);
+	s32 numRows = texHeight / (frameHeight + frameSpacing);
+
+	assert(frameWidth > 0);
+	assert(frameHeight > 0);
+
+	//TODO: Add a way to test this
+	//assert(width % numCols == 0);
+	//assert(height % numRows == 0);
+
+	*numFrames = numRows * numCols;
+	Texture* result = tex + 1;
+
+	V2 frameSize = v2((double)(frameWidth + frameSpacing) / (double)texWidth, 
+		(double)(frameHeight + frameSpacing) / (double)texHeight);
+
+	V2 texSize = v2((double)frameWidth / (double)texWidth, (double)frameHeight/(double)texHeight);
+
+	V2 frameOffset = v2(frameSpacing / (double)texWidth, frameSpacing / (double)texHeight) * 0.5;
+
+	V2 dataTexSize = hadamard(texSize, tex->size);
+
+	for (s32 rowIndex = 0; rowIndex < numRows; rowIndex++) {
+		for (s32 colIndex = 0; colIndex < numCols; colIndex++) {
+			s32 textureIndex = colIndex + rowIndex * numCols;
+
+			Texture* data = result + textureIndex;
+			data->texId = tex->texId;
+
+			V2 minCorner = hadamard(v2(colIndex, rowIndex), frameSize) + frameOffset;
+			data->uv = r2(minCorner, minCorner + texSize);
+			data->trim = tex->trim;
+			data->size = dataTexSize;
+		}
+	}
+
+	*group->texturesCount = *group->texturesCount + *numFrames;
+	assert(*group->texturesCount < MAX_TEXTURES);
+
+	return result;
+}
+
+Animation loadAnimation(RenderGroup* group, AssetId id, s32 frameWidth, s32 frameHeight, double secondsPerFrame,
+						bool pingPong) {
+	Animation result = {};
 
 	assert(secondsPerFrame > 0);
 	result.secondsPerFrame = secondsPerFrame;
@@ -334,1282 +1162,3087 @@ Animation loadAnimation(RenderGroup* group, AssetId id, s32 frameWidth, s32 fram
 	result.frameHeight = frameHeight;
 	result.assetId = id;
 
-	return result;
+	return result;
+}
+
+void* loadAssetPixels(RenderGroup* group, AssetId id, s32* width, s32* height) {
+	FILE* readStream = group->assets->fileHandle;
+	s32 seekResult = fseek(readStream, getAssetPos(group->assets, id), SEEK_SET);
+	assert(seekResult == 0);
+
+	int numComponents;
+	void* result = stbi_load_from_file(readStream, width, height, &numComponents, 4);
+	assert(result);
+
+	return result;
+}
+
+//NOTE: This is the sub texture of frame which is inside of delta (from 0 to 1 in the frame)
+Texture getDeltaTexture(Texture* frame, R2 delta) {
+	Texture result = *frame;
+
+	V2 uvSize = getRectSize(frame->uv);
+	result.uv = r2(frame->uv.min + hadamard(delta.min, uvSize), frame->uv.min + hadamard(delta.max, uvSize));
+	result.trim = delta;
+
+	return result;
+}
+
+//NOTE: The frames are blended over the background in linear space, the same as the GPU does with srgb textures
+CompositedAnimation loadCompositedAnimation(RenderGroup* group, AssetId backgroundId, AssetId animId, 
+											s32 frameWidth, s32 frameHeight, double secondsPerFrame, bool pingPong) {
+	CompositedAnimation result = {};
+
+	s32 bgWidth, bgHeight;
+	u8* background = (u8*)loadAssetPixels(group, backgroundId, &bgWidth, &bgHeight);
+	assert(bgWidth == frameWidth && bgHeight == frameHeight);
+
+	s32 sheetWidth, sheetHeight;
+	u8* sheet = (u8*)loadAssetPixels(group, animId, &sheetWidth, &sheetHeight);
+
+	s32 numCols = sheetWidth / frameWidth;
+	s32 numFrames = numCols * (sheetHeight / frameHeight);
+	assert(numFrames > 0 && numFrames <= MAX_COMPOSITED_FRAMES);
+
+	float toLinear[256];
+	for(s32 value = 0; value < 256; value++) {
+		double c = value / 255.0;
+		toLinear[value] = (float)(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+	}
+
+	s32 toSrgbSteps = 4096;
+	u8* toSrgb = (u8*)malloc(toSrgbSteps);
+	assert(toSrgb);
+
+	for(s32 step = 0; step < toSrgbSteps; step++) {
+		double c = step / (double)(toSrgbSteps - 1);
+		c = c <= 0.0031308 ? c * 12.92 : 1.055 * pow(c, 1 / 2.4) - 0.055;
+		toSrgb[step] = (u8)(c * 255 + 0.5);
+	}
+
+	s32 frameSize = frameWidth * frameHeight * 4;
+	u8* frames = (u8*)malloc(frameSize * numFrames);
+	assert(frames);
+
+	result.anim.frames = group->textures + *group->texturesCount;
+	*group->texturesCount = *group->texturesCount + numFrames;
+	assert(*group->texturesCount < MAX_TEXTURES);
+
+	for(s32 frameIndex = 0; frameIndex < numFrames; frameIndex++) {
+		u8* dst = frames + frameIndex * frameSize;
+		s32 sheetX = (frameIndex % numCols) * frameWidth;
+		s32 sheetY = (frameIndex / numCols) * frameHeight;
+
+		for(s32 y = 0; y < frameHeight; y++) {
+			u8* bg = background + y * frameWidth * 4;
+			u8* src = sheet + ((sheetY + y) * sheetWidth + sheetX) * 4;
+			u8* dstRow = dst + y * frameWidth * 4;
+
+			for(s32 x = 0; x < frameWidth * 4; x += 4) {
+				//NOTE: The background isn't always opaque (the game shows through the pause menu), so this is the 
+				//		over operator with straight alpha
+				float bgAlpha = bg[x + 3] / 255.0f;
+				float srcAlpha = src[x + 3] / 255.0f;
+				float alpha = srcAlpha + bgAlpha * (1 - srcAlpha);
+
+				for(s32 channel = 0; channel < 3; channel++) {
+					float c = 0;
+
+					if(alpha > 0) {
+						c = (toLinear[bg[x + channel]] * bgAlpha * (1 - srcAlpha) + 
+							 toLinear[src[x + channel]] * srcAlpha) / alpha;
+					}
+
+					dstRow[x + channel] = toSrgb[(s32)(c * (toSrgbSteps - 1) + 0.5f)];
+				}
+
+				dstRow[x + 3] = (u8)(alpha * 255 + 0.5f);
+			}
+		}
+
+		result.anim.frames[frameIndex] = createTex(group, frameWidth, frameHeight, 4, dst, true);
+	}
+
+	for(s32 frameIndex = 0; frameIndex < numFrames; frameIndex++) {
+		s32 nextIndex = (frameIndex + 1) % numFrames;
+		u32* a = (u32*)(frames + frameIndex * frameSize);
+		u32* b = (u32*)(frames + nextIndex * frameSize);
+
+		s32 minX = frameWidth, minY = frameHeight, maxX = -1, maxY = -1;
+
+		for(s32 y = 0; y < frameHeight; y++) {
+			for(s32 x = 0; x < frameWidth; x++) {
+				if(a[y * frameWidth + x] != b[y * frameWidth + x]) {
+					if(x < minX) minX = x;
+					if(x > maxX) maxX = x;
+					if(y < minY) minY = y;
+					maxY = y;
+				}
+			}
+		}
+
+		if(maxX >= 0) {
+			//NOTE: The delta is grown by a pixel so that the bilinear filtering at its edges still matches
+			minX = max(0, minX - 1);
+			minY = max(0, minY - 1);
+			maxX = min(frameWidth - 1, maxX + 1);
+			maxY = min(frameHeight - 1, maxY + 1);
+
+			R2 delta = r2(v2((double)minX / frameWidth, (double)minY / frameHeight), 
+						  v2((double)(maxX + 1) / frameWidth, (double)(maxY + 1) / frameHeight));
+
+			result.hasDelta[frameIndex] = true;
+			result.deltas[frameIndex] = getDeltaTexture(result.anim.frames + nextIndex, delta);
+			result.reverseDeltas[frameIndex] = getDeltaTexture(result.anim.frames + frameIndex, delta);
+		}
+	}
+
+	result.anim.numFrames = numFrames;
+	result.anim.secondsPerFrame = secondsPerFrame;
+	result.anim.pingPong = pingPong;
+	result.anim.frameWidth = frameWidth;
+	result.anim.frameHeight = frameHeight;
+	result.anim.assetId = animId;
+
+	free(frames);
+	free(toSrgb);
+	stbi_image_free(sheet);
+	stbi_image_free(background);
+
+	return result;
+}
+
+//NOTE: This returns the part of frame to which is different from frame from, or NULL if they are the same
+Texture* getCompositedDelta(CompositedAnimation* composited, Texture* from, Texture* to) {
+	Texture* result = NULL;
+
+	s32 fromIndex = (s32)(from - composited->anim.frames);
+	s32 toIndex = (s32)(to - composited->anim.frames);
+	s32 numFrames = composited->anim.numFrames;
+
+	if(toIndex == (fromIndex + 1) % numFrames) {
+		if(composited->hasDelta[fromIndex]) result = composited->deltas + fromIndex;
+	} 
+	else if(fromIndex == (toIndex + 1) % numFrames) {
+		if(composited->hasDelta[toIndex]) result = composited->reverseDeltas + toIndex;
+	}
+	else if(fromIndex != toIndex) {
+		result = to;
+	}
+
+	return result;
+}
+
+Animation createAnimation(Texture* tex) {
+	Animation result = {};
+	result.secondsPerFrame = 0;
+	result.frames = tex;
+	result.numFrames = 1;
+	return result;
+}
+
+double getAnimationDuration(Animation* animation) {
+	double result = animation->numFrames * animation->secondsPerFrame;
+	return result;
+}
+
+Texture* getAnimationFrame(Animation* animation, double animTime) {
+	bool32 reverse = animation->reverse;
+
+	s32 frameIndex = 0;
+	if (animation->secondsPerFrame > 0) {
+		frameIndex = (s32)(animTime / animation->secondsPerFrame) % animation->numFrames;
+	}
+
+	if(animation->pingPong && animation->numFrames > 1) {
+		double duration = getAnimationDuration(animation);
+
+		if(animTime > duration) {
+			duration -= animation->secondsPerFrame;
+			animTime -= duration;
+
+			frameIndex = (s32)(animTime / animation->secondsPerFrame) % (animation->numFrames - 1);
+
+			s32 numTimesPlayed = (s32)(animTime / duration) + 1;
+
+			if (numTimesPlayed % 2 == 1) {
+				reverse = !reverse;
+			}
+		}
+	}
+
+	
+
+	if (reverse) {
+		frameIndex = (animation->numFrames - 1) - frameIndex;
+	}
+
+	Texture* result = animation->frames + frameIndex;
+	return result;
+}
+
+#ifdef HACKFORMER_GAME
+
+Animation createReversedAnimation(Animation* anim) {
+	Animation result = *anim;
+	result.reverse = !result.reverse;
+	return result;
+}
+
+GlowingTexture* createGlowingTexture(GameState* gameState) {
+	GlowingTexture* result = gameState->glowingTextures + gameState->glowingTexturesCount++;
+	assert(gameState->glowingTexturesCount < MAX_GLOWING_TEXTURES);
+	return result;
+}
+
+AnimNode* createAnimNode(GameState* gameState, AnimNode** anim = NULL) {
+	AnimNode* result = gameState->animNodes + gameState->animNodesCount++;
+	assert(gameState->animNodesCount < MAX_ANIM_NODES);
+	if(anim) *anim = result;
+	return result;
+}
+
+CharacterAnim* createCharacterAnim(GameState* gameState, CharacterAnim** anim = NULL) {
+	CharacterAnim* data = gameState->characterAnims + gameState->characterAnimsCount++;
+	assert(gameState->characterAnimsCount < MAX_CHARACTER_ANIMS);
+	if(anim) *anim = data;
+	return data;
+}
+
+#endif
+
+SDL_Rect getPixelSpaceRect(double pixelsPerMeter, s32 windowHeight, R2 rect) {
+	SDL_Rect result = {};
+
+	double width = getRectWidth(rect);
+	double height = getRectHeight(rect);
+
+	result.w = (s32)ceil(width * pixelsPerMeter);
+	result.h = (s32)ceil(height * pixelsPerMeter);
+	result.x = (s32)ceil(rect.max.x * pixelsPerMeter) - result.w;
+	result.y = windowHeight - (s32)ceil(rect.max.y * pixelsPerMeter);
+
+	return result;
+}
+
+void bindShader(RenderGroup* group, Shader* shader) {
+	group->requestedState.shader = shader;
+	group->stats.stateRequests++;
+}
+
+void setClipRect(RenderGroup* group, R2 rect) {
+	group->requestedState.scissorEnabled = true;
+	group->requestedState.scissorRect = rect;
+	group->stats.stateRequests++;
+}
+
+void disableClipRect(RenderGroup* group) {
+	group->requestedState.scissorEnabled = false;
+	group->stats.stateRequests++;
+}
+
+void applyScissorRect(RenderGroup* group, R2 rect) {
+	double pixelsPerMeter = group->pixelsPerMeter;
+	SceneTarget* target = &group->sceneTarget;
+
+	//NOTE: While a frame is drawn into the scene target, the rect is in the pixels of the target
+	if(target->active) pixelsPerMeter *= (double)target->height / (double)group->windowHeight;
+
+	GLint x = (GLint)(rect.min.x * pixelsPerMeter);
+	GLint y = (GLint)(rect.min.y * pixelsPerMeter);
+	GLsizei width = (GLsizei)(getRectWidth(rect) * pixelsPerMeter);
+	GLsizei height = (GLsizei)(getRectHeight(rect) * pixelsPerMeter);
+
+	#ifdef HACKFORMER_MAC
+	if(!target->active) {
+		x *= 2;
+		y *= 2;
+		width *= 2;
+		height *= 2;
+	}
+	#endif
+
+	glScissor(x, y, width, height);
+}
+
+void applyRenderState(RenderGroup* group) {
+	RenderState* requested = &group->requestedState;
+	RenderState* applied = &group->appliedState;
+
+	assert(requested->shader);
+
+	bool shaderChanged = requested->shader != applied->shader;
+	bool textureChanged = requested->texture != applied->texture;
+	bool scissorToggled = requested->scissorEnabled != applied->scissorEnabled;
+	bool scissorRectChanged = requested->scissorEnabled && 
+							  (requested->scissorRect.min != applied->scissorRect.min || 
+							   requested->scissorRect.max != applied->scissorRect.max);
+
+	bool forwardShaderBound = requested->shader == &group->forwardShader.shader;
+	bool ambientChanged = forwardShaderBound && requested->ambient != applied->ambient;
+	bool cameraOffsetChanged = forwardShaderBound && requested->cameraOffset != applied->cameraOffset;
+	bool glowTimeChanged = forwardShaderBound && requested->glowTime != applied->glowTime;
+	bool forwardUniformsChanged = ambientChanged || cameraOffsetChanged || glowTimeChanged;
+
+	if(shaderChanged || textureChanged || scissorToggled || scissorRectChanged || forwardUniformsChanged) {
+		flushBatch(group);
+
+		//NOTE: The other backends read the applied state when the batch is flushed
+		bool gl = group->backend == RenderBackend_gl;
+
+		if(shaderChanged) {
+			if(gl) glUseProgram(requested->shader->program);
+			group->stats.stateChanges++;
+		}
+
+		if(textureChanged) {
+			if(gl) glBindTexture(GL_TEXTURE_2D, requested->texture);
+			group->stats.stateChanges++;
+		}
+
+		if(scissorToggled) {
+			if(gl) {
+				if(requested->scissorEnabled) glEnable(GL_SCISSOR_TEST);
+				else glDisable(GL_SCISSOR_TEST);
+			}
+			group->stats.stateChanges++;
+		}
+
+		if(scissorRectChanged) {
+			if(gl) applyScissorRect(group, requested->scissorRect);
+			group->stats.stateChanges++;
+		}
+
+		if(ambientChanged) {
+			GLfloat ambient = requested->ambient;
+			if(gl) glUniform3f(group->forwardShader.ambientUniform, ambient, ambient, ambient);
+			group->stats.stateChanges++;
+		}
+
+		if(cameraOffsetChanged) {
+			V2 offset = requested->cameraOffset;
+			if(gl) glUniform2f(group->forwardShader.cameraOffsetUniform, (GLfloat)offset.x, (GLfloat)offset.y);
+			group->stats.stateChanges++;
+		}
+
+		if(glowTimeChanged) {
+			if(gl) glUniform1f(group->forwardShader.glowTimeUniform, requested->glowTime);
+			group->stats.stateChanges++;
+		}
+
+		RenderState newApplied = *requested;
+		if(!ambientChanged) newApplied.ambient = applied->ambient;
+		if(!cameraOffsetChanged) newApplied.cameraOffset = applied->cameraOffset;
+		if(!glowTimeChanged) newApplied.glowTime = applied->glowTime;
+		if(!requested->scissorEnabled) newApplied.scissorRect = applied->scissorRect;
+
+		*applied = newApplied;
+	}
+}
+
+Texture createText(RenderGroup* group, TTF_Font* font, char* msg) {
+	SDL_Color fontColor = {0, 0, 0, 255};
+	SDL_Surface* fontSurface = TTF_RenderText_Blended(font, msg, fontColor);
+
+	Texture result = createTexFromSurface(fontSurface, group, false);
+
+	return result;
+}
+
+//NOTE: The glyphs are separated by a transparent pixel so that they don't bleed into each other
+Texture addGlyphToPage(CachedFont* cachedFont, RenderGroup* group, SDL_Surface* glyphSurface) {
+	acquireRenderResources(group);
+
+	s32 width = glyphSurface->w;
+	s32 height = glyphSurface->h;
+
+	assert(width + 1 <= GLYPH_PAGE_SIZE && height + 1 <= GLYPH_PAGE_SIZE);
+	assert(glyphSurface->format->BytesPerPixel == 4);
+
+	if(cachedFont->glyphPageX + width + 1 > GLYPH_PAGE_SIZE) {
+		cachedFont->glyphPageX = 0;
+		cachedFont->glyphPageY += cachedFont->glyphPageRowHeight;
+		cachedFont->glyphPageRowHeight = 0;
+	}
+
+	if(!cachedFont->glyphPage || cachedFont->glyphPageY + height + 1 > GLYPH_PAGE_SIZE) {
+		void* emptyPixels = calloc(GLYPH_PAGE_SIZE * GLYPH_PAGE_SIZE, sizeof(u32));
+		assert(emptyPixels);
+
+		cachedFont->glyphPage = createTex(group, GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE, 4, emptyPixels, true).texId;
+		cachedFont->glyphPageX = cachedFont->glyphPageY = 0;
+		cachedFont->glyphPageRowHeight = 0;
+
+		free(emptyPixels);
+	}
+
+	s32 x = cachedFont->glyphPageX;
+	s32 y = cachedFont->glyphPageY;
+
+	if(group->backend == RenderBackend_gl) {
+		//NOTE: The pending quads have to be drawn before the texture binding is changed
+		flushBatch(group);
+
+		glBindTexture(GL_TEXTURE_2D, cachedFont->glyphPage);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, glyphSurface->pitch / 4);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, glyphSurface->pixels);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		group->appliedState.texture = cachedFont->glyphPage;
+	}
+	else if(group->backend == RenderBackend_software) {
+		updateSoftwareTexture(group->software, cachedFont->glyphPage, x, y, width, height, 
+							  glyphSurface->pixels, glyphSurface->pitch);
+	}
+
+	cachedFont->glyphPageX += width + 1;
+	cachedFont->glyphPageRowHeight = max(cachedFont->glyphPageRowHeight, height + 1);
+
+	Texture result = {};
+	result.texId = cachedFont->glyphPage;
+
+	V2 pageMin = v2(x, y) * (1.0 / GLYPH_PAGE_SIZE);
+	result.uv = r2(pageMin, pageMin + v2(width, height) * (1.0 / GLYPH_PAGE_SIZE));
+	result.trim = r2(v2(0, 0), v2(1, 1));
+	result.size = v2(width, height) * (1.0 / group->pixelsPerMeter);
+
+	return result;
+}
+
+Glyph* getGlyph(CachedFont* cachedFont, RenderGroup* group, char c, double metersPerPixel) {
+	if (!cachedFont->cache[c].tex.texId) {	
+		SDL_Color white = {255, 255, 255, 255};
+
+		SDL_Surface* glyphSurface = TTF_RenderGlyph_Blended(cachedFont->font, c, white);
+		assert(glyphSurface);
+
+		SDL_PixelFormat* format = glyphSurface->format;
+		s32 maxX = 0, minX = glyphSurface->w - 1, maxY = 0, minY = glyphSurface->h - 1;
+	
+	for(s32 y = 0; y < glyphSurface->h; y++) {
+			for(s32 x = 0; x < glyphSurface->w; x++) {
+				void* pixelPtr = (u8*)glyphSurface->pixels + x * format->BytesPerPixel + y * glyphSurface->pitch; 
+				assert(format->BytesPerPixel == 4);
+
+				u32 pixel = *(u32*)pixelPtr;
+				u32 alpha = pixel & format-> Amask;
+
+				if(alpha) {
+					if(x > maxX) maxX = x;
+					if (x < minX) minX = x;
+					if(y > maxY) maxY = y;
+					if(y < minY) minY = y;
+				}
+			}
+		}
+
+		cachedFont->cache[c].padding.max.y = minY * metersPerPixel;
+		cachedFont->cache[c].padding.min.y = ((glyphSurface->h - 1) * metersPerPixel) - (maxY * metersPerPixel);
+		cachedFont->cache[c].padding.max.x = minX * metersPerPixel;
+		cachedFont->cache[c].padding.min.x = ((glyphSurface->w - 1) * metersPerPixel) - (maxX * metersPerPixel);
+
+		cachedFont->cache[c].tex = addGlyphToPage(cachedFont, group, glyphSurface);
+		SDL_FreeSurface(glyphSurface);
+		assert(cachedFont->cache[c].tex.texId);
+	}
+
+	Glyph* result = cachedFont->cache + c;
+	return result;
+}
+
+double getTextWidth(CachedFont* cachedFont, RenderGroup* group, char* msg) {
+	double result = 0;
+
+	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
+	double invScaleFactor = 1.0 / cachedFont->scaleFactor;
+
+	while(*msg) {
+		result += getGlyph(cachedFont, group, *msg, metersPerPixel)->tex.size.x * invScaleFactor;
+		msg++;
+	}
+
+	return result;
+}
+
+double getTextHeight(CachedFont* cachedFont, RenderGroup* group, char* msg) {
+	double result = 0;
+
+	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
+	double invScaleFactor = 1.0 / cachedFont->scaleFactor;
+
+	while(*msg) {
+		Glyph* glyph = getGlyph(cachedFont, group, *msg, metersPerPixel);
+		double glyphHeight = glyph->tex.size.y * invScaleFactor - glyph->padding.min.y - glyph->padding.max.y;
+		if(glyphHeight > result) result = glyphHeight;
+
+		msg++;
+	}
+
+	return result;
+}
+
+V2 getTextSize(CachedFont* cachedFont, RenderGroup* group, char* msg) {
+	V2 result = v2(getTextWidth(cachedFont, group, msg), getTextHeight(cachedFont, group, msg));
+	return result;
+}
+
+R2 getTextPadding(CachedFont* cachedFont, RenderGroup* group, char* msg) {
+	R2 result = {v2(-1, -1), v2(-1, -1)};
+
+	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
+
+	while(char c = *msg++) {
+		Glyph* glyph = getGlyph(cachedFont, group, c, metersPerPixel);
+
+		if(result.min.x < 0 || glyph->padding.min.x < result.min.x) result.min.x = glyph->padding.min.x;
+		if(result.max.x < 0 || glyph->padding.max.x < result.max.x) result.max.x = glyph->padding.max.x;
+		if(result.min.y < 0 || glyph->padding.min.y < result.min.y) result.min.y = glyph->padding.min.y;
+		if(result.max.y < 0 || glyph->padding.max.y < result.max.y) result.max.y = glyph->padding.max.y;
+	}
+
+	if(result.min.x < 0) result.min.x = 0;
+	if(result.max.x < 0) result.max.x = 0;
+	if(result.min.y < 0) result.min.y = 0;
+	if(result.max.y < 0) result.max.y = 0;
+
+	return result;
+}
+
+bool validTexture(Texture* texture) {
+	bool result = texture && texture->texId;
+	return result;
+}
+
+char* getRenderBlockData(RenderBlock* block) {
+	char* result = (char*)(block + 1);
+	return result;
+}
+
+RenderBlock* getRenderBlock(RenderGroup* group, size_t minSize) {
+	RenderBlock* result = NULL;
+
+	SDL_AtomicLock(&group->freeBlocksLock);
+
+	for(RenderBlock** blockPtr = &group->freeBlocks; *blockPtr; blockPtr = &(*blockPtr)->next) {
+		if((*blockPtr)->size >= minSize) {
+			result = *blockPtr;
+			*blockPtr = result->next;
+			break;
+		}
+	}
+
+	SDL_AtomicUnlock(&group->freeBlocksLock);
+
+	if(!result) {
+		size_t size = max(minSize, (size_t)RENDER_BLOCK_SIZE);
+		result = (RenderBlock*)malloc(sizeof(RenderBlock) + size);
+		assert(result);
+		result->size = size;
+	}
+
+	result->used = 0;
+	result->next = NULL;
+
+	return result;
+}
+
+void freeRenderBlocks(RenderGroup* group, RenderBlock* firstBlock, RenderBlock* lastBlock) {
+	if(firstBlock) {
+		SDL_AtomicLock(&group->freeBlocksLock);
+
+		lastBlock->next = group->freeBlocks;
+		group->freeBlocks = firstBlock;
+
+		SDL_AtomicUnlock(&group->freeBlocksLock);
+	}
+}
+
+RenderGroup* createRenderGroup(size_t size, MemoryArena* arena, double pixelsPerMeter, s32 windowWidth, s32 windowHeight, 
+								Camera* camera, Texture* textures, s32* texturesCount, Assets* assets, 
+								RenderBackend backend = RenderBackend_gl, char* programCachePath = NULL,
+								size_t textureBudget = 0) {
+	RenderGroup* result = pushStruct(arena, RenderGroup);
+
+	result->backend = backend;
+
+	//NOTE: The block pool starts out with enough blocks for size bytes of elements, it grows if that isn't enough
+	for(size_t blockIndex = 0; blockIndex < size / RENDER_BLOCK_SIZE; blockIndex++) {
+		RenderBlock* block = getRenderBlock(result, RENDER_BLOCK_SIZE);
+		freeRenderBlocks(result, block, block);
+	}
+
+	result->frame = result->frames;
+	result->pixelsPerMeter = pixelsPerMeter;
+	result->windowWidth = windowWidth;
+	result->windowHeight = windowHeight;
+
+	V2 windowSize = v2(windowWidth, windowHeight) * (1.0 / pixelsPerMeter);
+
+	result->windowBounds = r2(v2(0, 0), windowSize);
+	result->camera = camera;
+	result->textures = textures;
+	result->texturesCount = texturesCount;
+
+	result->assets = assets;
+
+	result->defaultClipRect = result->windowBounds;
+
+	if(backend == RenderBackend_gl) {
+		u64 shaderStartTime = SDL_GetPerformanceCounter();
+
+		ProgramCache programCache;
+		initProgramCache(&programCache, programCachePath);
+
+		result->forwardShader = createForwardShader(result, &programCache, windowSize);
+		result->basicShader = createShader(result, &programCache, Asset_basicVS, Asset_basicFS, windowSize);
+		result->stencilShader = createShader(result, &programCache, Asset_basicVS, Asset_stencilFS, windowSize);
+		result->upscaleShader = createShader(result, &programCache, Asset_basicVS, Asset_upscaleFS, windowSize);
+
+		closeProgramCache(&programCache);
+
+		result->shaderStartup.seconds = (double)(SDL_GetPerformanceCounter() - shaderStartTime) / 
+										(double)SDL_GetPerformanceFrequency();
+
+		initBatch(result);
+		initLightTiles(result);
+
+		//NOTE: A budget of 0 keeps every texture resident
+		if(textureBudget) initTextureResidency(result, textureBudget);
+	} 
+	else if(backend == RenderBackend_software) {
+		initSoftwareRenderer(result);
+	}
+
+	result->buildingStaticMesh = -1;
+
+	loadTextureAtlas(result, arena);
+	result->whiteTex = loadPNGTexture(result, Asset_white, false);
+
+	return result;
+}
+
+V2 getTexCoord(V2 uvMin, V2 uvMax, s32 orientation) {
+	V2 result = {};
+
+	switch(orientation) {
+		case Orientation_0: {
+			result = uvMax;
+		} break;
+
+		case Orientation_90: {
+			result = v2(uvMin.x, uvMax.y);
+		} break;
+
+		case Orientation_180: {
+			result = uvMin;
+		} break;
+
+		case Orientation_270: {
+			result = v2(uvMax.x, uvMin.y);
+		} break;
+
+		InvalidDefaultCase;		
+	}
+
+	return result;
+}
+
+void bindTexture(Texture* texture, RenderGroup* group) {
+	assert(validTexture(texture));
+
+	group->requestedState.texture = texture->texId;
+	group->stats.stateRequests++;
+}
+
+void setAmbient(RenderGroup* group, GLfloat ambient) {
+	group->requestedState.ambient = ambient;
+	group->stats.stateRequests++;
+}
+
+//NOTE: p are the corners of the whole frame and frameP are their positions in the frame (either 0 or 1).
+//		If the texture was trimmed, the quad is shrunk down to the part of the frame which is stored in the texture.
+void getTextureQuad(Texture* texture, V2* p, V2* frameP, V2* quadP, V2* uv) {
+	V2 uvSize = getRectSize(texture->uv);
+	V2 trimSize = getRectSize(texture->trim);
+	bool trimmed = texture->trim.min != v2(0, 0) || texture->trim.max != v2(1, 1);
+
+	V2 origin = {}, xAxis = {}, yAxis = {};
+
+	if(trimmed) {
+		for(s32 pIndex = 0; pIndex < 4; pIndex++) {
+			if(frameP[pIndex] == v2(0, 0)) origin = p[pIndex];
+		}
+
+		for(s32 pIndex = 0; pIndex < 4; pIndex++) {
+			if(frameP[pIndex] == v2(1, 0)) xAxis = p[pIndex] - origin;
+			if(frameP[pIndex] == v2(0, 1)) yAxis = p[pIndex] - origin;
+		}
+	}
+
+	for(s32 pIndex = 0; pIndex < 4; pIndex++) {
+		uv[pIndex] = texture->uv.min + hadamard(frameP[pIndex], uvSize);
+
+		if(trimmed) {
+			V2 trimmedFrameP = texture->trim.min + hadamard(frameP[pIndex], trimSize);
+			quadP[pIndex] = origin + xAxis * trimmedFrameP.x + yAxis * trimmedFrameP.y;
+		} else {
+			quadP[pIndex] = p[pIndex];
+		}
+	}
+}
+
+void addTextureQuad(RenderGroup* group, Texture* texture, V2* p, V2* frameP, Color color, float emissivity) {
+	V2 quadP[4];
+	V2 uv[4];
+	getTextureQuad(texture, p, frameP, quadP, uv);
+
+	addQuadToBatch(group, quadP, uv, color, emissivity);
+}
+
+void getBoundedTextureCorners(R2 bounds, bool flipX, bool flipY, Orientation orientation, V2* p, V2* frameP) {
+	V2 frameMin = v2(0, 0);
+	V2 frameMax = v2(1, 1);
+
+	if (!flipX) {
+		swap(frameMin.x, frameMax.x);
+	}
+
+	if(flipY) {
+		swap(frameMin.y, frameMax.y);
+	}
+
+	p[0] = bounds.min;
+	p[1] = v2(bounds.max.x, bounds.min.y);
+	p[2] = bounds.max;
+	p[3] = v2(bounds.min.x, bounds.max.y);
+
+	for(s32 pIndex = 0; pIndex < 4; pIndex++) {
+		frameP[pIndex] = getTexCoord(frameMin, frameMax, (orientation + pIndex) % Orientation_count);
+	}
+}
+
+void drawTexture(RenderGroup* group, Texture* texture, R2 bounds, bool flipX, bool flipY, Orientation orientation, float emissivity, 
+				 Color color) {
+	bindTexture(texture, group);
+
+	V2 p[4], frameP[4];
+	getBoundedTextureCorners(bounds, flipX, flipY, orientation, p, frameP);
+
+	addTextureQuad(group, texture, p, frameP, color, emissivity);
+}
+
+void drawTexture(RenderGroup* group, Texture* texture, R2 bounds, double rot, Color color, bool flipX, bool flipY, float emissivity) {
+	bindTexture(texture, group);
+
+	V2 frameMin = v2(0, 0);
+	V2 frameMax = v2(1, 1);
+
+	if (!flipX) {
+		swap(frameMin.x, frameMax.x);
+	}
+
+	if(flipY) {
+		swap(frameMin.y, frameMax.y);
+	}
+
+	V2 center = getRectCenter(bounds);
+
+	V2 originRelativeMin = bounds.min - center;
+	V2 originRelativeMax = bounds.max - center;
+
+	V2 originRelativeP2 = v2(originRelativeMax.x, originRelativeMin.y);
+	V2 originRelativeP3 = v2(originRelativeMin.x, originRelativeMax.y);
+
+	V2 p[4];
+
+	p[0] = rotate(originRelativeMin, rot) + center;
+	p[1] = rotate(originRelativeP2, rot) + center;
+	p[2] = rotate(originRelativeMax, rot) + center;
+	p[3] = rotate(originRelativeP3, rot) + center;
+
+	V2 frameP[4];
+
+	for(s32 pIndex = 0; pIndex < arrayCount(frameP); pIndex++) {
+		frameP[pIndex] = getTexCoord(frameMin, frameMax, pIndex);
+	}
+
+	addTextureQuad(group, texture, p, frameP, color, emissivity);
+}
+
+void drawFilledStencil(RenderGroup* group, Texture* stencil, R2 bounds, double widthPercentage, Color color) {
+	double uvWidth = getRectWidth(stencil->uv);
+	uvWidth *= widthPercentage;
+
+	double uMax = stencil->uv.min.x + uvWidth;
+
+	V2 uvMax = v2(uMax, stencil->uv.max.y);
+	V2 uvMin = stencil->uv.min;
+
+	Shader* oldShader = group->requestedState.shader;
+	bindShader(group, &group->stencilShader);
+
+	bindTexture(stencil, group);
+
+	V2 p[4];
+	p[0] = bounds.min;
+	p[1] = v2(bounds.max.x, bounds.min.y);
+	p[2] = bounds.max;
+	p[3] = v2(bounds.min.x, bounds.max.y);
+
+	V2 uv[4];
+	uv[0] = v2(uvMin.x, uvMax.y);
+	uv[1] = uvMax;
+	uv[2] = v2(uvMax.x, uvMin.y);
+	uv[3] = uvMin;
+
+	addQuadToBatch(group, p, uv, color, 0);
+
+	bindShader(group, oldShader);
+}
+
+void drawText(RenderGroup* group, CachedFont* cachedFont, char* msg, V2 p, Color color) {
+	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
+	double invScaleFactor = 1.0 / cachedFont->scaleFactor;
+
+	while(*msg) {
+		Texture* texture = &getGlyph(cachedFont, group, *msg, metersPerPixel)->tex;
+		V2 size = texture->size * invScaleFactor;
+		R2 bounds = r2(p, p + size);
+
+		drawTexture(group, texture, bounds, false, false, Orientation_0, 0, color);
+
+		p.x += size.x;
+		msg++;
+	}
+}
+
+void drawFillQuad(RenderGroup* group, V2 p1, V2 p2, V2 p3, V2 p4, Color color) {
+	bindTexture(group->whiteTex, group);
+
+	//NOTE: The white texture can be in the atlas, so only its center is sampled
+	V2 whiteUv = getRectCenter(group->whiteTex->uv);
+
+	V2 p[4] = {p1, p2, p3, p4};
+	V2 uv[4] = {whiteUv, whiteUv, whiteUv, whiteUv};
+
+	addQuadToBatch(group, p, uv, color, 0);
+}
+
+void beginStaticMesh(RenderGroup* group, s32 meshIndex) {
+	assert(group->buildingStaticMesh == -1);
+	acquireRenderResources(group);
+	assert(meshIndex >= 0 && meshIndex < MAX_STATIC_MESHES);
+
+	StaticMesh* mesh = group->staticMeshes + meshIndex;
+	mesh->numQuads = 0;
+	mesh->numRuns = 0;
+
+	group->buildingStaticMesh = meshIndex;
+}
+
+//NOTE: The bounds are in world space
+void addStaticMeshTexture(RenderGroup* group, Texture* texture, R2 bounds, bool flipX, bool flipY, float emissivity, Color color) {
+	assert(group->buildingStaticMesh >= 0);
+	assert(validTexture(texture));
+
+	StaticMesh* mesh = group->staticMeshes + group->buildingStaticMesh;
+	assert(mesh->numQuads < MAX_STATIC_MESH_QUADS);
+
+	StaticMeshRun* run = mesh->numRuns ? mesh->runs + mesh->numRuns - 1 : NULL;
+
+	if(!run || run->texture != texture->texId) {
+		assert(mesh->numRuns < MAX_STATIC_MESH_RUNS);
+		run = mesh->runs + mesh->numRuns++;
+		run->texture = texture->texId;
+		run->firstQuad = mesh->numQuads;
+		run->numQuads = 0;
+	}
+
+	V2 p[4], frameP[4];
+	getBoundedTextureCorners(bounds, flipX, flipY, Orientation_0, p, frameP);
+
+	V2 quadP[4], uv[4];
+	getTextureQuad(texture, p, frameP, quadP, uv);
+
+	writeQuadVertices(group->staticMeshVertices + mesh->numQuads * 4, quadP, uv, color, emissivity);
+
+	mesh->numQuads++;
+	run->numQuads++;
+}
+
+void endStaticMesh(RenderGroup* group) {
+	assert(group->buildingStaticMesh >= 0);
+	StaticMesh* mesh = group->staticMeshes + group->buildingStaticMesh;
+	group->buildingStaticMesh = -1;
+
+	if(group->backend != RenderBackend_gl) {
+		size_t verticesSize = mesh->numQuads * 4 * sizeof(BatchVertex);
+		mesh->vertices = (BatchVertex*)realloc(mesh->vertices, max(verticesSize, sizeof(BatchVertex)));
+		assert(mesh->vertices);
+		memcpy(mesh->vertices, group->staticMeshVertices, verticesSize);
+		return;
+	}
+
+	if(!mesh->vertexArray) {
+		glGenVertexArrays(1, &mesh->vertexArray);
+		glBindVertexArray(mesh->vertexArray);
+
+		glGenBuffers(1, &mesh->vertexBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, mesh->vertexBuffer);
+
+		setupVertexAttributes();
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, group->indexBuffer);
+
+		glBindVertexArray(group->vertexArray);
+	} else {
+		glBindBuffer(GL_ARRAY_BUFFER, mesh->vertexBuffer);
+	}
+
+	glBufferData(GL_ARRAY_BUFFER, mesh->numQuads * 4 * sizeof(BatchVertex), group->staticMeshVertices, GL_STATIC_DRAW);
+
+	//NOTE: flushBatch expects the streamed vertex buffer to be bound
+	glBindBuffer(GL_ARRAY_BUFFER, group->vertexBuffer);
+}
+
+void drawStaticMesh(RenderGroup* group, s32 meshIndex, V2 cameraP) {
+	StaticMesh* mesh = group->staticMeshes + meshIndex;
+	assert(group->requestedState.shader == &group->forwardShader.shader);
+
+	//NOTE: The batched quads are drawn first since they were pushed before the mesh
+	flushBatch(group);
+
+	group->requestedState.cameraOffset = cameraP;
+	group->stats.stateRequests++;
+
+	bool gl = group->backend == RenderBackend_gl;
+	if(gl) glBindVertexArray(mesh->vertexArray);
+
+	for(s32 runIndex = 0; runIndex < mesh->numRuns; runIndex++) {
+		StaticMeshRun* run = mesh->runs + runIndex;
+
+		group->requestedState.texture = run->texture;
+		group->stats.stateRequests++;
+		applyRenderState(group);
+
+		if(gl) {
+			glDrawElements(GL_TRIANGLES, run->numQuads * 6, GL_UNSIGNED_SHORT, (void*)(run->firstQuad * 6 * sizeof(u16)));
+		} 
+		else if(group->backend == RenderBackend_software) {
+			addSoftwareQuads(group, mesh->vertices + run->firstQuad * 4, run->numQuads);
+		}
+
+		group->stats.drawCalls++;
+		group->stats.quads += run->numQuads;
+	}
+
+	if(gl) glBindVertexArray(group->vertexArray);
+
+	group->requestedState.cameraOffset = v2(0, 0);
+	group->stats.stateRequests++;
+}
+
+void drawFillRect(RenderGroup* group, R2 bounds, Color color) {
+	drawFillQuad(group, bounds.min, v2(bounds.max.x, bounds.min.y), bounds.max, v2(bounds.min.x, bounds.max.y), color);
+}
+
+void drawOutlinedRect(RenderGroup* group, R2 rect, Color color, double thickness) {
+	V2 halfThickness = v2(thickness, thickness) * 0.5;
+
+	V2 bottomMinCorner = rect.min - halfThickness;
+	V2 bottomMaxCorner = v2(rect.max.x, rect.min.y) + halfThickness;
+
+	V2 topMinCorner = v2(rect.min.x, rect.max.y) - halfThickness;
+	V2 topMaxCorner = rect.max + halfThickness;
+
+	V2 leftMinCorner = bottomMinCorner + v2(0, thickness);
+	V2 leftMaxCorner = topMinCorner + v2(thickness, 0);
+
+	V2 rightMinCorner = bottomMaxCorner - v2(thickness, 0);
+	V2 rightMaxCorner = topMaxCorner - v2(0, thickness);
+
+	drawFillRect(group, r2(bottomMinCorner, bottomMaxCorner), color);
+	drawFillRect(group, r2(topMinCorner, topMaxCorner), color);
+	drawFillRect(group, r2(leftMinCorner, leftMaxCorner), color);
+	drawFillRect(group, r2(rightMinCorner, rightMaxCorner), color);
+}
+
+void drawDashedLine(RenderGroup* group, Color color, V2 lineStart, V2 lineEnd,
+					 double thickness, double dashSize, double spaceSize) {
+	if((lineStart.x > lineEnd.x) || (lineStart.x == lineEnd.x && lineStart.y > lineEnd.y)) {
+		swap(lineStart, lineEnd);
+	}
+
+	V2 dir = normalize(lineEnd - lineStart);
+	V2 normal = perp(dir) * thickness;
+
+	V2 dashSkip = dashSize * dir;
+	V2 spaceSkip = spaceSize * dir;
+
+	V2 start = lineStart;
+
+	while(true) {
+		bool doneDrawing = false;
+		V2 end = start + dashSkip;
+
+		if(end.x > lineEnd.x || (lineStart.x == lineEnd.x && end.y > lineEnd.y)) {
+			doneDrawing = true;
+			end = lineEnd;
+		}
+
+		if((dashSkip.y > 0 && end.y > lineEnd.y) || (dashSkip.y < 0 && end.y < lineEnd.y)) {
+			doneDrawing = true;
+			end = lineEnd;
+		}
+
+		V2 p1 = start + normal;
+		V2 p2 = start - normal;
+		V2 p3 = end - normal;
+		V2 p4 = end + normal;
+
+		drawFillQuad(group, p1, p2, p3, p4, color);
+
+		if(doneDrawing) break;
+
+		start = end + spaceSkip;
+	}
+}
+
+DrawType getRenderHeaderType(RenderHeader* header) {
+	DrawType result = (DrawType)(header->type_ & RENDER_HEADER_TYPE_MASK);
+	return result;
+}
+
+bool32 renderElemClipRect(RenderHeader* header) {
+	bool32 result = header->type_ & RENDER_HEADER_CLIP_RECT_FLAG;
+	return result;
+}
+
+void setRenderElemClipRect(RenderHeader* header) {
+	header->type_ |= RENDER_HEADER_CLIP_RECT_FLAG;
+}
+
+//NOTE: This maps a float onto an unsigned integer which has the same ordering
+u32 getSortableFloatBits(float value) {
+	u32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	u32 result = (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+	return result;
+}
+
+//NOTE: This is the key of an element which isn't a texture or console field, they are drawn in the order they were pushed
+u64 createRenderSortKey() {
+	u64 result = (u64)1 << 63;
+	return result;
+}
+
+u64 createRenderSortKey(DrawOrder drawOrder, double minY, GLuint texId) {
+	assert(drawOrder >= 0 && drawOrder < (1 << RENDER_SORT_KEY_DRAW_ORDER_BITS));
+	assert(texId < (1 << RENDER_SORT_KEY_TEXTURE_BITS));
+
+	u64 y = getSortableFloatBits((float)minY) >> (32 - RENDER_SORT_KEY_Y_BITS);
+
+	u64 result = (u64)texId;
+	result |= y << RENDER_SORT_KEY_TEXTURE_BITS;
+	result |= (u64)drawOrder << (RENDER_SORT_KEY_TEXTURE_BITS + RENDER_SORT_KEY_Y_BITS);
+
+	return result;
+}
+
+//NOTE: The elements are pushed into frame. This is group->frame, unless the element is pushed by a worker thread,
+//		which pushes into its own frame that is merged into the group's frame afterwards (see mergeRenderFrame).
+
+//NOTE: This has to be called right after the element was pushed
+void setRenderElemSortKey(RenderGroup* group, RenderFrame* frame, DrawOrder drawOrder, double minY, Texture* texture) {
+	if(!frame->sortEnded && !group->recordingField) {
+		s32 pushIndex = frame->numSortPtrs - 1;
+		assert(pushIndex >= 0);
+
+		GLuint texId = texture ? texture->texId : 0;
+		frame->sortKeys[pushIndex] = createRenderSortKey(drawOrder, minY, texId);
+	}
+}
+
+//NOTE: The elements of a console field are culled along with the field, since they are cached
+bool isRenderBoundsVisible(RenderGroup* group, RenderFrame* frame, R2 bounds) {
+	bool result = group->recordingField || rectanglesOverlap(group->windowBounds, bounds);
+	if(!result) frame->cullStats.elementsCulled++;
+	return result;
+}
+
+//NOTE: A console field has to be in the same block as its elements, so if one is being recorded it is moved into 
+//		the new block along with the elements it has so far
+RenderBlock* addRenderBlock(RenderGroup* group, RenderFrame* frame, size_t size) {
+	RenderBlock* lastBlock = frame->lastBlock;
+	size_t movedSize = 0;
+
+	if(group->recordingField) {
+		assert(lastBlock);
+		movedSize = lastBlock->used - group->recordingFieldOffset;
+	}
+
+	RenderBlock* result = getRenderBlock(group, movedSize + size);
+
+	if(movedSize) {
+		char* src = getRenderBlockData(lastBlock) + group->recordingFieldOffset;
+		char* dst = getRenderBlockData(result);
+
+		memcpy(dst, src, movedSize);
+		result->used = movedSize;
+		lastBlock->used = group->recordingFieldOffset;
+
+		group->recordingField = (RenderConsoleField*)(dst + ((char*)group->recordingField - src));
+		group->recordingFieldOffset = 0;
+
+		//NOTE: The field is the last sorted element, unless it was pushed after pushSortEnd
+		if(frame->numSortPtrs && (char*)frame->sortPtrs[frame->numSortPtrs - 1] == src) {
+			frame->sortPtrs[frame->numSortPtrs - 1] = (RenderHeader*)dst;
+		}
+	}
+
+	if(lastBlock) lastBlock->next = result;
+	else frame->firstBlock = result;
+
+	frame->lastBlock = result;
+
+	return result;
+}
+
+void growSortArrays(u64** keys, RenderHeader*** ptrs, s32* maxCount, s32 minCount) {
+	if(*maxCount < minCount) {
+		s32 newMaxCount = max(*maxCount * 2, INITIAL_SORTED_RENDER_ELEMS);
+		newMaxCount = max(newMaxCount, minCount);
+
+		*keys = (u64*)realloc(*keys, newMaxCount * sizeof(u64));
+		*ptrs = (RenderHeader**)realloc(*ptrs, newMaxCount * sizeof(RenderHeader*));
+		assert(*keys && *ptrs);
+
+		*maxCount = newMaxCount;
+	}
 }
 
-Animation createAnimation(Texture* tex) {
-	Animation result = {};
-	result.secondsPerFrame = 0;
-	result.frames = tex;
-	result.numFrames = 1;
+size_t getRenderHeaderSize(RenderGroup* group) {
+	size_t result = sizeof(RenderHeader);
+	if(group->hasClipRect) result += sizeof(R2);
 	return result;
 }
 
-double getAnimationDuration(Animation* animation) {
-	double result = animation->numFrames * animation->secondsPerFrame;
+void* pushRenderSize(RenderGroup* group, RenderFrame* frame, size_t size) {
+	RenderBlock* block = frame->lastBlock;
+
+	if(!block || block->used + size > block->size) {
+		block = addRenderBlock(group, frame, size);
+	}
+
+	void* result = getRenderBlockData(block) + block->used;
+	block->used += size;
+
 	return result;
 }
 
-Texture* getAnimationFrame(Animation* animation, double animTime) {
-	bool32 reverse = animation->reverse;
+#define pushRenderElement(group, frame, type) (type*)pushRenderElement_(group, frame, DrawType_##type, sizeof(type))
+void* pushRenderElement_(RenderGroup* group, RenderFrame* frame, DrawType type, size_t size) {
+	size_t headerBytes = getRenderHeaderSize(group);
+	size += headerBytes;
 
-	s32 frameIndex = 0;
-	if (animation->secondsPerFrame > 0) {
-		frameIndex = (s32)(animTime / animation->secondsPerFrame) % animation->numFrames;
-	}
+	void* result = NULL;
 
-	if(animation->pingPong && animation->numFrames > 1) {
-		double duration = getAnimationDuration(animation);
+	if(group->enabled) {
+		result = pushRenderSize(group, frame, size);
 
-		if(animTime > duration) {
-			duration -= animation->secondsPerFrame;
-			animTime -= duration;
+		RenderHeader* header = (RenderHeader*)result;
+		header->type_ = type;
+		frame->cullStats.elementsPushed++;
 
-			frameIndex = (s32)(animTime / animation->secondsPerFrame) % (animation->numFrames - 1);
+		if(group->hasClipRect) {
+			setRenderElemClipRect(header);
+			R2* clipRectPtr = (R2*)((char*)result + sizeof(RenderHeader));
+			*clipRectPtr = group->clipRect;
+		} 
 
-			s32 numTimesPlayed = (s32)(animTime / duration) + 1;
+		if(!frame->sortEnded && !group->recordingField) {
+			growSortArrays(&frame->sortKeys, &frame->sortPtrs, &frame->maxSortPtrs, frame->numSortPtrs + 1);
 
-			if (numTimesPlayed % 2 == 1) {
-				reverse = !reverse;
-			}
+			frame->sortKeys[frame->numSortPtrs] = createRenderSortKey();
+			frame->sortPtrs[frame->numSortPtrs++] = header;
 		}
+
+		result = (char*)result + headerBytes;
 	}
 
-	
+	return result;
+}
 
-	if (reverse) {
-		frameIndex = (animation->numFrames - 1) - frameIndex;
+void pushSortEnd(RenderGroup* group) {
+	RenderFrame* frame = group->frame;
+	assert(!frame->sortEnded);
+
+	frame->sortEnded = true;
+	frame->sortEndBlock = frame->lastBlock;
+	frame->sortEndOffset = frame->lastBlock ? frame->lastBlock->used : 0;
+}
+
+//NOTE: The elements of src are added after the ones which are already in dst, and src is left empty
+void mergeRenderFrame(RenderFrame* dst, RenderFrame* src) {
+	assert(!dst->sortEnded && !src->sortEnded);
+
+	if(src->firstBlock) {
+		if(dst->lastBlock) dst->lastBlock->next = src->firstBlock;
+		else dst->firstBlock = src->firstBlock;
+
+		dst->lastBlock = src->lastBlock;
 	}
 
-	Texture* result = animation->frames + frameIndex;
+	growSortArrays(&dst->sortKeys, &dst->sortPtrs, &dst->maxSortPtrs, dst->numSortPtrs + src->numSortPtrs);
+	memcpy(dst->sortKeys + dst->numSortPtrs, src->sortKeys, src->numSortPtrs * sizeof(u64));
+	memcpy(dst->sortPtrs + dst->numSortPtrs, src->sortPtrs, src->numSortPtrs * sizeof(RenderHeader*));
+	dst->numSortPtrs += src->numSortPtrs;
+
+	s32 numPointLights = min(src->numPointLights, (s32)arrayCount(dst->pointLights) - dst->numPointLights);
+	memcpy(dst->pointLights + dst->numPointLights, src->pointLights, numPointLights * sizeof(PointLight));
+	dst->numPointLights += numPointLights;
+
+	s32 numSpotLights = min(src->numSpotLights, (s32)arrayCount(dst->spotLights) - dst->numSpotLights);
+	memcpy(dst->spotLights + dst->numSpotLights, src->spotLights, numSpotLights * sizeof(SpotLight));
+	dst->numSpotLights += numSpotLights;
+
+	dst->cullStats.entitiesVisible += src->cullStats.entitiesVisible;
+	dst->cullStats.entitiesCulled += src->cullStats.entitiesCulled;
+	dst->cullStats.elementsPushed += src->cullStats.elementsPushed;
+	dst->cullStats.elementsCulled += src->cullStats.elementsCulled;
+	dst->cullStats.fieldsCulled += src->cullStats.fieldsCulled;
+	dst->cullStats.fieldsRebuilt += src->cullStats.fieldsRebuilt;
+
+	src->firstBlock = src->lastBlock = NULL;
+	src->numSortPtrs = 0;
+	src->numPointLights = 0;
+	src->numSpotLights = 0;
+	src->cullStats = {};
+}
+
+RenderTexture createRenderTexture(DrawOrder drawOrder, Texture* texture, bool flipX, bool flipY,
+								Orientation orientation, float emissivity, Color color) {
+	RenderTexture result = {};
+
+	assert(texture->texId);
+
+	result.drawOrder = drawOrder;
+	result.texture = texture;
+	result.flipX = flipX;
+	result.flipY = flipY;
+	result.orientation = orientation;
+	result.emissivity = emissivity;
+	result.color = color;
+
 	return result;
 }
 
+
 #ifdef HACKFORMER_GAME
+//NOTE: The clip rects aren't moved, they are part of the key
+void translateCachedRenderElems(char* elems, size_t elemsSize, V2 offset) {
+	size_t byteIndex = 0;
+
+	while(byteIndex < elemsSize) {
+		RenderHeader* header = (RenderHeader*)(elems + byteIndex);
+		void* elemPtr = header + 1;
+		byteIndex += sizeof(RenderHeader);
+
+		if(renderElemClipRect(header)) {
+			elemPtr = (char*)elemPtr + sizeof(R2);
+			byteIndex += sizeof(R2);
+		}
 
-Animation createReversedAnimation(Animation* anim) {
-	Animation result = *anim;
-	result.reverse = !result.reverse;
-	return result;
+		#define START_CASE(type) case DrawType_##type: { type* render = (type*)elemPtr; byteIndex += sizeof(type);
+		#define END_CASE } break
+
+		switch(getRenderHeaderType(header)) {
+			START_CASE(RenderBoundedTexture);
+				render->bounds = translateRect(render->bounds, offset);
+			END_CASE;
+
+			START_CASE(RenderText);
+				render->p += offset;
+			END_CASE;
+
+			//NOTE: drawConsoleField doesn't push any other elements when it is only drawing the field
+			InvalidDefaultCase;
+		}
+
+		#undef START_CASE
+		#undef END_CASE
+	}
 }
 
-GlowingTexture* createGlowingTexture(GameState* gameState) {
-	GlowingTexture* result = gameState->glowingTextures + gameState->glowingTexturesCount++;
-	assert(gameState->glowingTexturesCount < MAX_GLOWING_TEXTURES);
+//NOTE: A string which the cached elements refer to can be replaced while the field isn't being drawn, then the
+//		field has to be drawn again. The same goes for text which wasn't interned, since it belonged to an earlier
+//		frame. Otherwise the strings are marked as used by the frame which is being pushed.
+bool touchCachedStrings(StringTable* table, char* elems, size_t elemsSize) {
+	bool result = true;
+	size_t byteIndex = 0;
+
+	while(byteIndex < elemsSize) {
+		RenderHeader* header = (RenderHeader*)(elems + byteIndex);
+		void* elemPtr = header + 1;
+		byteIndex += sizeof(RenderHeader);
+
+		if(renderElemClipRect(header)) {
+			elemPtr = (char*)elemPtr + sizeof(R2);
+			byteIndex += sizeof(R2);
+		}
+
+		#define START_CASE(type) case DrawType_##type: { type* render = (type*)elemPtr; byteIndex += sizeof(type);
+		#define END_CASE } break
+
+		switch(getRenderHeaderType(header)) {
+			START_CASE(RenderBoundedTexture);
+			END_CASE;
+
+			START_CASE(RenderText);
+				if(render->str && render->str->id == render->strId) render->str->lastUsedFrame = table->frameIndex;
+				else result = false;
+			END_CASE;
+
+			InvalidDefaultCase;
+		}
+
+		#undef START_CASE
+		#undef END_CASE
+	}
+
 	return result;
 }
 
-AnimNode* createAnimNode(GameState* gameState, AnimNode** anim = NULL) {
-	AnimNode* result = gameState->animNodes + gameState->animNodesCount++;
-	assert(gameState->animNodesCount < MAX_ANIM_NODES);
-	if(anim) *anim = result;
-	return result;
+//NOTE: The field is drawn into the frame right away, so the element doesn't refer to the field once it is pushed.
+//		The elements are cached, so the field is only drawn again once its key changes.
+void pushConsoleField(RenderGroup* group, FieldSpec* fieldSpec, ConsoleField* field, double alpha) {
+	assert(field);
+	assert(!group->recordingField);
+
+	//NOTE: The console field cache isn't locked, so fields can't be pushed by the workers
+	RenderFrame* frame = group->frame;
+	V2 cameraSpaceP = field->p - group->camera->p;
+	R2 bounds = translateRect(getConsoleFieldBounds(field, fieldSpec), -group->camera->p);
+
+	if(!rectanglesOverlap(group->windowBounds, bounds)) {
+		frame->cullStats.fieldsCulled++;
+		return;
+	}
+
+	assert(group->camera->scale == 1);
+
+	ConsoleFieldRenderKey key;
+	memset(&key, 0, sizeof(key));
+
+	key.field = field;
+	key.type = field->type;
+	key.removed = isSet(field, ConsoleFlag_remove);
+	key.numValues = field->numValues;
+	key.tweakCost = field->tweakCost;
+	assert(sizeof(key.name) == sizeof(field->name));
+	memcpy(key.name, field->name, sizeof(key.name));
+	key.alphaStep = (s32)(clamp(alpha, 0, 1) * CONSOLE_FIELD_ALPHA_STEPS + 0.5);
+	key.moveFields = fieldSpec->hackAbilities.moveFields;
+	key.cloneFields = fieldSpec->hackAbilities.cloneFields;
+	key.hasClipRect = group->hasClipRect;
+	if(group->hasClipRect) key.clipRect = group->clipRect;
+
+	size_t cacheIndex = ((size_t)field / sizeof(ConsoleField)) % MAX_CACHED_CONSOLE_FIELDS;
+	CachedConsoleField* cached = group->cachedFields + cacheIndex;
+
+	RenderConsoleField* render = pushRenderElement(group, frame, RenderConsoleField);
+
+	if(render) {
+		setRenderElemSortKey(group, frame, DrawOrder_pickupField, field->p.y, NULL);
+
+		group->recordingField = render;
+		group->recordingFieldOffset = frame->lastBlock->used - sizeof(RenderConsoleField) - getRenderHeaderSize(group);
+
+		if(!memcmp(&cached->key, &key, sizeof(key)) && touchCachedStrings(&group->strings, cached->elems, cached->elemsSize)) {
+			char* elems = (char*)pushRenderSize(group, frame, cached->elemsSize);
+			memcpy(elems, cached->elems, cached->elemsSize);
+			translateCachedRenderElems(elems, cached->elemsSize, cameraSpaceP - cached->p);
+
+			frame->cullStats.elementsPushed += cached->numElems;
+		} else {
+			s32 elementsPushed = frame->cullStats.elementsPushed;
+
+			V2 oldP = field->p;
+			double oldAlpha = field->alpha;
+			field->p = cameraSpaceP;
+			field->alpha = (double)key.alphaStep / CONSOLE_FIELD_ALPHA_STEPS;
+
+			drawConsoleField(field, group, NULL, fieldSpec, false, true, NULL);
+
+			field->p = oldP;
+			field->alpha = oldAlpha;
+
+			RenderConsoleField* recorded = group->recordingField;
+			size_t elemsSize = (getRenderBlockData(frame->lastBlock) + frame->lastBlock->used) - (char*)(recorded + 1);
+
+			if(elemsSize <= sizeof(cached->elems)) {
+				cached->key = key;
+				cached->p = cameraSpaceP;
+				cached->numElems = frame->cullStats.elementsPushed - elementsPushed;
+				cached->elemsSize = elemsSize;
+				memcpy(cached->elems, recorded + 1, elemsSize);
+			} else {
+				memset(&cached->key, 0, sizeof(cached->key));
+			}
+
+			frame->cullStats.fieldsRebuilt++;
+		}
+
+		//NOTE: The field can be moved into a new block while its elements are being pushed
+		render = group->recordingField;
+		group->recordingField = NULL;
+		render->elemsSize = (getRenderBlockData(frame->lastBlock) + frame->lastBlock->used) - (char*)(render + 1);
+	}
+} 
+#endif
+
+void pushFilledStencil(RenderGroup* group, Texture* stencil, R2 bounds, double widthPercentage, Color color) {
+	assert(validTexture(stencil));
+	assert(widthPercentage >= 0 && widthPercentage <= 1);
+
+	bounds = scaleRect(bounds, v2(1, 1) * group->camera->scale);
+	bounds.max.x = bounds.min.x + getRectWidth(bounds) * widthPercentage;
+
+	if(isRenderBoundsVisible(group, group->frame, bounds)) {
+		RenderFilledStencil* render = pushRenderElement(group, group->frame, RenderFilledStencil);
+
+		if (render) {
+			render->stencil = stencil;
+			render->bounds = bounds;
+			render->widthPercentage = widthPercentage;
+			render->color = color;
+		}
+	}
 }
 
-CharacterAnim* createCharacterAnim(GameState* gameState, CharacterAnim** anim = NULL) {
-	CharacterAnim* data = gameState->characterAnims + gameState->characterAnimsCount++;
-	assert(gameState->characterAnimsCount < MAX_CHARACTER_ANIMS);
-	if(anim) *anim = data;
-	return data;
+void pushTexture(RenderGroup* group, Texture* texture, R2 bounds, double rotation, bool flipX = false, bool flipY = false, 
+	DrawOrder drawOrder = DrawOrder_gui, bool moveIntoCameraSpace = false, Color color = WHITE, float emissivity = 0) {
+
+	assert(validTexture(texture));
+
+	R2 drawBounds = bounds;
+	if(moveIntoCameraSpace) drawBounds = translateRect(bounds, -group->camera->p);
+	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
+
+	R2 clipBounds = drawBounds;
+
+	if(rotation) {
+		V2 halfSize = getRectSize(clipBounds) * 0.5;
+		double size = length(halfSize);
+
+		clipBounds = rectCenterDiameter(getRectCenter(clipBounds), v2(size, size));
+	}
+
+	if(isRenderBoundsVisible(group, group->frame, clipBounds)) {
+		if(rotation) {
+			RenderRotatedTexture* render = pushRenderElement(group, group->frame, RenderRotatedTexture);
+
+			if (render) {
+				render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, Orientation_0, emissivity, color);
+				render->bounds = drawBounds;
+				render->rad = rotation;
+				setRenderElemSortKey(group, group->frame, drawOrder, drawBounds.min.y, texture);
+			}
+		} else {
+			RenderBoundedTexture* render = pushRenderElement(group, group->frame, RenderBoundedTexture);
+
+			if (render) {
+				render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, Orientation_0, emissivity, color);
+				render->bounds = drawBounds;
+				setRenderElemSortKey(group, group->frame, drawOrder, drawBounds.min.y, texture);
+			}
+		}
+	}
 }
 
-#endif
+void pushTexture(RenderGroup* group, Texture* texture, R2 bounds, bool flipX, bool flipY, DrawOrder drawOrder, 
+				 bool moveIntoCameraSpace, Orientation orientation, Color color, float emissivity) {
 
-void setColor(RenderGroup* group, Color color) {
-	GLfloat r = (GLfloat)((color.r + 0.5) / 255.0);
-	GLfloat g = (GLfloat)((color.g + 0.5) / 255.0);
-	GLfloat b = (GLfloat)((color.b + 0.5) / 255.0);
-	GLfloat a = (GLfloat)((color.a + 0.5) / 255.0);
+	assert(validTexture(texture));
+
+	R2 drawBounds = moveIntoCameraSpace ? translateRect(bounds, -group->camera->p) : bounds;
+	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
 
+	if(isRenderBoundsVisible(group, group->frame, drawBounds)) {
+		RenderBoundedTexture* render = pushRenderElement(group, group->frame, RenderBoundedTexture);
 
-	glUniform4f(group->currentShader->tintUniformLocation, r, g, b, a);
+		if (render) {
+			render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, orientation, emissivity, color);
+			render->bounds = drawBounds;
+			setRenderElemSortKey(group, group->frame, drawOrder, drawBounds.min.y, texture);
+		}
+	}
 }
 
-SDL_Rect getPixelSpaceRect(double pixelsPerMeter, s32 windowHeight, R2 rect) {
-	SDL_Rect result = {};
+//NOTE: The bounds of the mesh are in world space
+void pushStaticMesh(RenderGroup* group, s32 meshIndex, DrawOrder drawOrder, R2 bounds) {
+	assert(meshIndex >= 0 && meshIndex < MAX_STATIC_MESHES);
+	if(!group->staticMeshes[meshIndex].numQuads) return;
 
-	double width = getRectWidth(rect);
-	double height = getRectHeight(rect);
+	//NOTE: Static meshes are only translated into camera space, so they can't be drawn while the camera is scaled
+	assert(group->camera->scale == 1);
 
-	result.w = (s32)ceil(width * pixelsPerMeter);
-	result.h = (s32)ceil(height * pixelsPerMeter);
-	result.x = (s32)ceil(rect.max.x * pixelsPerMeter) - result.w;
-	result.y = windowHeight - (s32)ceil(rect.max.y * pixelsPerMeter);
+	R2 drawBounds = translateRect(bounds, -group->camera->p);
 
-	return result;
+	if(isRenderBoundsVisible(group, group->frame, drawBounds)) {
+		RenderStaticMesh* render = pushRenderElement(group, group->frame, RenderStaticMesh);
+
+		if (render) {
+			render->meshIndex = meshIndex;
+			render->cameraP = group->camera->p;
+			setRenderElemSortKey(group, group->frame, drawOrder, drawBounds.min.y, NULL);
+		}
+	}
 }
 
-void bindShader(RenderGroup* group, Shader* shader) {
-	if(group->currentShader != shader) {
-		group->currentShader = shader;
-		glUseProgram(shader->program);
+void pushDashedLine(RenderGroup* group, RenderFrame* frame, Color color, V2 lineStart, V2 lineEnd, double thickness,
+					 double dashSize, double spaceSize, bool moveIntoCameraSpace = false) {
+	if(lineStart == lineEnd) return;
+
+	V2 lineCenter = (lineStart + lineEnd) * 0.5;
+	lineStart = lineCenter + (lineStart - lineCenter) * group->camera->scale;
+	lineEnd = lineCenter + (lineEnd - lineCenter) * group->camera->scale;
+
+	if(moveIntoCameraSpace) {
+		lineStart -= group->camera->p;
+		lineEnd -= group->camera->p;
+	}
+
+	//TODO: No need to push lines on if they aren't visible
+
+	RenderDashedLine* render = pushRenderElement(group, frame, RenderDashedLine);
+
+	if (render) {
+		render->color = color;
+		render->lineStart = lineStart;
+		render->lineEnd = lineEnd;
+		render->thickness = thickness;
+		render->dashSize = dashSize;
+		render->spaceSize = spaceSize;
 	}
 }
 
-void setClipRect(double pixelsPerMeter, R2 rect) {
-	GLint x = (GLint)(rect.min.x * pixelsPerMeter);
-	GLint y = (GLint)(rect.min.y * pixelsPerMeter);
-	GLsizei width = (GLsizei)(getRectWidth(rect) * pixelsPerMeter);
-	GLsizei height = (GLsizei)(getRectHeight(rect) * pixelsPerMeter);
+#ifdef HACKFORMER_GAME
+//NOTE: The entity is drawn at p with the given rotation and emissivity, so the workers which push the entities never 
+//		have to change them
+void pushEntityTexture(RenderGroup* group, RenderFrame* frame, Texture* texture, Entity* entity, V2 p, double rotation, 
+					float emissivity, DrawOrder drawOrder, bool fadeAlphaFromDisappearing,  Color color = WHITE) {
+	assert(texture);
 
-	#ifdef HACKFORMER_MAC
-		x *= 2;
-		y *= 2;
-		width *= 2;
-		height *= 2;
-	#endif
+	if (entity->type == EntityType_laserBeam && !isSet(entity, EntityFlag_laserOn)) return;
+	bool32 cloaked = isSet(entity, EntityFlag_cloaked) && !isSet(entity, EntityFlag_togglingCloak);
+	if(cloaked) return;
 
-	glEnable(GL_SCISSOR_TEST);
-	glScissor(x, y, width, height);
+	R2 bounds = translateRect(rectCenterDiameter(p, entity->renderSize), -group->camera->p);
+	R2 drawBounds = scaleRect(bounds, v2(1, 1) * group->camera->scale);
+
+	R2 clipBounds = scaleRect(drawBounds, v2(1, 1) * 1.05);
+
+	double alpha = entity->alpha;
+
+	//TODO: This won't properly blend the alpha
+	//		The mothership would have to rendered at full alpha into an intermidiate texture
+	//		And then that texture would be rendered with less alpha to the screen
+	//		Otherwise, parts of lower layers that shouldn't be visible will become visible 
+	if(fadeAlphaFromDisappearing) {
+		alpha = max(0, alpha - entity->cloakFactor);
+	}
+
+	color.a = (u8)(color.a * alpha);
+
+	if(rotation) {
+		V2 halfSize = getRectSize(clipBounds) * 0.5;
+		double size = length(halfSize);
+
+		clipBounds = rectCenterDiameter(getRectCenter(clipBounds), v2(size, size));
+	}
+
+	bool flipX = isSet(entity, EntityFlag_facesLeft) != 0;
+	if (entity->type == EntityType_laserBase) flipX = false;
+	bool flipY = isSet(entity, EntityFlag_flipY) != 0;
+
+	if(isRenderBoundsVisible(group, frame, clipBounds)) {
+		if(isTileType(entity) && getMovementField(entity) != NULL) drawOrder = DrawOrder_movingTile;
+
+		RenderEntityTexture* render = pushRenderElement(group, frame, RenderEntityTexture);
+
+		if (render) {
+			render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, Orientation_0, emissivity, color);
+			render->bounds = bounds;
+			render->rotation = rotation;
+			setRenderElemSortKey(group, frame, drawOrder, drawBounds.min.y, texture);
+		}
+	}
 }
 
-Texture createText(RenderGroup* group, TTF_Font* font, char* msg) {
-	SDL_Color fontColor = {0, 0, 0, 255};
-	SDL_Surface* fontSurface = TTF_RenderText_Blended(font, msg, fontColor);
+#endif
 
-	Texture result = createTexFromSurface(fontSurface, group, false);
+//NOTE: This returns NULL if the string is too long or the table is full of strings which the pushed frame or the 
+//		drawn frame refer to
+InternedString* internString(RenderGroup* group, char* msg) {
+	//NOTE: The table isn't locked, so text can't be pushed by the workers
+	StringTable* table = &group->strings;
 
-	return result;
-}
+	s32 length = (s32)strlen(msg);
+	if(length >= MAX_INTERNED_STRING_LENGTH) return NULL;
 
-Glyph* getGlyph(CachedFont* cachedFont, RenderGroup* group, char c, double metersPerPixel) {
-	if (!cachedFont->cache[c].tex.texId) {	
-		SDL_Color white = {255, 255, 255, 255};
+	u64 hash = hashBytes(HASH_OFFSET_BASIS, msg, length);
+	InternedString** bucket = table->buckets + (hash & (INTERNED_STRING_BUCKETS - 1));
 
-		SDL_Surface* glyphSurface = TTF_RenderGlyph_Blended(cachedFont->font, c, white);
-		assert(glyphSurface);
+	InternedString* result = NULL;
 
-		SDL_PixelFormat* format = glyphSurface->format;
-		s32 maxX = 0, minX = glyphSurface->w - 1, maxY = 0, minY = glyphSurface->h - 1;
-	
-	for(s32 y = 0; y < glyphSurface->h; y++) {
-			for(s32 x = 0; x < glyphSurface->w; x++) {
-				void* pixelPtr = (u8*)glyphSurface->pixels + x * format->BytesPerPixel + y * glyphSurface->pitch; 
-				assert(format->BytesPerPixel == 4);
+	for(InternedString* str = *bucket; str; str = str->nextInBucket) {
+		if(str->hash == hash && str->length == length && !memcmp(str->msg, msg, length)) {
+			result = str;
+			break;
+		}
+	}
 
-				u32 pixel = *(u32*)pixelPtr;
-				u32 alpha = pixel & format-> Amask;
+	if(!result) {
+		if(table->numStrings < MAX_INTERNED_STRINGS) {
+			result = table->strings + table->numStrings++;
+		} else {
+			for(s32 strIndex = 0; strIndex < MAX_INTERNED_STRINGS; strIndex++) {
+				InternedString* str = table->strings + strIndex;
 
-				if(alpha) {
-					if(x > maxX) maxX = x;
-					if (x < minX) minX = x;
-					if(y > maxY) maxY = y;
-					if(y < minY) minY = y;
+				if(str->lastUsedFrame + 2 <= table->frameIndex && 
+				   (!result || str->lastUsedFrame < result->lastUsedFrame)) {
+					result = str;
 				}
 			}
+
+			if(!result) return NULL;
+
+			InternedString** strPtr = table->buckets + (result->hash & (INTERNED_STRING_BUCKETS - 1));
+
+			while(*strPtr != result) {
+				assert(*strPtr);
+				strPtr = &(*strPtr)->nextInBucket;
+			}
+
+			*strPtr = result->nextInBucket;
 		}
 
-		cachedFont->cache[c].padding.max.y = minY * metersPerPixel;
-		cachedFont->cache[c].padding.min.y = ((glyphSurface->h - 1) * metersPerPixel) - (maxY * metersPerPixel);
-		cachedFont->cache[c].padding.max.x = minX * metersPerPixel;
-		cachedFont->cache[c].padding.min.x = ((glyphSurface->w - 1) * metersPerPixel) - (maxX * metersPerPixel);
+		result->hash = hash;
+		result->id = ++table->nextId;
+		result->measuredFont = NULL;
+		result->length = length;
+		memcpy(result->msg, msg, length);
+		result->msg[length] = 0;
 
-		cachedFont->cache[c].tex = createTexFromSurface(glyphSurface, group, false);
-		assert(cachedFont->cache[c].tex.texId);
+		result->nextInBucket = *bucket;
+		*bucket = result;
 	}
 
-	Glyph* result = cachedFont->cache + c;
+	result->lastUsedFrame = table->frameIndex;
 	return result;
 }
 
-double getTextWidth(CachedFont* cachedFont, RenderGroup* group, char* msg) {
-	double result = 0;
-
-	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
-	double invScaleFactor = 1.0 / cachedFont->scaleFactor;
-
-	while(*msg) {
-		result += getGlyph(cachedFont, group, *msg, metersPerPixel)->tex.size.x * invScaleFactor;
-		msg++;
+V2 getInternedStringSize(RenderGroup* group, CachedFont* font, InternedString* str) {
+	if(str->measuredFont != font) {
+		str->measuredFont = font;
+		str->size = getTextSize(font, group, str->msg);
 	}
 
+	V2 result = str->size;
 	return result;
 }
 
-double getTextHeight(CachedFont* cachedFont, RenderGroup* group, char* msg) {
-	double result = 0;
+char* pushFrameText(RenderGroup* group, RenderFrame* frame, char* msg) {
+	size_t size = strlen(msg) + 1;
+	RenderBlock* block = frame->lastTextBlock;
 
-	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
-	double invScaleFactor = 1.0 / cachedFont->scaleFactor;
+	if(!block || block->used + size > block->size) {
+		block = getRenderBlock(group, size);
 
-	while(*msg) {
-		Glyph* glyph = getGlyph(cachedFont, group, *msg, metersPerPixel);
-		double glyphHeight = glyph->tex.size.y * invScaleFactor - glyph->padding.min.y - glyph->padding.max.y;
-		if(glyphHeight > result) result = glyphHeight;
+		if(frame->lastTextBlock) frame->lastTextBlock->next = block;
+		else frame->firstTextBlock = block;
 
-		msg++;
+		frame->lastTextBlock = block;
 	}
 
+	char* result = getRenderBlockData(block) + block->used;
+	memcpy(result, msg, size);
+	block->used += size;
+
 	return result;
 }
 
-V2 getTextSize(CachedFont* cachedFont, RenderGroup* group, char* msg) {
-	V2 result = v2(getTextWidth(cachedFont, group, msg), getTextHeight(cachedFont, group, msg));
-	return result;
+//NOTE: If the text couldn't be interned (str is NULL), it is copied into the frame which is being pushed
+void setRenderTextMsg(RenderGroup* group, RenderText* render, InternedString* str, char* msg) {
+	render->str = str;
+
+	if(str) {
+		render->strId = render->str->id;
+		render->msg = render->str->msg;
+	} else {
+		render->strId = 0;
+		render->msg = pushFrameText(group, group->frame, msg);
+	}
 }
 
-R2 getTextPadding(CachedFont* cachedFont, RenderGroup* group, char* msg) {
-	R2 result = {v2(-1, -1), v2(-1, -1)};
+void pushText(RenderGroup* group, CachedFont* font, char* msg, V2 p, Color color = BLACK,
+			  TextAlignment alignment = TextAlignment_bottomLeft) {
+	InternedString* str = internString(group, msg);
 
-	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
+	//NOTE: This makes sure all of the glyphs exist, the render thread can't add them to the glyph pages
+	V2 strSize = str ? getInternedStringSize(group, font, str) : getTextSize(font, group, msg);
 
-	while(char c = *msg++) {
-		Glyph* glyph = getGlyph(cachedFont, group, c, metersPerPixel);
+	switch(alignment) {
+		case TextAlignment_center: {
+			p -= strSize * 0.5;
+		} break;
 
-		if(result.min.x < 0 || glyph->padding.min.x < result.min.x) result.min.x = glyph->padding.min.x;
-		if(result.max.x < 0 || glyph->padding.max.x < result.max.x) result.max.x = glyph->padding.max.x;
-		if(result.min.y < 0 || glyph->padding.min.y < result.min.y) result.min.y = glyph->padding.min.y;
-		if(result.max.y < 0 || glyph->padding.max.y < result.max.y) result.max.y = glyph->padding.max.y;
+		case TextAlignment_bottomLeft:
+			break;
+
+		InvalidDefaultCase;
 	}
 
-	if(result.min.x < 0) result.min.x = 0;
-	if(result.max.x < 0) result.max.x = 0;
-	if(result.min.y < 0) result.min.y = 0;
-	if(result.max.y < 0) result.max.y = 0;
+	RenderText* render = pushRenderElement(group, group->frame, RenderText);
 
-	return result;
+	if (render) {
+		setRenderTextMsg(group, render, str, msg);
+		render->p = p;
+		render->font = font;
+		render->color = color;
+	}
 }
 
-bool validTexture(Texture* texture) {
-	bool result = texture && texture->texId;
-	return result;
-}
+void pushFilledRect(RenderGroup* group, R2 bounds, Color color, bool moveIntoCameraSpace = false) {
+	R2 drawBounds = moveIntoCameraSpace ? translateRect(bounds, -group->camera->p) : bounds;
+	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
 
-RenderGroup* createRenderGroup(size_t size, MemoryArena* arena, double pixelsPerMeter, s32 windowWidth, s32 windowHeight, 
-								Camera* camera, Texture* textures, s32* texturesCount, Assets* assets) {
-	RenderGroup* result = pushStruct(arena, RenderGroup);
+	if(isRenderBoundsVisible(group, group->frame, drawBounds)) {
+		RenderFillRect* render = pushRenderElement(group, group->frame, RenderFillRect);
 
-	result->allocated = 0;
-	result->numSortPtrs = 0;
-	result->sortAddressCutoff = 0;
-	result->maxSize = size;
-	result->base = pushSize(arena, size);
-	result->pixelsPerMeter = pixelsPerMeter;
-	result->windowWidth = windowWidth;
-	result->windowHeight = windowHeight;
+		if (render) {
+			render->color = color;
+			render->bounds = drawBounds;
+		}
+	}
+}
 
-	V2 windowSize = v2(windowWidth, windowHeight) * (1.0 / pixelsPerMeter);
+void pushOutlinedRect(RenderGroup* group, RenderFrame* frame, R2 bounds, double thickness, Color color, bool moveIntoCameraSpace = false) {
+	R2 drawBounds = moveIntoCameraSpace ? translateRect(bounds, -group->camera->p) : bounds;
+	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
 
-	result->windowBounds = r2(v2(0, 0), windowSize);
-	result->camera = camera;
-	result->textures = textures;
-	result->texturesCount = texturesCount;
+	if(isRenderBoundsVisible(group, frame, addDiameterTo(drawBounds, v2(1, 1) * thickness))) {
+		RenderOutlinedRect* render = pushRenderElement(group, frame, RenderOutlinedRect);
 
-	result->assets = assets;
+		if (render) {
+			render->thickness = thickness;
+			render->color = color;
+			render->bounds = drawBounds;
+		}
+	}
+}
 
-	result->forwardShader = createForwardShader(result, windowSize);
+PointLight createPointLight(V3 p, V3 color, double range) {
+	PointLight result = {};
 
-	//TODO: This compiles basic.vert twice (maybe it can be re-used for both programs)
-	result->basicShader = createShader(result, Asset_basicVS, Asset_basicFS, windowSize);
-	result->stencilShader = createShader(result, Asset_basicVS, Asset_stencilFS, windowSize);
+	result.p = p;
+	result.color = color;
+	result.range = range;
 
-	result->defaultClipRect = result->windowBounds;
+	return result;
+}
 
-	result->whiteTex = loadPNGTexture(result, Asset_white, false);
+SpotLight createSpotLight(V2 p, V3 color, double range, double angle, double spread) {
+	SpotLight result = {};
+
+	result.base = createPointLight(v3(p, 0), color, range);
+	result.angle = angle;
+	result.spread = spread;
 
 	return result;
 }
 
-void sendTexCoord(V2 uvMin, V2 uvMax, s32 orientation) {    
-	switch(orientation) {
-		case Orientation_0: {
-			glTexCoord2f((GLfloat)uvMax.x, (GLfloat)uvMax.y); 
-		} break;
+PointLight getRenderablePointLight(PointLight* light, bool moveIntoCameraSpace, V2 negativeCameraP) {
+	assert(light->range > 0);
 
-		case Orientation_90: {
-			glTexCoord2f((GLfloat)uvMin.x, (GLfloat)uvMax.y); 
-		} break;
+	PointLight result = *light;
+	if (moveIntoCameraSpace) result.p += v3(negativeCameraP, 0);
 
-		case Orientation_180: {
-			glTexCoord2f((GLfloat)uvMin.x, (GLfloat)uvMin.y); 
-		} break;
+	return result;
+}
 
-		case Orientation_270: {
-			glTexCoord2f((GLfloat)uvMax.x, (GLfloat)uvMin.y); 
-		} break;
+void pushPointLight(RenderGroup* group, PointLight* pl, bool moveIntoCameraSpace = false) {
+	RenderFrame* frame = group->frame;
 
-		InvalidDefaultCase;		
+	if(group->enabled) {
+		if(frame->numPointLights < arrayCount(frame->pointLights)) {
+			PointLight* light = frame->pointLights + frame->numPointLights;
+			frame->numPointLights++;
+
+			*light = getRenderablePointLight(pl, moveIntoCameraSpace, -group->camera->p);
+		} else {
+			InvalidCodePath;
+		}
 	}
 }
 
-void bindTexture(Texture* texture, RenderGroup* group) {
-	assert(validTexture(texture));
-
-	glEnable(GL_TEXTURE_2D);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+void pushSpotLight(RenderGroup* group, SpotLight* sl, bool moveIntoCameraSpace = false) {
+	RenderFrame* frame = group->frame;
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, texture->texId);
-}
+	if(group->enabled) {
+		if(frame->numSpotLights < arrayCount(frame->spotLights)) {
+			SpotLight* light = frame->spotLights + frame->numSpotLights;
+			frame->numSpotLights++;
 
-void setAmbient(RenderGroup* group, GLfloat ambient) {
-	glUniform3f(group->forwardShader.ambientUniform, ambient, ambient, ambient);
+			light->base = getRenderablePointLight(&sl->base, moveIntoCameraSpace, -group->camera->p);
+			light->angle = sl->angle;
+			light->spread = sl->spread;
+		} else {
+			InvalidCodePath;
+		}
+	}
 }
 
-void drawTexture(RenderGroup* group, Texture* texture, R2 bounds, bool flipX, bool flipY, Orientation orientation, float emissivity, 
-				GLfloat ambient, Color color) {
-	if(emissivity) {
-		setAmbient(group, ambient + (1 - ambient) * emissivity);
-	}
 
-	bindTexture(texture, group);
+void pushClipRect(RenderGroup* group, R2 clipRect) {
+	group->clipRect = clipRect;
+	group->hasClipRect = true;
+}
 
-	setColor(group, color);
+void pushDefaultClipRect(RenderGroup* group) {
+	group->hasClipRect = false;
+}
 
-	V2 uvMin = texture->uv.min;
-	V2 uvMax = texture->uv.max;
+size_t drawRenderElem(RenderGroup* group, RenderFrame* frame, void* elemPtr, bool pastSortEnd) {
+	RenderHeader* header = (RenderHeader*)elemPtr;
+	size_t elemSize = sizeof(RenderHeader);
 
-	if (!flipX) {
-		swap(uvMin.x, uvMax.x);
-	}
+	elemPtr = (char*)elemPtr + sizeof(RenderHeader);
 
-	if(flipY) {
-		swap(uvMin.y, uvMax.y);
+	if (renderElemClipRect(header)) {
+		R2* clipBounds = (R2*)elemPtr;
+		elemPtr = (char*)elemPtr + sizeof(R2);
+		elemSize += sizeof(R2);
+		setClipRect(group, *clipBounds);
+	} else if(pastSortEnd) {
+		disableClipRect(group);
+	} else {
+		setClipRect(group, frame->defaultClipRect);
 	}
 
-	glBegin(GL_QUADS);
-		sendTexCoord(uvMin, uvMax, orientation);
-		glVertex2f((GLfloat)bounds.min.x, (GLfloat)bounds.min.y);
+	#define START_CASE(type) case DrawType_##type: { type* render = (type*)elemPtr; elemSize += sizeof(type);
+	#define END_CASE } break
 
-		sendTexCoord(uvMin, uvMax, (orientation + 1) % Orientation_count); 
-		glVertex2f((GLfloat)bounds.max.x, (GLfloat)bounds.min.y);
+	switch(getRenderHeaderType(header)) {
 
-		sendTexCoord(uvMin, uvMax, (orientation + 2) % Orientation_count); 
-		glVertex2f((GLfloat)bounds.max.x, (GLfloat)bounds.max.y);
+		START_CASE(RenderBoundedTexture);
+			drawTexture(group, render->tex.texture, render->bounds, render->tex.flipX != 0, render->tex.flipY != 0, 
+						render->tex.orientation, render->tex.emissivity, render->tex.color);
+		END_CASE;
 
-		sendTexCoord(uvMin, uvMax, (orientation + 3) % Orientation_count); 
-		glVertex2f((GLfloat)bounds.min.x, (GLfloat)bounds.max.y);
-	glEnd();
+		START_CASE(RenderEntityTexture);
+			if(render->rotation) {
+				drawTexture(group, render->tex.texture, render->bounds, render->rotation, render->tex.color, render->tex.flipX != 0, 
+							render->tex.flipY != 0, render->tex.emissivity);
+			} else {
+				drawTexture(group, render->tex.texture, render->bounds, render->tex.flipX != 0, render->tex.flipY != 0,
+							render->tex.orientation, render->tex.emissivity, render->tex.color);
+			}
+		END_CASE;
 
-	if(emissivity) {
-		setAmbient(group, ambient);
-	}
-}
+		START_CASE(RenderText);
+			assert(!render->str || render->str->id == render->strId);
+			drawText(group, render->font, render->msg, render->p, render->color);
+		END_CASE;
 
-void drawTexture(RenderGroup* group, Texture* texture, R2 bounds, double rot, Color color, bool flipX, bool flipY, float emissivity,
-				 GLfloat ambient) {
-	if(emissivity) {
-		setAmbient(group, ambient + (1 - ambient) * emissivity);
-	}
+		START_CASE(RenderFillRect);
+			drawFillRect(group, render->bounds, render->color);
+		END_CASE;
 
-	bindTexture(texture, group);
-	setColor(group, color);
+		START_CASE(RenderOutlinedRect);
+			drawOutlinedRect(group, render->bounds, render->color, render->thickness);
+		END_CASE;
 
-	V2 uvMin = texture->uv.min;
-	V2 uvMax = texture->uv.max;
+		START_CASE(RenderConsoleField);
+			char* elems = (char*)(render + 1);
+			size_t elemsByteIndex = 0;
 
-	if (!flipX) {
-		swap(uvMin.x, uvMax.x);
-	}
+			while(elemsByteIndex < render->elemsSize) {
+				elemsByteIndex += drawRenderElem(group, frame, elems + elemsByteIndex, pastSortEnd);
+			}
 
-	if(flipY) {
-		swap(uvMin.y, uvMax.y);
-	}
+			elemSize += render->elemsSize;
+		END_CASE;
 
-	V2 center = getRectCenter(bounds);
+		START_CASE(RenderDashedLine);
+			drawDashedLine(group, render->color, render->lineStart, render->lineEnd, render->thickness, render->dashSize, render->spaceSize);
+		END_CASE;
 
-	V2 originRelativeMin = bounds.min - center;
-	V2 originRelativeMax = bounds.max - center;
+		START_CASE(RenderRotatedTexture);
+			drawTexture(group, render->tex.texture, render->bounds, render->rad, render->tex.color,
+					    render->tex.flipX != 0, false, render->tex.emissivity);
+		END_CASE;
 
-	V2 originRelativeP2 = v2(originRelativeMax.x, originRelativeMin.y);
-	V2 originRelativeP3 = v2(originRelativeMin.x, originRelativeMax.y);
+		START_CASE(RenderFilledStencil);
+			drawFilledStencil(group, render->stencil, render->bounds, render->widthPercentage, render->color);
+		END_CASE;
 
-	V2 p[4];
+		START_CASE(RenderStaticMesh);
+			drawStaticMesh(group, render->meshIndex, render->cameraP);
+		END_CASE;
 
-	p[0] = rotate(originRelativeMin, rot) + center;
-	p[1] = rotate(originRelativeP2, rot) + center;
-	p[2] = rotate(originRelativeMax, rot) + center;
-	p[3] = rotate(originRelativeP3, rot) + center;
+		InvalidDefaultCase;
+	}
 
-	glBegin(GL_QUADS);
-		for(s32 pIndex = 0; pIndex < arrayCount(p); pIndex++) {
-			sendTexCoord(uvMin, uvMax, pIndex);
-			glVertex2f((GLfloat)p[pIndex].x, (GLfloat)p[pIndex].y);
-		}
-	glEnd();
+	#undef START_CASE
+	#undef END_CASE
 
-	if(emissivity) {
-		setAmbient(group, ambient);
-	}
+	return elemSize;
 }
 
-void drawFilledStencil(RenderGroup* group, Texture* stencil, R2 bounds, double widthPercentage, Color color) {
-	double uvWidth = getRectWidth(stencil->uv);
-	uvWidth *= widthPercentage;
+//NOTE: The blocks are given back to the pool, the sort arrays are kept for the next frame
+void clearRenderFrame(RenderGroup* group, RenderFrame* frame) {
+	freeRenderBlocks(group, frame->firstBlock, frame->lastBlock);
+	freeRenderBlocks(group, frame->firstTextBlock, frame->lastTextBlock);
+
+	frame->firstBlock = frame->lastBlock = NULL;
+	frame->firstTextBlock = frame->lastTextBlock = NULL;
+	frame->numSortPtrs = 0;
+	frame->sortEnded = false;
+	frame->sortEndBlock = NULL;
+	frame->sortEndOffset = 0;
+	frame->numPointLights = 0;
+	frame->numSpotLights = 0;
+	frame->cullStats = {};
+}
 
-	double uMax = stencil->uv.min.x + uvWidth;
+//NOTE: This is a stable least significant digit radix sort on the sort keys, 8 bits at a time
+void sortRenderElems(RenderGroup* group, RenderFrame* frame) {
+	s32 count = frame->numSortPtrs;
+	growSortArrays(&group->sortKeysTemp, &group->sortPtrsTemp, &group->maxSortTemp, count);
 
-	V2 uvMax = v2(uMax, stencil->uv.max.y);
-	V2 uvMin = stencil->uv.min;
+	u32 counts[8][256] = {};
 
-	Shader* oldShader = group->currentShader;
-	bindShader(group, &group->stencilShader);
+	for(s32 elemIndex = 0; elemIndex < count; elemIndex++) {
+		u64 key = frame->sortKeys[elemIndex];
 
-	bindTexture(stencil, group);
-	setColor(group, color);
+		for(s32 digitIndex = 0; digitIndex < 8; digitIndex++) {
+			counts[digitIndex][(key >> (digitIndex * 8)) & 0xFF]++;
+		}
+	}
 
-	glBegin(GL_QUADS);
-		glTexCoord2f((GLfloat)uvMin.x, (GLfloat)uvMax.y);
-		glVertex2f((GLfloat)bounds.min.x, (GLfloat)bounds.min.y);
+	u64* srcKeys = frame->sortKeys;
+	RenderHeader** srcPtrs = frame->sortPtrs;
+	u64* dstKeys = group->sortKeysTemp;
+	RenderHeader** dstPtrs = group->sortPtrsTemp;
 
-		glTexCoord2f((GLfloat)uvMax.x, (GLfloat)uvMax.y);
-		glVertex2f((GLfloat)bounds.max.x, (GLfloat)bounds.min.y);
+	for(s32 digitIndex = 0; digitIndex < 8; digitIndex++) {
+		u32* digitCounts = counts[digitIndex];
+		s32 shift = digitIndex * 8;
 
-		glTexCoord2f((GLfloat)uvMax.x, (GLfloat)uvMin.y);
-		glVertex2f((GLfloat)bounds.max.x, (GLfloat)bounds.max.y);
+		//NOTE: Most of the high digits are the same for every element, so those passes can be skipped
+		if(count == 0 || digitCounts[(srcKeys[0] >> shift) & 0xFF] == (u32)count) continue;
 
-		glTexCoord2f((GLfloat)uvMin.x, (GLfloat)uvMin.y);
-		glVertex2f((GLfloat)bounds.min.x, (GLfloat)bounds.max.y);
-	glEnd();
+		u32 offset = 0;
 
-	bindShader(group, oldShader);
-}
+		for(s32 digit = 0; digit < 256; digit++) {
+			u32 digitCount = digitCounts[digit];
+			digitCounts[digit] = offset;
+			offset += digitCount;
+		}
 
-void drawText(RenderGroup* group, CachedFont* cachedFont, char* msg, V2 p, Color color) {
-	double metersPerPixel = 1.0 / (group->pixelsPerMeter * cachedFont->scaleFactor);
-	double invScaleFactor = 1.0 / cachedFont->scaleFactor;
+		for(s32 elemIndex = 0; elemIndex < count; elemIndex++) {
+			u64 key = srcKeys[elemIndex];
+			u32 dstIndex = digitCounts[(key >> shift) & 0xFF]++;
 
-	while(*msg) {
-		Texture* texture = &getGlyph(cachedFont, group, *msg, metersPerPixel)->tex;
-		V2 size = texture->size * invScaleFactor;
-		R2 bounds = r2(p, p + size);
+			dstKeys[dstIndex] = key;
+			dstPtrs[dstIndex] = srcPtrs[elemIndex];
+		}
 
-		drawTexture(group, texture, bounds, false, false, Orientation_0, 0, 1, color);
+		swap(srcKeys, dstKeys);
+		swap(srcPtrs, dstPtrs);
+	}
 
-		p.x += size.x;
-		msg++;
+	if(srcKeys != frame->sortKeys) {
+		memcpy(frame->sortKeys, srcKeys, count * sizeof(u64));
+		memcpy(frame->sortPtrs, srcPtrs, count * sizeof(RenderHeader*));
 	}
 }
 
-void drawFillRect(RenderGroup* group, R2 bounds, Color color) {
-	// SDL_Rect dstRect = getPixelSpaceRect(group->pixelsPerMeter, group->windowHeight, rect);
-	// SDL_RenderFillRect(group->renderer, &dstRect);
-
-	bindTexture(group->whiteTex, group);
-	setColor(group, color);
-			
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0);
-		glVertex2f((GLfloat)bounds.min.x, (GLfloat)bounds.min.y);
-
-		glTexCoord2f(1, 0);
-		glVertex2f((GLfloat)bounds.max.x, (GLfloat)bounds.min.y);
-
-		glTexCoord2f(1, 1);
-		glVertex2f((GLfloat)bounds.max.x, (GLfloat)bounds.max.y);
+bool isPointLightVisible(RenderGroup* group, PointLight* light) {
+	R2 maxLightBounds = addRadiusTo(group->windowBounds, v2(1, 1) * light->range);
 
-		glTexCoord2f(0, 1);
-		glVertex2f((GLfloat)bounds.min.x, (GLfloat)bounds.max.y);
-	glEnd();
+	//TODO: Account for z
+	bool result = pointInsideRect(maxLightBounds, light->p.xy);
+	return result;
 }
 
-void drawFillQuad(RenderGroup* group, V2 p1, V2 p2, V2 p3, V2 p4) {
-	bindTexture(group->whiteTex, group);
+void addLight(LightTiles* tiles, PointLight* light, V2 dir, double cutoff) {
+	assert(tiles->numLights < MAX_LIGHTS);
+	GLfloat* data = tiles->data + tiles->numLights * LIGHT_DATA_TEXELS * 4;
 
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0);
-		glVertex2f((GLfloat)p1.x, (GLfloat)p1.y);
+	data[0] = (GLfloat)light->p.x;
+	data[1] = (GLfloat)light->p.y;
+	data[2] = (GLfloat)light->p.z;
+	data[3] = (GLfloat)light->range;
 
-		glTexCoord2f(1, 0);
-		glVertex2f((GLfloat)p2.x, (GLfloat)p2.y);
+	data[4] = (GLfloat)light->color.x;
+	data[5] = (GLfloat)light->color.y;
+	data[6] = (GLfloat)light->color.z;
+	data[7] = (GLfloat)cutoff;
 
-		glTexCoord2f(1, 1);
-		glVertex2f((GLfloat)p3.x, (GLfloat)p3.y);
+	data[8] = (GLfloat)dir.x;
+	data[9] = (GLfloat)dir.y;
+	data[10] = 0;
+	data[11] = 0;
 
-		glTexCoord2f(0, 1);
-		glVertex2f((GLfloat)p4.x, (GLfloat)p4.y);
-	glEnd();
+	//TODO: Spot lights could use the bounds of their cone instead
+	tiles->bounds[tiles->numLights] = rectCenterRadius(light->p.xy, v2(1, 1) * light->range);
+	tiles->numLights++;
 }
 
-void drawOutlinedRect(RenderGroup* group, R2 rect, Color color, double thickness) {
-	V2 halfThickness = v2(thickness, thickness) * 0.5;
+void getLightTileRange(LightTiles* tiles, R2 bounds, s32* minX, s32* minY, s32* maxX, s32* maxY) {
+	*minX = max(0, (s32)floor(bounds.min.x / tiles->tileSize));
+	*minY = max(0, (s32)floor(bounds.min.y / tiles->tileSize));
+	*maxX = min(tiles->tilesWidth - 1, (s32)floor(bounds.max.x / tiles->tileSize));
+	*maxY = min(tiles->tilesHeight - 1, (s32)floor(bounds.max.y / tiles->tileSize));
+}
 
-	V2 bottomMinCorner = rect.min - halfThickness;
-	V2 bottomMaxCorner = v2(rect.max.x, rect.min.y) + halfThickness;
+//NOTE: This builds the light list of every screen tile and uploads them along with the light data
+void updateLightTiles(RenderGroup* group, RenderFrame* frame) {
+	LightTiles* tiles = &group->lightTiles;
 
-	V2 topMinCorner = v2(rect.min.x, rect.max.y) - halfThickness;
-	V2 topMaxCorner = rect.max + halfThickness;
+	tiles->numLights = 0;
 
-	V2 leftMinCorner = bottomMinCorner + v2(0, thickness);
-	V2 leftMaxCorner = topMinCorner + v2(thickness, 0);
+	for(s32 lightIndex = 0; lightIndex < frame->numPointLights; lightIndex++) {
+		PointLight* light = frame->pointLights + lightIndex;
 
-	V2 rightMinCorner = bottomMaxCorner - v2(thickness, 0);
-	V2 rightMaxCorner = topMaxCorner - v2(0, thickness);
+		//TODO: account for z
+		if(isPointLightVisible(group, light)) {
+			addLight(tiles, light, v2(0, 0), -2);
+		}
+	}
 
-	drawFillRect(group, r2(bottomMinCorner, bottomMaxCorner), color);
-	drawFillRect(group, r2(topMinCorner, topMaxCorner), color);
-	drawFillRect(group, r2(leftMinCorner, leftMaxCorner), color);
-	drawFillRect(group, r2(rightMinCorner, rightMaxCorner), color);
-}
+	for(s32 lightIndex = 0; lightIndex < frame->numSpotLights; lightIndex++) {
+		SpotLight* light = frame->spotLights + lightIndex;
 
-void drawDashedLine(RenderGroup* group, Color color, V2 lineStart, V2 lineEnd,
-					 double thickness, double dashSize, double spaceSize) {
-	setColor(group, color);
-	if((lineStart.x > lineEnd.x) || (lineStart.x == lineEnd.x && lineStart.y > lineEnd.y)) {
-		swap(lineStart, lineEnd);
+		//TODO: account for z
+		if(isPointLightVisible(group, &light->base)) {
+			double angle = light->angle;
+			V2 lightDir = v2(cos(angle), sin(angle));
+			double cutoff = cos(toRadians(light->spread / 2));
+
+			addLight(tiles, &light->base, lightDir, cutoff);
+		}
 	}
 
-	V2 dir = normalize(lineEnd - lineStart);
-	V2 normal = perp(dir) * thickness;
+	s32 numTiles = tiles->tilesWidth * tiles->tilesHeight;
+	memset(tiles->tileRanges, 0, numTiles * 2 * sizeof(s32));
 
-	V2 dashSkip = dashSize * dir;
-	V2 spaceSkip = spaceSize * dir;
+	//NOTE: The first pass counts the lights in each tile. The lights which don't fit in the index list are dropped.
+	s32 numIndices = 0;
 
-	V2 start = lineStart;
+	for(s32 lightIndex = 0; lightIndex < tiles->numLights; lightIndex++) {
+		s32 minX, minY, maxX, maxY;
+		getLightTileRange(tiles, tiles->bounds[lightIndex], &minX, &minY, &maxX, &maxY);
 
-	while(true) {
-		bool doneDrawing = false;
-		V2 end = start + dashSkip;
+		s32 lightTiles = (maxX - minX + 1) * (maxY - minY + 1);
 
-		if(end.x > lineEnd.x || (lineStart.x == lineEnd.x && end.y > lineEnd.y)) {
-			doneDrawing = true;
-			end = lineEnd;
+		if(numIndices + lightTiles > MAX_LIGHT_TILE_INDICES) {
+			tiles->numLights = lightIndex;
+			break;
 		}
 
-		if((dashSkip.y > 0 && end.y > lineEnd.y) || (dashSkip.y < 0 && end.y < lineEnd.y)) {
-			doneDrawing = true;
-			end = lineEnd;
+		numIndices += lightTiles;
+
+		for(s32 tileY = minY; tileY <= maxY; tileY++) {
+			for(s32 tileX = minX; tileX <= maxX; tileX++) {
+				tiles->tileRanges[(tileX + tileY * tiles->tilesWidth) * 2 + 1]++;
+			}
 		}
+	}
 
-		V2 p1 = start + normal;
-		V2 p2 = start - normal;
-		V2 p3 = end - normal;
-		V2 p4 = end + normal;
+	s32 offset = 0;
 
-		drawFillQuad(group, p1, p2, p3, p4);
+	for(s32 tileIndex = 0; tileIndex < numTiles; tileIndex++) {
+		s32 count = tiles->tileRanges[tileIndex * 2 + 1];
+		group->stats.maxLightsPerTile = max(group->stats.maxLightsPerTile, count);
 
-		if(doneDrawing) break;
+		tiles->tileRanges[tileIndex * 2] = offset;
+		tiles->tileRanges[tileIndex * 2 + 1] = 0;
+		offset += count;
+	}
 
-		start = end + spaceSkip;
+	//NOTE: The second pass fills in the index lists, the counts are rebuilt as they are filled
+	for(s32 lightIndex = 0; lightIndex < tiles->numLights; lightIndex++) {
+		s32 minX, minY, maxX, maxY;
+		getLightTileRange(tiles, tiles->bounds[lightIndex], &minX, &minY, &maxX, &maxY);
+
+		for(s32 tileY = minY; tileY <= maxY; tileY++) {
+			for(s32 tileX = minX; tileX <= maxX; tileX++) {
+				s32* range = tiles->tileRanges + (tileX + tileY * tiles->tilesWidth) * 2;
+				tiles->indices[range[0] + range[1]] = lightIndex;
+				range[1]++;
+			}
+		}
 	}
-}
 
-#ifdef HACKFORMER_GAME
-void renderDrawConsoleField(RenderGroup* group, FieldSpec* fieldSpec, ConsoleField* field, double alpha) {
-	field->p -= group->camera->p;
-	double oldAlpha = field->alpha;
-	field->alpha = alpha;
-	drawConsoleField(field, group, NULL, fieldSpec, false, true, NULL);
-	field->alpha = oldAlpha;
-	field->p += group->camera->p;
-}
-#endif
+	//NOTE: Empty buffer textures aren't allowed, so there is always at least one element
+	glBindBuffer(GL_TEXTURE_BUFFER, tiles->dataBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, max(1, tiles->numLights) * LIGHT_DATA_TEXELS * 4 * sizeof(GLfloat), tiles->data, GL_STREAM_DRAW);
 
-DrawType getRenderHeaderType(RenderHeader* header) {
-	DrawType result = (DrawType)(header->type_ & RENDER_HEADER_TYPE_MASK);
-	return result;
+	glBindBuffer(GL_TEXTURE_BUFFER, tiles->tileBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, numTiles * 2 * sizeof(s32), tiles->tileRanges, GL_STREAM_DRAW);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, tiles->indexBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, max(1, numIndices) * sizeof(s32), tiles->indices, GL_STREAM_DRAW);
+
+	group->stats.lights = tiles->numLights;
 }
 
-bool32 renderElemClipRect(RenderHeader* header) {
-	bool32 result = header->type_ & RENDER_HEADER_CLIP_RECT_FLAG;
+s32 addCapturedGLTexture(RenderCapture* capture, GLuint texId) {
+	s32 result = -1;
+
+	for(s32 textureIndex = 0; textureIndex < capture->numGLTextures; textureIndex++) {
+		if(capture->glTextures[textureIndex].texId == texId) {
+			result = textureIndex;
+			break;
+		}
+	}
+
+	if(result < 0) {
+		assert(capture->numGLTextures < arrayCount(capture->glTextures));
+		result = capture->numGLTextures++;
+		capture->glTextures[result].texId = texId;
+	}
+
 	return result;
 }
 
-void setRenderElemClipRect(RenderHeader* header) {
-	header->type_ |= RENDER_HEADER_CLIP_RECT_FLAG;
-}
+void streamCapturedGLTexture(IOStream* stream, RenderGroup* group, CapturedGLTexture* texture) {
+	if(!stream->reading) {
+		//NOTE: The pending quads have to be drawn before the texture binding is changed
+		flushBatch(group);
+		glBindTexture(GL_TEXTURE_2D, texture->texId);
 
-#define pushRenderElement(group, type) (type*)pushRenderElement_(group, DrawType_##type, sizeof(type))
-void* pushRenderElement_(RenderGroup* group, DrawType type, size_t size) {
-	size_t headerBytes = sizeof(RenderHeader);
+		GLint width, height, internalFormat;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
 
-	if (group->hasClipRect) {
-		headerBytes += sizeof(R2);
+		texture->width = width;
+		texture->height = height;
+		texture->srgb = internalFormat == GL_SRGB8_ALPHA8;
 	}
 
-	size += headerBytes;
+	streamElem(stream, texture->width);
+	streamElem(stream, texture->height);
+	streamElem(stream, texture->srgb);
 
-	void* result = NULL;
+	size_t pixelsSize = texture->width * texture->height * 4;
+	void* pixels = malloc(pixelsSize);
+	assert(pixels);
 
-	if(group->enabled) {
-		if (group->allocated + size < group->maxSize) {
-				result = (char*)group->base + group->allocated;
-				group->allocated += size;
-
-				RenderHeader* header = (RenderHeader*)result;
-				header->type_ = type;
-
-				if(group->hasClipRect) {
-					setRenderElemClipRect(header);
-					R2* clipRectPtr = (R2*)((char*)result + sizeof(RenderHeader));
-					*clipRectPtr = group->clipRect;
-				} 
-
-				if(!group->sortAddressCutoff) {
-					assert(group->numSortPtrs + 1 < arrayCount(group->sortPtrs));
-					group->sortPtrs[group->numSortPtrs++] = (RenderHeader*)result;
-				}
+	if(!stream->reading) {
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		group->appliedState.texture = 0;
+	}
 
-				result = (char*)result + headerBytes;
-		} else {
-			InvalidCodePath;
-		}
+	streamElem_(stream, pixels, pixelsSize);
+
+	if(stream->reading) {
+		texture->texId = createTex(group, texture->width, texture->height, 4, pixels, texture->srgb != 0).texId;
 	}
 
-	return result;
+	free(pixels);
 }
 
-void pushSortEnd(RenderGroup* group) {
-	group->sortAddressCutoff = group->allocated;
+void streamCapturedTextureValue(IOStream* stream, RenderCapture* capture, Texture* texture) {
+	s32 glTextureIndex = 0;
+	if(!stream->reading) glTextureIndex = addCapturedGLTexture(capture, texture->texId);
+
+	streamElem(stream, glTextureIndex);
+
+	if(stream->reading) {
+		assert(glTextureIndex >= 0 && glTextureIndex < capture->numGLTextures);
+		texture->texId = capture->glTextures[glTextureIndex].texId;
+	}
+
+	streamR2(stream, &texture->uv);
+	streamV2(stream, &texture->size);
+	streamR2(stream, &texture->trim);
 }
 
-RenderTexture createRenderTexture(DrawOrder drawOrder, Texture* texture, bool flipX, bool flipY,
-								Orientation orientation, float emissivity, Color color) {
-	RenderTexture result = {};
+void streamCapturedTexture(IOStream* stream, RenderCapture* capture, Texture** texturePtr) {
+	s32 textureIndex = -1;
 
-	assert(texture->texId);
+	if(stream->reading) {
+		readElem(stream, textureIndex);
+		assert(textureIndex >= 0 && textureIndex < capture->numTextures);
+		*texturePtr = capture->textures + textureIndex;
+	} else {
+		for(s32 index = 0; index < capture->numTextures; index++) {
+			if(capture->texturePtrs[index] == *texturePtr) {
+				textureIndex = index;
+				break;
+			}
+		}
 
-	result.drawOrder = drawOrder;
-	result.texture = texture;
-	result.flipX = flipX;
-	result.flipY = flipY;
-	result.orientation = orientation;
-	result.emissivity = emissivity;
-	result.color = color;
+		if(textureIndex < 0) {
+			assert(capture->numTextures < arrayCount(capture->textures));
+			textureIndex = capture->numTextures++;
+			capture->texturePtrs[textureIndex] = *texturePtr;
+			capture->textures[textureIndex] = **texturePtr;
+			addCapturedGLTexture(capture, (*texturePtr)->texId);
+		}
 
-	return result;
+		writeElem(stream, textureIndex);
+	}
 }
 
+void streamCapturedFont(IOStream* stream, RenderCapture* capture, CachedFont** fontPtr) {
+	s32 fontIndex = -1;
 
-#ifdef HACKFORMER_GAME
-//TODO: Cull console fields which are not currently visible
-void pushConsoleField(RenderGroup* group, FieldSpec* fieldSpec, ConsoleField* field, double alpha) {
-	assert(field);
-
-	if(group->rendering) {
-		renderDrawConsoleField(group, fieldSpec, field, alpha);
+	if(stream->reading) {
+		readElem(stream, fontIndex);
+		assert(fontIndex >= 0 && fontIndex < capture->numFonts);
+		*fontPtr = capture->fonts[fontIndex];
 	} else {
-		RenderConsoleField* render = pushRenderElement(group, RenderConsoleField);
+		for(s32 index = 0; index < capture->numFonts; index++) {
+			if(capture->fonts[index] == *fontPtr) {
+				fontIndex = index;
+				break;
+			}
+		}
 
-		if(render) {
-			render->field = field;
-			render->alpha = alpha;
+		if(fontIndex < 0) {
+			assert(capture->numFonts < arrayCount(capture->fonts));
+			fontIndex = capture->numFonts++;
+			capture->fonts[fontIndex] = *fontPtr;
 		}
+
+		writeElem(stream, fontIndex);
 	}
-} 
-#endif
+}
 
-void pushFilledStencil(RenderGroup* group, Texture* stencil, R2 bounds, double widthPercentage, Color color) {
-	assert(validTexture(stencil));
-	assert(widthPercentage >= 0 && widthPercentage <= 1);
+//NOTE: The text is written as its length followed by its characters
+void streamCapturedText(IOStream* stream, RenderGroup* group, RenderText* render) {
+	s32 length = 0;
+	if(!stream->reading) length = (s32)strlen(render->msg);
 
-	bounds = scaleRect(bounds, v2(1, 1) * group->camera->scale);
-	bounds.max.x = bounds.min.x + getRectWidth(bounds) * widthPercentage;
+	streamElem(stream, length);
+	assert(length >= 0);
 
-	if(rectanglesOverlap(group->windowBounds, bounds)) {
-		if(group->rendering) {
-			drawFilledStencil(group, stencil, bounds, widthPercentage, color);
-		} else {
-			RenderFilledStencil* render = pushRenderElement(group, RenderFilledStencil);
+	char* msg = render->msg;
 
-			if (render) {
-				render->stencil = stencil;
-				render->bounds = bounds;
-				render->widthPercentage = widthPercentage;
-				render->color = color;
+	if(stream->reading) {
+		msg = (char*)malloc(length + 1);
+		assert(msg);
+		msg[length] = 0;
+	}
+
+	if(length) streamElem_(stream, msg, length);
+
+	if(stream->reading) {
+		setRenderTextMsg(group, render, internString(group, msg), msg);
+		free(msg);
+	}
+}
+
+void streamCapturedStaticMesh(IOStream* stream, RenderCapture* capture, s32* meshIndex) {
+	s32 tableIndex = -1;
+
+	if(stream->reading) {
+		readElem(stream, tableIndex);
+		assert(tableIndex >= 0 && tableIndex < capture->numStaticMeshes);
+		*meshIndex = capture->firstStaticMesh + tableIndex;
+	} else {
+		for(s32 index = 0; index < capture->numStaticMeshes; index++) {
+			if(capture->staticMeshes[index] == *meshIndex) {
+				tableIndex = index;
+				break;
 			}
 		}
+
+		if(tableIndex < 0) {
+			assert(capture->numStaticMeshes < arrayCount(capture->staticMeshes));
+			tableIndex = capture->numStaticMeshes++;
+			capture->staticMeshes[tableIndex] = *meshIndex;
+		}
+
+		writeElem(stream, tableIndex);
 	}
 }
 
-void pushTexture(RenderGroup* group, Texture* texture, R2 bounds, double rotation, bool flipX = false, bool flipY = false, 
-	DrawOrder drawOrder = DrawOrder_gui, bool moveIntoCameraSpace = false, Color color = WHITE, float emissivity = 0) {
+void streamCapturedRenderTexture(IOStream* stream, RenderCapture* capture, RenderTexture* tex) {
+	streamElem(stream, tex->drawOrder);
+	streamCapturedTexture(stream, capture, &tex->texture);
+	streamElem(stream, tex->flipX);
+	streamElem(stream, tex->flipY);
+	streamElem(stream, tex->orientation);
+	streamElem(stream, tex->emissivity);
+	streamElem(stream, tex->color);
+}
 
-	assert(validTexture(texture));
+//NOTE: While capturing this writes the element at header and returns its size in the render group.
+//		While loading, the element is pushed onto the render group.
+size_t streamCapturedElem(IOStream* stream, RenderGroup* group, RenderCapture* capture, RenderHeader* header) {
+	RenderHeader streamedHeader = {};
+	R2 clipRect = {};
+	void* elemPtr = NULL;
+	size_t elemSize = sizeof(RenderHeader);
 
-	R2 drawBounds = bounds;
-	if(moveIntoCameraSpace) drawBounds = translateRect(bounds, -group->camera->p);
-	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
+	if(!stream->reading) {
+		streamedHeader = *header;
+		elemPtr = (char*)header + sizeof(RenderHeader);
 
-	R2 clipBounds = drawBounds;
+		if(renderElemClipRect(header)) {
+			clipRect = *(R2*)elemPtr;
+			elemPtr = (char*)elemPtr + sizeof(R2);
+			elemSize += sizeof(R2);
+		}
 
-	if(rotation) {
-		V2 halfSize = getRectSize(clipBounds) * 0.5;
-		double size = length(halfSize);
+		capture->numElems++;
+	}
 
-		clipBounds = rectCenterDiameter(getRectCenter(clipBounds), v2(size, size));
+	streamElem(stream, streamedHeader.type_);
+	if(renderElemClipRect(&streamedHeader)) streamR2(stream, &clipRect);
+
+	if(stream->reading) {
+		if(renderElemClipRect(&streamedHeader)) pushClipRect(group, clipRect);
+		else pushDefaultClipRect(group);
 	}
 
-	if(rectanglesOverlap(group->windowBounds, clipBounds)) {
-		if(group->rendering) {
-			if(rotation) {
-				drawTexture(group, texture, drawBounds, rotation, color, flipX, flipY, emissivity, group->ambient);
-			} else {
-				drawTexture(group, texture, drawBounds, flipX, flipY, Orientation_0, emissivity, group->ambient, color);
-			}
-		} else {
-			if(rotation) {
-				RenderRotatedTexture* render = pushRenderElement(group, RenderRotatedTexture);
+	#define START_CASE(type) case DrawType_##type: { \
+		if(stream->reading) elemPtr = pushRenderElement(group, group->frame, type); \
+		type* render = (type*)elemPtr; assert(render); elemSize += sizeof(type);
+	#define END_CASE } break
+
+	switch(getRenderHeaderType(&streamedHeader)) {
+
+		START_CASE(RenderBoundedTexture);
+			streamCapturedRenderTexture(stream, capture, &render->tex);
+			streamR2(stream, &render->bounds);
+		END_CASE;
+
+		START_CASE(RenderEntityTexture);
+			streamCapturedRenderTexture(stream, capture, &render->tex);
+			streamR2(stream, &render->bounds);
+			streamElem(stream, render->rotation);
+		END_CASE;
 
-				if (render) {
-					render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, Orientation_0, emissivity, color);
-					render->bounds = drawBounds;
-					render->rad = rotation;
+		START_CASE(RenderText);
+			streamCapturedFont(stream, capture, &render->font);
+			streamCapturedText(stream, group, render);
+			streamV2(stream, &render->p);
+			streamElem(stream, render->color);
+		END_CASE;
+
+		START_CASE(RenderConsoleField);
+			//NOTE: The elements of the field follow it, they are pushed into the field while they are being loaded
+			streamElem(stream, render->elemsSize);
+
+			s32 numElems = capture->numElems;
+			size_t elemsByteIndex = 0;
+			RenderFrame* frame = group->frame;
+
+			if(stream->reading) {
+				size_t elemsSize = render->elemsSize;
+				group->recordingField = render;
+				group->recordingFieldOffset = frame->lastBlock->used - sizeof(RenderConsoleField) - getRenderHeaderSize(group);
+
+				//NOTE: The field can be moved into a new block while its elements are being pushed
+				while((size_t)((getRenderBlockData(frame->lastBlock) + frame->lastBlock->used) - 
+					  (char*)(group->recordingField + 1)) < elemsSize) {
+					streamCapturedElem(stream, group, capture, NULL);
 				}
-			} else {
-				RenderBoundedTexture* render = pushRenderElement(group, RenderBoundedTexture);
 
-				if (render) {
-					render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, Orientation_0, emissivity, color);
-					render->bounds = drawBounds;
+				render = group->recordingField;
+				group->recordingField = NULL;
+				assert((getRenderBlockData(frame->lastBlock) + frame->lastBlock->used) - (char*)(render + 1) == (ptrdiff_t)elemsSize);
+			} else {
+				while(elemsByteIndex < render->elemsSize) {
+					RenderHeader* elemHeader = (RenderHeader*)((char*)(render + 1) + elemsByteIndex);
+					elemsByteIndex += streamCapturedElem(stream, group, capture, elemHeader);
 				}
 			}
-		}
-	}
-}
 
-void pushTexture(RenderGroup* group, Texture* texture, R2 bounds, bool flipX, bool flipY, DrawOrder drawOrder, 
-				 bool moveIntoCameraSpace, Orientation orientation, Color color, float emissivity) {
+			capture->numElems = numElems;
+			elemSize += render->elemsSize;
+		END_CASE;
 
-	assert(validTexture(texture));
+		START_CASE(RenderFillRect);
+			streamR2(stream, &render->bounds);
+			streamElem(stream, render->color);
+		END_CASE;
 
-	R2 drawBounds = moveIntoCameraSpace ? translateRect(bounds, -group->camera->p) : bounds;
-	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
+		START_CASE(RenderOutlinedRect);
+			streamR2(stream, &render->bounds);
+			streamElem(stream, render->color);
+			streamElem(stream, render->thickness);
+		END_CASE;
 
-	if(rectanglesOverlap(group->windowBounds, drawBounds)) {
-		if(group->rendering) {
-			drawTexture(group, texture, drawBounds, flipX, flipY, orientation, emissivity, group->ambient, color);
-		} else {
-			RenderBoundedTexture* render = pushRenderElement(group, RenderBoundedTexture);
+		START_CASE(RenderDashedLine);
+			streamElem(stream, render->color);
+			streamV2(stream, &render->lineStart);
+			streamV2(stream, &render->lineEnd);
+			streamElem(stream, render->thickness);
+			streamElem(stream, render->dashSize);
+			streamElem(stream, render->spaceSize);
+		END_CASE;
 
-			if (render) {
-				render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, orientation, emissivity, color);
-				render->bounds = drawBounds;
-			}
-		}
+		START_CASE(RenderRotatedTexture);
+			streamCapturedRenderTexture(stream, capture, &render->tex);
+			streamR2(stream, &render->bounds);
+			streamElem(stream, render->rad);
+		END_CASE;
+
+		START_CASE(RenderFilledStencil);
+			streamCapturedTexture(stream, capture, &render->stencil);
+			streamR2(stream, &render->bounds);
+			streamElem(stream, render->widthPercentage);
+			streamElem(stream, render->color);
+		END_CASE;
+
+		START_CASE(RenderStaticMesh);
+			streamCapturedStaticMesh(stream, capture, &render->meshIndex);
+			streamV2(stream, &render->cameraP);
+		END_CASE;
+
+		InvalidDefaultCase;
 	}
+
+	#undef START_CASE
+	#undef END_CASE
+
+	return elemSize;
 }
 
-void pushDashedLine(RenderGroup* group, Color color, V2 lineStart, V2 lineEnd, double thickness,
-					 double dashSize, double spaceSize, bool moveIntoCameraSpace = false) {
-	if(lineStart == lineEnd) return;
+bool32 streamRenderCaptureHeader(IOStream* stream, RenderCapture* capture) {
+	u32 magic = RENDER_CAPTURE_MAGIC;
+	s32 version = RENDER_CAPTURE_VERSION;
 
-	V2 lineCenter = (lineStart + lineEnd) * 0.5;
-	lineStart = lineCenter + (lineStart - lineCenter) * group->camera->scale;
-	lineEnd = lineCenter + (lineEnd - lineCenter) * group->camera->scale;
+	streamElem(stream, magic);
+	streamElem(stream, version);
 
-	if(moveIntoCameraSpace) {
-		lineStart -= group->camera->p;
-		lineEnd -= group->camera->p;
+	bool32 result = magic == RENDER_CAPTURE_MAGIC && version == RENDER_CAPTURE_VERSION;
+
+	if(result) {
+		streamElem(stream, capture->windowWidth);
+		streamElem(stream, capture->windowHeight);
+		streamElem(stream, capture->pixelsPerMeter);
+		streamElem(stream, capture->lightingEnabled);
+		streamElem(stream, capture->glowTime);
+		streamR2(stream, &capture->defaultClipRect);
+		streamElem(stream, capture->numElems);
+		streamElem(stream, capture->numSortedElems);
+	}
+
+	return result;
+}
+
+//NOTE: The tables have to be streamed before the elements, since the elements refer to them by index
+void streamRenderCaptureTables(IOStream* stream, RenderGroup* group, RenderCapture* capture) {
+	streamElem(stream, capture->numPointLights);
+	for(s32 lightIndex = 0; lightIndex < capture->numPointLights; lightIndex++) {
+		streamElem(stream, capture->pointLights[lightIndex]);
+	}
+
+	streamElem(stream, capture->numSpotLights);
+	for(s32 lightIndex = 0; lightIndex < capture->numSpotLights; lightIndex++) {
+		streamElem(stream, capture->spotLights[lightIndex]);
 	}
 
-	//TODO: No need to push lines on if they aren't visible
+	streamElem(stream, capture->numGLTextures);
+	assert(capture->numGLTextures <= arrayCount(capture->glTextures));
 
-	if(group->rendering) {
-		drawDashedLine(group, color, lineStart, lineEnd, thickness, dashSize, spaceSize);
-	} else {
-		RenderDashedLine* render = pushRenderElement(group, RenderDashedLine);
+	for(s32 textureIndex = 0; textureIndex < capture->numGLTextures; textureIndex++) {
+		streamCapturedGLTexture(stream, group, capture->glTextures + textureIndex);
+	}
 
-		if (render) {
-			render->color = color;
-			render->lineStart = lineStart;
-			render->lineEnd = lineEnd;
-			render->thickness = thickness;
-			render->dashSize = dashSize;
-			render->spaceSize = spaceSize;
-		}
+	streamElem(stream, capture->numTextures);
+	assert(capture->numTextures <= arrayCount(capture->textures));
+
+	for(s32 textureIndex = 0; textureIndex < capture->numTextures; textureIndex++) {
+		streamCapturedTextureValue(stream, capture, capture->textures + textureIndex);
 	}
-}
 
-#ifdef HACKFORMER_GAME
-void pushEntityTexture(RenderGroup* group, Texture* texture, Entity* entity, DrawOrder drawOrder, 
-					bool fadeAlphaFromDisappearing,  Color color = WHITE) {
-	assert(texture);
+	streamElem(stream, capture->numFonts);
+	assert(capture->numFonts <= arrayCount(capture->fonts));
 
-	if (entity->type == EntityType_laserBeam && !isSet(entity, EntityFlag_laserOn)) return;
-	bool32 cloaked = isSet(entity, EntityFlag_cloaked) && !isSet(entity, EntityFlag_togglingCloak);
-	if(cloaked) return;
+	for(s32 fontIndex = 0; fontIndex < capture->numFonts; fontIndex++) {
+		if(stream->reading) {
+			capture->fonts[fontIndex] = pushStruct(capture->arena, CachedFont);
+			*capture->fonts[fontIndex] = {};
+		}
 
-	R2 drawBounds = translateRect(rectCenterDiameter(entity->p, entity->renderSize), -group->camera->p);
-	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
+		//NOTE: A loaded font doesn't have a TTF_Font, so it can only draw the glyphs which were captured
+		CachedFont* font = capture->fonts[fontIndex];
+		streamElem(stream, font->scaleFactor);
+		streamElem(stream, font->lineHeight);
 
-	R2 clipBounds = scaleRect(drawBounds, v2(1, 1) * 1.05);
+		for(s32 glyphIndex = 0; glyphIndex < arrayCount(font->cache); glyphIndex++) {
+			Glyph* glyph = font->cache + glyphIndex;
 
-	double alpha = entity->alpha;
+			bool32 hasGlyph = glyph->tex.texId != 0;
+			streamElem(stream, hasGlyph);
 
-	//TODO: This won't properly blend the alpha
-	//		The mothership would have to rendered at full alpha into an intermidiate texture
-	//		And then that texture would be rendered with less alpha to the screen
-	//		Otherwise, parts of lower layers that shouldn't be visible will become visible 
-	if(fadeAlphaFromDisappearing) {
-		alpha = max(0, alpha - entity->cloakFactor);
+			if(hasGlyph) {
+				streamCapturedTextureValue(stream, capture, &glyph->tex);
+				streamR2(stream, &glyph->padding);
+			}
+		}
 	}
 
-	color.a = (u8)(color.a * alpha);
+	streamElem(stream, capture->numStaticMeshes);
+	assert(capture->numStaticMeshes <= arrayCount(capture->staticMeshes));
 
-	double rotation = entity->rotation;
+	for(s32 tableIndex = 0; tableIndex < capture->numStaticMeshes; tableIndex++) {
+		s32 meshIndex = stream->reading ? capture->firstStaticMesh + tableIndex : capture->staticMeshes[tableIndex];
+		assert(meshIndex >= 0 && meshIndex < MAX_STATIC_MESHES);
 
-	if(rotation) {
-		V2 halfSize = getRectSize(clipBounds) * 0.5;
-		double size = length(halfSize);
+		StaticMesh* mesh = group->staticMeshes + meshIndex;
+		if(stream->reading) beginStaticMesh(group, meshIndex);
 
-		clipBounds = rectCenterDiameter(getRectCenter(clipBounds), v2(size, size));
-	}
+		streamElem(stream, mesh->numQuads);
+		streamElem(stream, mesh->numRuns);
+		assert(mesh->numQuads <= MAX_STATIC_MESH_QUADS && mesh->numRuns <= MAX_STATIC_MESH_RUNS);
 
-	bool flipX = isSet(entity, EntityFlag_facesLeft) != 0;
-	if (entity->type == EntityType_laserBase) flipX = false;
-	bool flipY = isSet(entity, EntityFlag_flipY) != 0;
+		for(s32 runIndex = 0; runIndex < mesh->numRuns; runIndex++) {
+			StaticMeshRun* run = mesh->runs + runIndex;
 
-	if(rectanglesOverlap(group->windowBounds, clipBounds)) {
-		if(isTileType(entity) && getMovementField(entity) != NULL) drawOrder = DrawOrder_movingTile;
+			s32 glTextureIndex = 0;
+			if(!stream->reading) glTextureIndex = addCapturedGLTexture(capture, run->texture);
 
-		if(group->rendering) {
-			if(rotation) {
-				drawTexture(group, texture, drawBounds, rotation, color, flipX, flipY, entity->emissivity, group->ambient);
-			} else {
-				drawTexture(group, texture, drawBounds, flipX, flipY, Orientation_0, entity->emissivity, group->ambient, color);
-			}
-		} else {
-			RenderEntityTexture* render = pushRenderElement(group, RenderEntityTexture);
+			streamElem(stream, glTextureIndex);
+			if(stream->reading) run->texture = capture->glTextures[glTextureIndex].texId;
 
-			if (render) {
-				render->tex = createRenderTexture(drawOrder, texture, flipX, flipY, Orientation_0, entity->emissivity, color);
-				render->p = &entity->p;
-				render->renderSize = &entity->renderSize;
-				render->rotation = rotation;
-			}
+			streamElem(stream, run->firstQuad);
+			streamElem(stream, run->numQuads);
+		}
+
+		size_t verticesSize = mesh->numQuads * 4 * sizeof(BatchVertex);
+
+		if(!stream->reading && verticesSize) {
+			glBindBuffer(GL_ARRAY_BUFFER, mesh->vertexBuffer);
+			glGetBufferSubData(GL_ARRAY_BUFFER, 0, verticesSize, group->staticMeshVertices);
+			glBindBuffer(GL_ARRAY_BUFFER, group->vertexBuffer);
 		}
+
+		streamElem_(stream, group->staticMeshVertices, verticesSize);
+
+		if(stream->reading) endStaticMesh(group);
 	}
 }
 
-#endif
+//NOTE: This is called by drawRenderFrame once the elements have been sorted
+void captureRenderGroup(RenderGroup* group, RenderFrame* frame, char* fileName) {
+	assert(group->buildingStaticMesh == -1);
 
-void pushText(RenderGroup* group, CachedFont* font, char* msg, V2 p, Color color = BLACK,
-			  TextAlignment alignment = TextAlignment_bottomLeft) {
+	//NOTE: The textures and static meshes are read back from GL
+	if(group->backend != RenderBackend_gl) {
+		fprintf(stderr, "Render captures can only be made with the GL backend\n");
+		return;
+	}
 
-	switch(alignment) {
-		case TextAlignment_center: {
-			V2 strSize = getTextSize(font, group, msg);
-			p -= v2(strSize.x, strSize.y) * 0.5;
-		} break;
+	RenderCapture* capture = (RenderCapture*)calloc(1, sizeof(RenderCapture));
+	assert(capture);
 
-		case TextAlignment_bottomLeft:
-			break;
+	//NOTE: The elements are written to memory first, since that is what fills in the tables
+	size_t frameSize = 0;
 
-		InvalidDefaultCase;
+	for(RenderBlock* block = frame->firstBlock; block; block = block->next) {
+		frameSize += block->used;
 	}
 
+	MemoryArena elemArena;
+	initArena(&elemArena, frameSize * 2 + KILOBYTES(1), false);
+	IOStream elemStream = createIostream(NULL, &elemArena);
 
-	if(group->rendering) {
-		drawText(group, font, msg, p, color);
-	} else {
-		RenderText* render = pushRenderElement(group, RenderText);
+	for(s32 elemIndex = 0; elemIndex < frame->numSortPtrs; elemIndex++) {
+		streamCapturedElem(&elemStream, group, capture, frame->sortPtrs[elemIndex]);
+	}
 
-		if (render) {
-			assert(strlen(msg) < arrayCount(render->msg) - 1);
+	capture->numSortedElems = capture->numElems;
 
-			char* dstPtr = (char*)render->msg;
+	if(frame->sortEnded) {
+		size_t blockByteIndex = frame->sortEndOffset;
 
-			while(*msg) {
-				*dstPtr++ = *msg++;
+		for(RenderBlock* block = frame->sortEndBlock ? frame->sortEndBlock : frame->firstBlock; block; block = block->next) {
+			while(blockByteIndex < block->used) {
+				RenderHeader* header = (RenderHeader*)(getRenderBlockData(block) + blockByteIndex);
+				blockByteIndex += streamCapturedElem(&elemStream, group, capture, header);
 			}
-			*dstPtr = 0;
 
-			render->p = p;
-			render->font = font;
-			render->color = color;
+			blockByteIndex = 0;
 		}
 	}
-}
 
-void pushFilledRect(RenderGroup* group, R2 bounds, Color color, bool moveIntoCameraSpace = false) {
-	R2 drawBounds = moveIntoCameraSpace ? translateRect(bounds, -group->camera->p) : bounds;
-	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
+	for(s32 fontIndex = 0; fontIndex < capture->numFonts; fontIndex++) {
+		CachedFont* font = capture->fonts[fontIndex];
 
-	if(rectanglesOverlap(group->windowBounds, drawBounds)) {
-		if(group->rendering) {
-			drawFillRect(group, drawBounds, color);
-		} else {
-			RenderFillRect* render = pushRenderElement(group, RenderFillRect);
+		for(s32 glyphIndex = 0; glyphIndex < arrayCount(font->cache); glyphIndex++) {
+			if(font->cache[glyphIndex].tex.texId) addCapturedGLTexture(capture, font->cache[glyphIndex].tex.texId);
+		}
+	}
 
-			if (render) {
-				render->color = color;
-				render->bounds = drawBounds;
-			}
+	for(s32 tableIndex = 0; tableIndex < capture->numStaticMeshes; tableIndex++) {
+		StaticMesh* mesh = group->staticMeshes + capture->staticMeshes[tableIndex];
+
+		for(s32 runIndex = 0; runIndex < mesh->numRuns; runIndex++) {
+			addCapturedGLTexture(capture, mesh->runs[runIndex].texture);
 		}
 	}
-}
 
-void pushOutlinedRect(RenderGroup* group, R2 bounds, double thickness, Color color, bool moveIntoCameraSpace = false) {
-	R2 drawBounds = moveIntoCameraSpace ? translateRect(bounds, -group->camera->p) : bounds;
-	drawBounds = scaleRect(drawBounds, v2(1, 1) * group->camera->scale);
+	capture->windowWidth = group->windowWidth;
+	capture->windowHeight = group->windowHeight;
+	capture->pixelsPerMeter = group->pixelsPerMeter;
+	capture->lightingEnabled = frame->lightingEnabled;
+	capture->glowTime = frame->glowTime;
+	capture->defaultClipRect = frame->defaultClipRect;
 
-	if(rectanglesOverlap(group->windowBounds, addDiameterTo(drawBounds, v2(1, 1) * thickness))) {
-		if(group->rendering) {
-			drawOutlinedRect(group, drawBounds, color, thickness);
-		} else {
+	capture->numPointLights = frame->numPointLights;
+	memcpy(capture->pointLights, frame->pointLights, frame->numPointLights * sizeof(PointLight));
+	capture->numSpotLights = frame->numSpotLights;
+	memcpy(capture->spotLights, frame->spotLights, frame->numSpotLights * sizeof(SpotLight));
 
-			RenderOutlinedRect* render = pushRenderElement(group, RenderOutlinedRect);
+	IOStream stream = createIostream(NULL, fileName, false);
 
-			if (render) {
-				render->thickness = thickness;
-				render->color = color;
-				render->bounds = drawBounds;
-			}
-		}
+	if(stream.file) {
+		streamRenderCaptureHeader(&stream, capture);
+		streamRenderCaptureTables(&stream, group, capture);
+		writeElem_(&stream, elemArena.base, elemArena.allocated);
+
+		printf("Captured %d render elements to %s\n", capture->numElems, fileName);
+	} else {
+		fprintf(stderr, "Failed to open %s for the render capture\n", fileName);
 	}
+
+	freeIostream(&stream);
+	free(elemArena.base);
+	free(capture);
 }
 
-PointLight createPointLight(V3 p, V3 color, double range) {
-	PointLight result = {};
+bool32 loadRenderCaptureHeader(RenderCapture* capture, char* fileName) {
+	IOStream stream = createIostream(NULL, fileName, true);
 
-	result.p = p;
-	result.color = color;
-	result.range = range;
+	bool32 result = stream.file && streamRenderCaptureHeader(&stream, capture);
 
+	freeIostream(&stream);
 	return result;
 }
 
-SpotLight createSpotLight(V2 p, V3 color, double range, double angle, double spread) {
-	SpotLight result = {};
+//NOTE: The textures, fonts and static meshes of the frame are loaded into the render group, and the elements are 
+//		pushed onto it once and then the capture takes the frame. capture->arena and capture->firstStaticMesh have 
+//		to be set.
+bool32 loadRenderCapture(RenderGroup* group, RenderCapture* capture, char* fileName) {
+	RenderFrame* frame = group->frame;
+	assert(!frame->firstBlock && frame->numSortPtrs == 0);
+	assert(capture->arena);
 
-	result.base = createPointLight(v3(p, 0), color, range);
-	result.angle = angle;
-	result.spread = spread;
+	IOStream stream = createIostream(NULL, fileName, true);
 
-	return result;
-}
+	bool32 result = stream.file && streamRenderCaptureHeader(&stream, capture);
 
-PointLight getRenderablePointLight(PointLight* light, bool moveIntoCameraSpace, V2 negativeCameraP) {
-	assert(light->range > 0);
+	if(result) {
+		streamRenderCaptureTables(&stream, group, capture);
 
-	PointLight result = *light;
-	if (moveIntoCameraSpace) result.p += v3(negativeCameraP, 0);
+		for(s32 elemIndex = 0; elemIndex < capture->numElems; elemIndex++) {
+			if(elemIndex == capture->numSortedElems) pushSortEnd(group);
+			streamCapturedElem(&stream, group, capture, NULL);
+		}
 
-	return result;
-}
+		pushDefaultClipRect(group);
 
-void pushPointLight(RenderGroup* group, PointLight* pl, bool moveIntoCameraSpace = false) {
-	if(group->enabled) {
-		if(group->forwardShader.numPointLights + 1 < arrayCount(group->forwardShader.pointLights)) {
-			PointLight* light = group->forwardShader.pointLights + group->forwardShader.numPointLights;
-			group->forwardShader.numPointLights++;
+		//NOTE: The blocks and sort arrays now belong to the capture, the group's frame starts over without them
+		capture->frame = *frame;
+		*frame = {};
 
-			*light = getRenderablePointLight(pl, moveIntoCameraSpace, -group->camera->p);
-		} else {
-			InvalidCodePath;
-		}
+		RenderFrame* loadedFrame = &capture->frame;
+		loadedFrame->lightingEnabled = capture->lightingEnabled;
+		loadedFrame->glowTime = capture->glowTime;
+		loadedFrame->defaultClipRect = capture->defaultClipRect;
+
+		loadedFrame->numPointLights = capture->numPointLights;
+		memcpy(loadedFrame->pointLights, capture->pointLights, capture->numPointLights * sizeof(PointLight));
+		loadedFrame->numSpotLights = capture->numSpotLights;
+		memcpy(loadedFrame->spotLights, capture->spotLights, capture->numSpotLights * sizeof(SpotLight));
 	}
+
+	freeIostream(&stream);
+	return result;
 }
 
-void pushSpotLight(RenderGroup* group, SpotLight* sl, bool moveIntoCameraSpace = false) {
-	if(group->enabled) {
-		if(group->forwardShader.numSpotLights + 1 < arrayCount(group->forwardShader.spotLights)) {
-			SpotLight* light = group->forwardShader.spotLights + group->forwardShader.numSpotLights;
-			group->forwardShader.numSpotLights++;
+//NOTE: This is called on the game thread once everything has been pushed
+void endRenderFrame(RenderGroup* group, RenderFrame* frame) {
+	frame->defaultClipRect = group->defaultClipRect;
+	frame->lightingEnabled = group->lightingEnabled;
+	frame->glowTime = group->glowTime;
+	frame->captureFileName = group->captureFileName;
 
-			light->base = getRenderablePointLight(&sl->base, moveIntoCameraSpace, -group->camera->p);
-			light->angle = sl->angle;
-			light->spread = sl->spread;
-		} else {
-			InvalidCodePath;
-		}
+	group->captureFileName = NULL;
+	pushDefaultClipRect(group);
+
+	if(group->sceneTarget.enabled && group->window) {
+		SDL_GL_GetDrawableSize(group->window, &frame->drawableWidth, &frame->drawableHeight);
 	}
 }
 
+//NOTE: This has to be called while the game thread has the GL context, before the render thread is started
+void initSceneTarget(RenderGroup* group, double minScale) {
+	if(group->backend != RenderBackend_gl) return;
 
-void pushClipRect(RenderGroup* group, R2 clipRect) {
-	group->clipRect = clipRect;
-	group->hasClipRect = true;
-}
+	SceneTarget* target = &group->sceneTarget;
+	target->enabled = true;
+	target->scale = 1;
+	target->minScale = clamp(minScale, 0.1, 1);
 
-void pushDefaultClipRect(RenderGroup* group) {
-	group->hasClipRect = false;
+	glGenFramebuffers(1, &target->framebuffer);
+	glGenTextures(1, &target->texture);
+	glGenQueries(arrayCount(target->timerQueries), target->timerQueries);
 }
 
-size_t drawRenderElem(RenderGroup* group, FieldSpec* fieldSpec, void* elemPtr, GLfloat ambient, bool pastSortEnd) {
-	RenderHeader* header = (RenderHeader*)elemPtr;
-	size_t elemSize = sizeof(RenderHeader);
+void resizeSceneTarget(RenderGroup* group, SceneTarget* target, s32 width, s32 height) {
+	glBindTexture(GL_TEXTURE_2D, target->texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	group->appliedState.texture = target->texture;
 
-	elemPtr = (char*)elemPtr + sizeof(RenderHeader);
+	glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->texture, 0);
+	assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
 
-	if (renderElemClipRect(header)) {
-		R2* clipBounds = (R2*)elemPtr;
-		elemPtr = (char*)elemPtr + sizeof(R2);
-		elemSize += sizeof(R2);
-		setClipRect(group->pixelsPerMeter, *clipBounds);
-	} else if(pastSortEnd) {
-		glDisable(GL_SCISSOR_TEST);
-	} else {
-		setClipRect(group->pixelsPerMeter, group->defaultClipRect);
-	}
+	target->textureWidth = width;
+	target->textureHeight = height;
+}
 
-	#define START_CASE(type) case DrawType_##type: { type* render = (type*)elemPtr; elemSize += sizeof(type);
-	#define END_CASE } break
+void updateRenderScale(SceneTarget* target) {
+	while(target->pendingTimerQueries) {
+		s32 queryIndex = (target->nextTimerQuery - target->pendingTimerQueries + SCENE_TIMER_QUERIES) % SCENE_TIMER_QUERIES;
+		GLuint query = target->timerQueries[queryIndex];
 
-	switch(getRenderHeaderType(header)) {
+		GLint available = 0;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if(!available) break;
 
-		START_CASE(RenderBoundedTexture);
-			drawTexture(group, render->tex.texture, render->bounds, render->tex.flipX != 0, render->tex.flipY != 0, 
-						render->tex.orientation, render->tex.emissivity, ambient, render->tex.color);
-		END_CASE;
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
 
-		START_CASE(RenderEntityTexture);
-			R2 bounds = rectCenterDiameter(*render->p - group->camera->p, *render->renderSize);
+		target->gpuSecondsSum += nanoseconds * 1e-9;
+		target->gpuSecondsCount++;
+		target->pendingTimerQueries--;
+	}
 
-			if(render->rotation) {
-				drawTexture(group, render->tex.texture, bounds, render->rotation, render->tex.color, render->tex.flipX != 0, 
-							render->tex.flipY != 0, render->tex.emissivity, group->ambient);
-			} else {
-				drawTexture(group, render->tex.texture, bounds, render->tex.flipX != 0, render->tex.flipY != 0,
-							render->tex.orientation, render->tex.emissivity, ambient, render->tex.color);
-			}
-		END_CASE;
+	if(target->gpuSecondsCount >= RENDER_SCALE_FRAMES) {
+		double gpuSeconds = target->gpuSecondsSum / target->gpuSecondsCount;
+		double scale = target->scale;
 
-		START_CASE(RenderText);
-			drawText(group, render->font, render->msg, render->p, render->color);
-		END_CASE;
+		if(gpuSeconds > TARGET_GPU_SECONDS) {
+			//NOTE: The time mostly goes with the number of pixels, which goes with the square of the scale
+			scale *= max(0.75, sqrt(TARGET_GPU_SECONDS / gpuSeconds));
+		}
+		else if(gpuSeconds < TARGET_GPU_SECONDS * 0.7) {
+			scale += RENDER_SCALE_STEP;
+		}
 
-		START_CASE(RenderFillRect);
-			drawFillRect(group, render->bounds, render->color);
-		END_CASE;
+		target->scale = clamp(scale, target->minScale, 1);
+		target->gpuSeconds = gpuSeconds;
+		target->gpuSecondsSum = 0;
+		target->gpuSecondsCount = 0;
+	}
+}
 
-		START_CASE(RenderOutlinedRect);
-			drawOutlinedRect(group, render->bounds, render->color, render->thickness);
-		END_CASE;
+void beginSceneTarget(RenderGroup* group, RenderFrame* frame) {
+	SceneTarget* target = &group->sceneTarget;
+	if(!target->enabled || frame->drawableWidth <= 0 || frame->drawableHeight <= 0) return;
 
-		#ifdef HACKFORMER_GAME
-		START_CASE(RenderConsoleField);
-			renderDrawConsoleField(group, fieldSpec, render->field, render->alpha);
-		END_CASE;
-		#endif
+	updateRenderScale(target);
 
-		START_CASE(RenderDashedLine);
-			drawDashedLine(group, render->color, render->lineStart, render->lineEnd, render->thickness, render->dashSize, render->spaceSize);
-		END_CASE;
+	target->drawableWidth = frame->drawableWidth;
+	target->drawableHeight = frame->drawableHeight;
+	target->viewport = getLetterboxRect(frame->drawableWidth, frame->drawableHeight, group->windowWidth, group->windowHeight);
 
-		START_CASE(RenderRotatedTexture);
-			drawTexture(group, render->tex.texture, render->bounds, render->rad, render->tex.color,
-					    render->tex.flipX != 0, false, render->tex.emissivity, group->ambient);
-		END_CASE;
+	if(target->viewport.w > target->textureWidth || target->viewport.h > target->textureHeight) {
+		resizeSceneTarget(group, target, target->viewport.w, target->viewport.h);
+	}
 
-		START_CASE(RenderFilledStencil);
-			drawFilledStencil(group, render->stencil, render->bounds, render->widthPercentage, render->color);
-		END_CASE;
+	target->width = max(1, (s32)(target->viewport.w * target->scale + 0.5));
+	target->height = max(1, (s32)(target->viewport.h * target->scale + 0.5));
 
-		InvalidDefaultCase;
+	glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+	glViewport(0, 0, target->width, target->height);
+
+	//NOTE: The scissor rect has to be applied again, since it depends on the size of the target
+	if(group->appliedState.scissorEnabled) {
+		glDisable(GL_SCISSOR_TEST);
+		group->appliedState.scissorEnabled = false;
 	}
+	group->appliedState.scissorRect = r2(v2(-1, -1), v2(-1, -1));
 
-	#undef START_CASE
-	#undef END_CASE
+	glClearColor(0, 0, 0, 1);
+	glClear(GL_COLOR_BUFFER_BIT);
 
-	return elemSize;
-}
+	if(target->pendingTimerQueries < SCENE_TIMER_QUERIES) {
+		glBeginQuery(GL_TIME_ELAPSED, target->timerQueries[target->nextTimerQuery]);
+		target->timingFrame = true;
+	}
 
-bool isRenderTextureType(DrawType type) {
-	bool result = (type == DrawType_RenderEntityTexture) || (type == DrawType_RenderBoundedTexture);
-	return result;
+	target->active = true;
+
+	group->stats.renderScale = target->scale;
+	group->stats.gpuMilliseconds = target->gpuSeconds * 1000.0;
 }
 
-RenderTexture* getRenderTexture(RenderHeader* header) {
-	assert(isRenderTextureType(getRenderHeaderType(header)));
+//NOTE: The letterbox bars were cleared by clearScreen, the target is only drawn over the viewport
+void resolveSceneTarget(RenderGroup* group) {
+	SceneTarget* target = &group->sceneTarget;
+	if(!target->active) return;
 
-	RenderTexture* result = (RenderTexture*)((char*)header + sizeof(RenderHeader));
+	flushBatch(group);
 
-	if(renderElemClipRect(header)) {
-		result = (RenderTexture*)((char*)result + sizeof(R2));
+	if(target->timingFrame) {
+		glEndQuery(GL_TIME_ELAPSED);
+		target->nextTimerQuery = (target->nextTimerQuery + 1) % SCENE_TIMER_QUERIES;
+		target->pendingTimerQueries++;
+		target->timingFrame = false;
 	}
 
-	return result;
-}
+	target->active = false;
 
-ConsoleField* getConsoleFieldFromRenderHeader(RenderHeader* header) {
-	assert(getRenderHeaderType(header) == DrawType_RenderConsoleField);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(target->viewport.x, target->viewport.y, target->viewport.w, target->viewport.h);
 
-	void* render = (char*)header + sizeof(RenderHeader);
+	bindShader(group, &group->upscaleShader);
+	disableClipRect(group);
+	group->requestedState.texture = target->texture;
+	group->stats.stateRequests++;
 
-	if(renderElemClipRect(header)) {
-		render = (char*)render + sizeof(R2);
-	}
+	R2 bounds = group->windowBounds;
+	V2 uvMax = v2((double)target->width / target->textureWidth, (double)target->height / target->textureHeight);
 
-	ConsoleField* result = ((RenderConsoleField*)render)->field;
+	V2 p[4] = {bounds.min, v2(bounds.max.x, bounds.min.y), bounds.max, v2(bounds.min.x, bounds.max.y)};
+	V2 uv[4] = {v2(0, 0), v2(uvMax.x, 0), uvMax, v2(0, uvMax.y)};
 
-	return result;
+	addQuadToBatch(group, p, uv, WHITE, 0);
+	flushBatch(group);
 }
 
-s32 renderElemCompare(const void* a, const void* b) {
-	RenderHeader* e1 = *(RenderHeader**)a;
-	RenderHeader* e2 = *(RenderHeader**)b;
-
-	DrawType e1Type = getRenderHeaderType(e1);
-	DrawType e2Type = getRenderHeaderType(e2);
+void drawRenderFrame(RenderGroup* group, RenderFrame* frame) {
+	group->stats = {};
+	group->stats.cull = frame->cullStats;
 
-	bool e1IsRenderTexture = isRenderTextureType(e1Type);
-	bool e2IsRenderTexture = isRenderTextureType(e2Type);
+	sortRenderElems(group, frame);
 
-	bool e1IsRenderTextureOrConsoleField = e1IsRenderTexture;
-	bool e2IsRenderTextureOrConsoleField = e2IsRenderTexture;
+	if(frame->captureFileName) {
+		captureRenderGroup(group, frame, frame->captureFileName);
+	}
 
-	#ifdef HACKFORMER_GAME
-	bool e1IsConsoleField = e1Type == DrawType_RenderConsoleField;
-	bool e2IsConsoleField = e2Type == DrawType_RenderConsoleField;
+	if(group->backend == RenderBackend_gl) {
+		beginSceneTarget(group, frame);
+	}
 
-	if(e1IsConsoleField && e2IsConsoleField) {
-		ConsoleField* f1 = getConsoleFieldFromRenderHeader(e1);
-		ConsoleField* f2 = getConsoleFieldFromRenderHeader(e2);
+	bindShader(group, &group->forwardShader.shader);
 
-		if(f1->p.y > f2->p.y) return 1;
-		if(f1->p.y < f2->p.y) return -1;
+	group->ambient = frame->lightingEnabled ? (GLfloat)0.35 : (GLfloat)0.5;
+	setAmbient(group, group->ambient);
 
-		//NOTE: Arbitrary comparisons done to help ensure a consistent render order across frames
-		if(f1->p.x > f2->p.x) return 1;
-		if(f1->p.x < f2->p.x) return -1;
-		return *f1->name > *f2->name;
-	}
+	group->requestedState.glowTime = frame->glowTime;
+	group->stats.stateRequests++;
 
-	e1IsRenderTextureOrConsoleField |= e1IsConsoleField;
-	e2IsRenderTextureOrConsoleField |= e2IsConsoleField;
-	#endif
+	//NOTE: The lighting uniform is set directly, so the forward shader has to be bound first
+	applyRenderState(group);
 
-	if(e1IsRenderTextureOrConsoleField) {
-		if(!e2IsRenderTextureOrConsoleField) return -1;
+	ForwardShader* forwardShader = &group->forwardShader;
+	group->stats.stateRequests++;
 
-		RenderTexture* r1 = NULL;
-		if(e1IsRenderTexture) r1 = getRenderTexture(e1);
-		RenderTexture* r2 = NULL;
-		if(e2IsRenderTexture) r2 = getRenderTexture(e2);
+	//NOTE: The other backends don't do any lighting
+	if(group->backend == RenderBackend_gl) {
+		if(forwardShader->lightingEnabledValue != frame->lightingEnabled) {
+			glUniform1i(forwardShader->lightingEnabledUniform, frame->lightingEnabled ? 1 : 0);
+			forwardShader->lightingEnabledValue = frame->lightingEnabled;
+			group->stats.stateChanges++;
+		}
 
-		#ifdef HACKFORMER_GAME
-		DrawOrder r1DrawOrder = (r1 == NULL ? DrawOrder_pickupField : r1->drawOrder);
-		DrawOrder r2DrawOrder = (r2 == NULL ? DrawOrder_pickupField : r2->drawOrder);
-		#else 
-		DrawOrder r1DrawOrder = r1->drawOrder;
-		DrawOrder r2DrawOrder = r2->drawOrder;
-		#endif
+		if(frame->lightingEnabled) {
+			updateLightTiles(group, frame);
+		}
+	}
 
-		if(r1DrawOrder > r2DrawOrder) return 1;
-		if(r1DrawOrder < r2DrawOrder) return -1;
+	for(s32 elemIndex = 0; elemIndex < frame->numSortPtrs; elemIndex++) {
+		void* elemPtr = frame->sortPtrs[elemIndex];
+		drawRenderElem(group, frame, elemPtr, false);
+	}
 
-		assert(r1);
-		assert(r2);
+	bindShader(group, &group->basicShader);
 
-		double r1MinY, r2MinY;
+	if(frame->sortEnded) {
+		size_t blockByteIndex = frame->sortEndOffset;
 
-		if(e1Type == DrawType_RenderEntityTexture) {
-			RenderEntityTexture* entityTex = (RenderEntityTexture*)r1;
-			r1MinY = entityTex->p->y - entityTex->p->y / 2;
-		} else {
-			RenderBoundedTexture* boundedTex = (RenderBoundedTexture*)r1;
-			r1MinY = boundedTex->bounds.min.y;
-		}
+		for(RenderBlock* block = frame->sortEndBlock ? frame->sortEndBlock : frame->firstBlock; block; block = block->next) {
+			while(blockByteIndex < block->used) {
+				void* elemPtr = getRenderBlockData(block) + blockByteIndex;
+				blockByteIndex += drawRenderElem(group, frame, elemPtr, true);
+			}
 
-		if(e2Type == DrawType_RenderEntityTexture) {
-			RenderEntityTexture* entityTex = (RenderEntityTexture*)r2;
-			r2MinY = entityTex->p->y - entityTex->p->y / 2;
-		} else {
-			RenderBoundedTexture* boundedTex = (RenderBoundedTexture*)r2;
-			r2MinY = boundedTex->bounds.min.y;
+			blockByteIndex = 0;
 		}
+	}
 
-		if(r1MinY > r2MinY) return 1;
-		if(r1MinY < r2MinY) return -1;
+	flushBatch(group);
 
-		//NOTE: This comparison is done to ensure that entity which is placed on top is consistent across frames
-		//		For example, if two tiles are overlapping and have exactly the same position and draw order, we 
-		//		always want the same one to be on top.
-		return r1->texture > r2->texture;
+	if(group->backend == RenderBackend_software) {
+		drawSoftwareFrame(group->software);
 	}
+}
 
-	if (e2IsRenderTextureOrConsoleField) return 1;
+//NOTE: This draws the pushed frame right away on the calling thread, it doesn't clear or present the screen
+void drawRenderGroup(RenderGroup* group) {
+	assert(!group->threaded);
 
-	return 0;
+	endRenderFrame(group, group->frame);
+	drawRenderFrame(group, group->frame);
+	clearRenderFrame(group, group->frame);
+
+	group->lastFrameStats = group->stats;
 }
 
-bool isPointLightVisible(RenderGroup* group, PointLight* light) {
-	R2 maxLightBounds = addRadiusTo(group->windowBounds, v2(1, 1) * light->range);
+//NOTE: This draws the loaded frame, it doesn't clear or present the screen. The frame is never cleared, so it can be 
+//		drawn again, but only by the group which loaded it.
+void replayRenderCapture(RenderGroup* group, RenderCapture* capture) {
+	assert(!group->threaded);
 
-	//TODO: Account for z
-	bool result = pointInsideRect(maxLightBounds, light->p.xy);
-	return result;
+	drawRenderFrame(group, &capture->frame);
+	group->lastFrameStats = group->stats;
 }
 
-void setPointLightUniforms(PointLightUniforms* lightUniforms, PointLight* light) {
-	glUniform3f(lightUniforms->p, (GLfloat)light->p.x, (GLfloat)light->p.y, (GLfloat)light->p.z);
-	glUniform3f(lightUniforms->color, (GLfloat)light->color.x, (GLfloat)light->color.y, (GLfloat)light->color.z);
-	glUniform1f(lightUniforms->range, (GLfloat)light->range);
+void clearScreen(RenderGroup* group) {
+	//NOTE: The software backend clears each tile while it is drawing the frame
+	if(group->backend == RenderBackend_gl) {
+		glClearColor(0, 0, 0, 1);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
 }
 
-void drawRenderGroup(RenderGroup* group, FieldSpec* fieldSpec) {
-	group->rendering = true;
-	qsort(group->sortPtrs, group->numSortPtrs, sizeof(RenderHeader*), renderElemCompare);
-	bindShader(group, &group->forwardShader.shader);
+void presentScreen(RenderGroup* group, SDL_Window* window) {
+	if(group->backend == RenderBackend_gl) {
+		resolveSceneTarget(group);
+		SDL_GL_SwapWindow(window);
+	}
+	else if(group->backend == RenderBackend_software) {
+		presentSoftwareFrame(group->software, window);
+	}
+}
 
-#if ENABLE_LIGHTING
-	group->ambient = (GLfloat)0.35;//0.43;
-#else
-	group->ambient = (GLfloat)0.5;
-#endif
+int renderThread(void* data) {
+	RenderGroup* group = (RenderGroup*)data;
+	bool gl = group->backend == RenderBackend_gl;
 
-	setAmbient(group, group->ambient);
+	while(true) {
+		SDL_SemWait(group->frameReady);
+		if(group->quitThread) break;
 
-	s32 uniformPointLightIndex = 0;
-	s32 uniformSpotLightIndex = 0;
+		if(gl) SDL_GL_MakeCurrent(group->window, group->glContext);
 
-	PointLight defaultPointLight = {};
+		clearScreen(group);
+		drawRenderFrame(group, group->drawingFrame);
+		clearRenderFrame(group, group->drawingFrame);
+		presentScreen(group, group->window);
 
-	for(s32 lightIndex = 0; lightIndex < group->forwardShader.numPointLights; lightIndex++) {
-		PointLight* light = group->forwardShader.pointLights + lightIndex;
+		if(gl) SDL_GL_MakeCurrent(group->window, NULL);
 
-		//TODO: account for z
-		//TODO: handle case where we run out of lights in a nicer way
-		if(isPointLightVisible(group, light)) {
-			assert(uniformPointLightIndex < arrayCount(group->forwardShader.pointLightUniforms));
-			PointLightUniforms* lightUniforms = group->forwardShader.pointLightUniforms + uniformPointLightIndex;
-			uniformPointLightIndex++;
-			setPointLightUniforms(lightUniforms, light);
-		}
+		SDL_SemPost(group->frameDone);
 	}
 
-	for(s32 uniformIndex = uniformPointLightIndex; uniformIndex < arrayCount(group->forwardShader.pointLightUniforms); uniformIndex++) {
-		PointLightUniforms* lightUniforms = group->forwardShader.pointLightUniforms + uniformIndex;
-		setPointLightUniforms(lightUniforms, &defaultPointLight);
-	}
+	return 0;
+}
 
-	for(s32 lightIndex = 0; lightIndex < group->forwardShader.numSpotLights; lightIndex++) {
-		SpotLight* light = group->forwardShader.spotLights + lightIndex;
+//NOTE: If threaded is set, each frame is drawn and presented on a render thread while the game pushes the next one.
+//		The GL context is passed between the threads. The render thread makes it current while it draws a frame, and
+//		the game thread takes it back in acquireRenderResources.
+void initRenderThread(RenderGroup* group, SDL_Window* window, bool32 threaded) {
+	group->window = window;
+	group->threaded = threaded;
+
+	if(threaded) {
+		if(group->backend == RenderBackend_gl) {
+			group->glContext = SDL_GL_GetCurrentContext();
+			assert(group->glContext);
+			SDL_GL_MakeCurrent(window, NULL);
+		}
 
-		//TODO: account for z
-		//TODO: handle case where we run out of lights in a nicer way
-		if(isPointLightVisible(group, &light->base)) {
-			assert(uniformSpotLightIndex < arrayCount(group->forwardShader.spotLightUniforms));
-			SpotLightUniforms* lightUniforms = group->forwardShader.spotLightUniforms + uniformSpotLightIndex;
-			uniformSpotLightIndex++;
-			setPointLightUniforms(&lightUniforms->base, &light->base);
+		group->frameReady = SDL_CreateSemaphore(0);
+		group->frameDone = SDL_CreateSemaphore(0);
+		assert(group->frameReady && group->frameDone);
 
-			double angle = light->angle;
-			V2 lightDir = v2(cos(angle), sin(angle));
-			double cutoff = cos(toRadians(light->spread / 2));
+		group->thread = SDL_CreateThread(renderThread, "Render", group);
+		assert(group->thread);
+	}
+}
 
-			glUniform2f(lightUniforms->dir, (GLfloat)lightDir.x, (GLfloat)lightDir.y);
-			glUniform1f(lightUniforms->cutoff, (GLfloat)cutoff);
+//NOTE: This waits for the frame which is being drawn and stops the render thread, afterwards the GL context is 
+//		current on the game thread again.
+void shutdownRenderThread(RenderGroup* group) {
+	if(group->threaded) {
+		waitForRenderFrame(group);
+
+		group->quitThread = true;
+		SDL_SemPost(group->frameReady);
+		SDL_WaitThread(group->thread, NULL);
+		group->thread = NULL;
+
+		if(group->backend == RenderBackend_gl && !group->resourcesAcquired) {
+			SDL_GL_MakeCurrent(group->window, group->glContext);
 		}
-	}
 
-	for(s32 uniformIndex = uniformSpotLightIndex; uniformIndex < arrayCount(group->forwardShader.spotLightUniforms); uniformIndex++) {
-		SpotLightUniforms* lightUniforms = group->forwardShader.spotLightUniforms + uniformIndex;
-		setPointLightUniforms(&lightUniforms->base, &defaultPointLight);
+		SDL_DestroySemaphore(group->frameReady);
+		SDL_DestroySemaphore(group->frameDone);
+
+		group->threaded = false;
+		group->resourcesAcquired = false;
 	}
+}
+
+//NOTE: This stops every thread the group started and closes the streaming file. It has to be called before the 
+//		window and the GL context are destroyed.
+void shutdownRenderGroup(RenderGroup* group) {
+	shutdownRenderThread(group);
 
-	for(s32 elemIndex = 0; elemIndex < group->numSortPtrs; elemIndex++) {
-		void* elemPtr = group->sortPtrs[elemIndex];
-		drawRenderElem(group, fieldSpec, elemPtr, group->ambient, false);
+	if(group->backend == RenderBackend_gl) {
+		shutdownTextureResidency(group);
 	}
+	else if(group->backend == RenderBackend_software) {
+		shutdownSoftwareRenderer(group->software);
+	}
+}
 
-	size_t groupByteIndex = group->sortAddressCutoff;
+//NOTE: This draws and presents the pushed frame. If the group is threaded, the frame is handed to the render thread
+//		and this only waits for the previous frame to finish.
+void submitRenderGroup(RenderGroup* group) {
+	group->strings.frameIndex++;
 
-	bindShader(group, &group->basicShader);
+	if(group->threaded) {
+		waitForRenderFrame(group);
 
-	while(groupByteIndex < group->allocated) {
-		void* elemPtr = (char*)group->base + groupByteIndex;
-		groupByteIndex += drawRenderElem(group, fieldSpec, elemPtr, group->ambient, true);
-	}
+		if(group->resourcesAcquired) {
+			if(group->backend == RenderBackend_gl) SDL_GL_MakeCurrent(group->window, NULL);
+			group->resourcesAcquired = false;
+		}
 
-	group->numSortPtrs = 0;
-	group->allocated = 0;
-	group->sortAddressCutoff = 0;
-	group->forwardShader.numPointLights = 0;
-	group->forwardShader.numSpotLights = 0;
-	pushDefaultClipRect(group);
-	group->rendering = false;
+		endRenderFrame(group, group->frame);
+
+		group->drawingFrame = group->frame;
+		group->frame = group->frame == group->frames ? group->frames + 1 : group->frames;
+		assert(!group->frame->firstBlock);
+
+		group->frameInFlight = true;
+		SDL_SemPost(group->frameReady);
+	} else {
+		clearScreen(group);
+		drawRenderGroup(group);
+		presentScreen(group, group->window);
+	}
 }
@@ -14,6 +14,19 @@ struct Animation {
 	AssetId assetId;
 };
 
+#define MAX_COMPOSITED_FRAMES 16
+
+//NOTE: The background is baked into every frame of a composited animation, so crossfading between two of its frames
+//		only draws two layers instead of three. Neighbouring frames are the same outside of a part of the screen, so 
+//		the second frame of the crossfade is only drawn there. deltas[i] is frame i + 1 and reverseDeltas[i] is frame i,
+//		both trimmed down to the part which is different between frames i and i + 1 (the last one wraps around to 0).
+struct CompositedAnimation {
+	Animation anim;
+	Texture deltas[MAX_COMPOSITED_FRAMES];
+	Texture reverseDeltas[MAX_COMPOSITED_FRAMES];
+	bool32 hasDelta[MAX_COMPOSITED_FRAMES];
+};
+
 struct AnimNode {
 	Animation intro;
 	Animation main;
@@ -43,11 +56,18 @@ struct Glyph {
 	R2 padding; //stored in meters
 };
 
+#define GLYPH_PAGE_SIZE 512
+
+//NOTE: The glyphs are packed into pages as they are first used, so a run of text only needs one texture
 struct CachedFont {
 	TTF_Font* font;
 	Glyph cache[1 << (sizeof(char) * 8)];
 	double scaleFactor;
 	double lineHeight;
+
+	GLuint glyphPage;
+	s32 glyphPageX, glyphPageY;
+	s32 glyphPageRowHeight;
 };
 
 enum DrawType {
@@ -60,6 +80,7 @@ enum DrawType {
 	DrawType_RenderDashedLine,	
 	DrawType_RenderRotatedTexture,
 	DrawType_RenderFilledStencil,
+	DrawType_RenderStaticMesh,
 };
 
 struct PointLight {
@@ -74,36 +95,174 @@ struct SpotLight {
 	double spread;
 };
 
-struct PointLightUniforms {
-	GLint p;
-	GLint color;
-	GLint range;
-};
+#define MAX_POINT_LIGHTS 512
+#define MAX_SPOT_LIGHTS 128
+#define MAX_LIGHTS (MAX_POINT_LIGHTS + MAX_SPOT_LIGHTS)
+
+//NOTE: The screen is split into tiles which are LIGHT_TILE_SIZE pixels on each side. Every tile has a list of the
+//		lights which can reach it, so the cost of lighting a pixel only depends on the lights which overlap its tile.
+#define LIGHT_TILE_SIZE 64
+#define MAX_LIGHT_TILES 4096
+#define MAX_LIGHT_TILE_INDICES 32768
+
+//NOTE: Each light is stored as 3 RGBA texels, (p, range), (color, cutoff) and (dir, 0, 0)
+//		Point lights have a cutoff of -2 so that they aren't treated as spot lights in the shader.
+#define LIGHT_DATA_TEXELS 3
+
+struct LightTiles {
+	s32 tilesWidth, tilesHeight;
+	double tileSize; //In meters
 
-struct SpotLightUniforms {
-	PointLightUniforms base;
-	GLint dir;
-	GLint cutoff;
+	GLuint dataBuffer, tileBuffer, indexBuffer;
+	GLuint dataTexture, tileTexture, indexTexture;
+
+	s32 numLights;
+	GLfloat data[MAX_LIGHTS * LIGHT_DATA_TEXELS * 4];
+	R2 bounds[MAX_LIGHTS];
+
+	//NOTE: The lights of tile i are indices[tileRanges[2 * i]] to indices[tileRanges[2 * i] + tileRanges[2 * i + 1] - 1]
+	s32 tileRanges[MAX_LIGHT_TILES * 2];
+	s32 indices[MAX_LIGHT_TILE_INDICES];
 };
 
 struct Shader {
 	GLuint program;
-	GLint tintUniformLocation;
 };
 
-struct ForwardShader {
-	Shader shader;
+#define MAX_SHADER_SOURCE_LENGTH 4000
+
+//NOTE: Linked programs are saved with glGetProgramBinary so that they don't have to be compiled on the next launch.
+//		A binary is keyed by a hash of its shader sources and the driver strings. The driver can still reject
+//		a binary (eg. after it was updated), then the program is compiled and the binary is replaced.
+//		Bump PROGRAM_CACHE_VERSION if the way the programs are linked changes (eg. the attribute locations).
+#define PROGRAM_CACHE_FILE_NAME "program_cache.bin"
+#define PROGRAM_CACHE_MAGIC 0x50434648 //HFCP
+#define PROGRAM_CACHE_VERSION 1
+#define MAX_CACHED_PROGRAMS 8
+#define MAX_PROGRAM_BINARY_SIZE MEGABYTES(16)
+
+struct ProgramCacheHeader {
+	u32 magic;
+	s32 version;
+	s32 numBinaries;
+};
 
-	GLint ambientUniform;
+struct ProgramBinaryHeader {
+	u64 key;
+	GLenum format;
+	s32 length;
+};
 
-	PointLight pointLights[32];
-	s32 numPointLights;
+struct ProgramBinary {
+	ProgramBinaryHeader header;
+	void* data;
+	bool32 used; //Only the binaries which were used this launch are written back
+};
 
-	SpotLight spotLights[32];
-	s32 numSpotLights;
+//NOTE: Shader objects are only compiled on a cache miss, and each one is shared by all of the programs that use it
+struct CompiledShader {
+	AssetId sourceId;
+	GLuint shader;
+};
+
+struct ProgramCache {
+	char* filePath;
+	bool32 binariesSupported;
+	bool32 changed;
+	u64 driverHash;
+
+	s32 numBinaries;
+	ProgramBinary binaries[MAX_CACHED_PROGRAMS];
+
+	s32 numShaders;
+	CompiledShader shaders[MAX_CACHED_PROGRAMS * 2];
+};
+
+struct ShaderStartupStats {
+	s32 programsLoaded; //From the program cache
+	s32 programsCompiled;
+	s32 shadersCompiled;
+	double seconds;
+};
+
+//NOTE: These are the attribute locations used by all of the shaders
+enum VertexAttribute {
+	VertexAttribute_p,
+	VertexAttribute_uv,
+	VertexAttribute_color,
+	VertexAttribute_emissivity,
+};
+
+struct BatchVertex {
+	GLfloat p[2];
+	GLfloat uv[2];
+	u8 color[4];
+	GLfloat emissivity;
+};
+
+//NOTE: Quads are collected into a batch until the texture, shader, clip rect or a uniform changes.
+//		MAX_BATCH_QUADS must fit in 16 bit indices.
+#define MAX_BATCH_QUADS 4096
+#define VERTEX_BUFFER_QUADS (MAX_BATCH_QUADS * 16)
+
+//NOTE: The sort key of a render element is (from the most to least significant bits)
+//		1 bit whether the element is not a texture or console field (these are drawn after all of the textures)
+//		8 bits draw order
+//		24 bits min y, the top bits of a float which have been flipped so that they sort as an unsigned integer
+//		18 bits texture id
+//		The radix sort is stable, so elements with the same key are drawn in the order they were pushed
+#define RENDER_SORT_KEY_TEXTURE_BITS 18
+#define RENDER_SORT_KEY_Y_BITS 24
+#define RENDER_SORT_KEY_DRAW_ORDER_BITS 8
+
+//NOTE: These are counted while the elements are being pushed, they are moved into RenderStats::cull when the 
+//		group is drawn so they describe the same frame as the rest of the stats
+struct CullStats {
+	s32 entitiesVisible;
+	s32 entitiesCulled;
+	s32 elementsPushed;
+	s32 elementsCulled;
+	s32 fieldsCulled;
+	s32 fieldsRebuilt; //The console fields which weren't cached
+};
 
-	PointLightUniforms pointLightUniforms[8];
-	SpotLightUniforms spotLightUniforms[8];
+//NOTE: stateRequests - stateChanges is the number of GL calls which were avoided by the state cache
+struct RenderStats {
+	s32 drawCalls;
+	s32 stateRequests;
+	s32 stateChanges;
+	s32 quads;
+	s32 lights;
+	s32 maxLightsPerTile;
+	CullStats cull;
+
+	//NOTE: These are only set when the scene is drawn into the scene target
+	double renderScale;
+	double gpuMilliseconds; //The average of the frames which the last render scale change was based on
+};
+
+//NOTE: The state setters only change the requested state. It is applied (and the batch flushed) right before the
+//		next quad is added, and only the parts which are different from the applied state reach GL.
+struct RenderState {
+	struct Shader* shader;
+	GLuint texture;
+	bool32 scissorEnabled;
+	R2 scissorRect;
+
+	//NOTE: These are only applied while the forward shader is bound
+	GLfloat ambient;
+	V2 cameraOffset;
+	GLfloat glowTime;
+};
+
+struct ForwardShader {
+	Shader shader;
+
+	GLint ambientUniform;
+	GLint cameraOffsetUniform;
+	GLint glowTimeUniform;
+	GLint lightingEnabledUniform;
+	bool32 lightingEnabledValue; //The last value which was sent to GL
 };
 
 
@@ -130,8 +289,7 @@ struct RenderTexture {
 
 struct RenderEntityTexture {
 	RenderTexture tex;
-	V2* p;
-	V2* renderSize;
+	R2 bounds; //In camera space, this isn't scaled by the camera
 	double rotation;
 };
 
@@ -146,9 +304,42 @@ struct RenderRotatedTexture {
 	double rad;
 };
 
+#define MAX_INTERNED_STRINGS 1024
+#define INTERNED_STRING_BUCKETS 1024 //NOTE: This must be a power of 2
+#define MAX_INTERNED_STRING_LENGTH 48
+
+//NOTE: The text which is pushed is interned, so a string which is pushed every frame (like the name of a console
+//		field) is only copied and measured the first time it is pushed. Text which is too long or doesn't fit in the
+//		table is copied into the frame's text blocks instead (see pushText).
+struct InternedString {
+	u64 hash;
+	u32 id; //NOTE: Every string which is interned gets a new id, so a stale reference can be detected
+	u32 lastUsedFrame;
+	InternedString* nextInBucket;
+
+	//NOTE: The size is cached for the last font the string was measured with
+	CachedFont* measuredFont;
+	V2 size;
+
+	s32 length;
+	char msg[MAX_INTERNED_STRING_LENGTH];
+};
+
+//NOTE: Once the table is full, the least recently used string is replaced. A string which was used by the frame
+//		being pushed or the frame being drawn is never replaced, see internString.
+struct StringTable {
+	InternedString strings[MAX_INTERNED_STRINGS];
+	InternedString* buckets[INTERNED_STRING_BUCKETS];
+	s32 numStrings;
+	u32 nextId;
+	u32 frameIndex; //Incremented every time a frame is submitted
+};
+
 struct RenderText {
 	CachedFont* font;
-	char msg[50];
+	InternedString* str; //NULL if the text wasn't interned, then msg is owned by the frame
+	u32 strId;
+	char* msg;
 	V2 p;
 	Color color;
 };
@@ -171,11 +362,38 @@ struct RenderFilledStencil {
 	Color color;
 };
 
-struct ConsoleField;
-
+//NOTE: The elements of the console field are pushed right after it when it is pushed (see pushConsoleField), 
+//		they are drawn along with it and aren't sorted on their own
 struct RenderConsoleField {
-	ConsoleField* field;
-	double alpha;
+	size_t elemsSize;
+};
+
+//NOTE: The elements which pushConsoleField records for a field are kept here, and copied into the frame (moved to the 
+//		field's position) for as long as the key stays the same
+#define MAX_CACHED_CONSOLE_FIELDS 64
+#define MAX_CACHED_CONSOLE_FIELD_SIZE 512
+#define CONSOLE_FIELD_ALPHA_STEPS 32
+
+struct ConsoleFieldRenderKey {
+	struct ConsoleField* field;
+	s32 type;
+	bool32 removed;
+	s32 numValues;
+	s32 tweakCost;
+	char name[20]; //The same size as the name of a ConsoleField
+	s32 alphaStep;
+	bool32 moveFields;
+	bool32 cloneFields;
+	bool32 hasClipRect;
+	R2 clipRect;
+};
+
+struct CachedConsoleField {
+	ConsoleFieldRenderKey key;
+	V2 p; //The camera space position of the field when the elements were recorded
+	s32 numElems;
+	size_t elemsSize;
+	char elems[MAX_CACHED_CONSOLE_FIELD_SIZE];
 };
 
 struct RenderDashedLine {
@@ -186,11 +404,240 @@ struct RenderDashedLine {
 	double dashSize, spaceSize;
 };
 
+struct RenderStaticMesh {
+	s32 meshIndex;
+	V2 cameraP;
+};
+
+#define MAX_STATIC_MESHES 256
+#define MAX_STATIC_MESH_QUADS 512
+#define MAX_STATIC_MESH_RUNS 32
+
+//NOTE: A run is a range of quads in a static mesh which all use the same texture
+struct StaticMeshRun {
+	GLuint texture;
+	s32 firstQuad;
+	s32 numQuads;
+};
+
+//NOTE: A static mesh is stored in world space and is drawn with the camera offset uniform, so it only has to be
+//		rebuilt when its contents change. A negative emissivity is the phase of a glowing quad (see forward.vert).
+struct StaticMesh {
+	GLuint vertexArray;
+	GLuint vertexBuffer;
+	BatchVertex* vertices; //The null and software backends keep the mesh on the CPU
+
+	s32 numQuads;
+	s32 numRuns;
+	StaticMeshRun runs[MAX_STATIC_MESH_RUNS];
+};
+
+struct TextureAtlas {
+	s32 numPages;
+	GLuint pages[MAX_ATLAS_PAGES];
+	s32 pageResources[MAX_ATLAS_PAGES]; //Only used if texture residency is enabled
+
+	PackedAsset assets[Asset_count];
+	PackedFrame* frames;
+};
+
+//NOTE: An asset is kept resident while it is in any of these sets. Every asset starts in TextureSet_always,
+//		the game takes the ones which are only used by some levels out of it.
+enum TextureSet {
+	TextureSet_always = 1 << 0,
+	TextureSet_currentLevel = 1 << 1,
+	TextureSet_nextLevel = 1 << 2,
+};
+
+#define MAX_TEXTURE_RESOURCES 64
+
+//NOTE: A texture resource is a GL texture which is loaded from the assets file, either an atlas page or an asset 
+//		which isn't in the atlas. Its texture name is made when it is registered and never changes, so the Texture 
+//		structs which refer to it stay valid. Only its storage is uploaded and freed.
+struct TextureResource {
+	GLuint texId;
+	s32 filePos; //An atlas page starts with its png size
+	bool32 atlasPage;
+	bool32 stencil;
+	s32 width, height;
+	size_t bytes;
+
+	u32 sets; //The union of the sets of the assets which use it
+	bool32 resident;
+	s32 lastNeeded; //The residency generation when it was last in a set, the oldest ones are evicted first
+};
+
+//NOTE: The resources which are needed right now (TextureSet_always and TextureSet_currentLevel) are loaded by 
+//		updateTextureResidency before it returns. The next level's resources are decoded on the streaming thread 
+//		one at a time and uploaded by the game thread. Resources which aren't in any set are only kept while the 
+//		resident resources fit in the budget.
+struct TextureResidency {
+	bool32 enabled;
+	size_t budget;
+	size_t residentBytes;
+	s32 generation;
+
+	u8 assetSets[Asset_count];
+	s32 assetResources[Asset_count]; //-1 if the asset isn't a resource by itself
+
+	bool32 setsChanged;
+
+	s32 numResources;
+	TextureResource resources[MAX_TEXTURE_RESOURCES];
+
+	FILE* streamFile; //The streaming thread has its own handle to the assets file
+	s32 streamingResource; //-1 if nothing is being streamed
+	void* streamPixels;
+	s32 streamComponents;
+	SDL_sem* streamRequest;
+	SDL_sem* streamDone;
+	SDL_Thread* streamThread;
+	bool32 streamQuit; //Set before streamRequest is posted to stop the streaming thread
+};
+
+#define SOFTWARE_TILE_SIZE 64
+#define MAX_SOFTWARE_TILES 1024
+#define MAX_SOFTWARE_TEXTURES 4096
+#define MAX_SOFTWARE_QUADS (1 << 16)
+#define MAX_SOFTWARE_TILE_QUADS (1 << 20)
+#define MAX_SOFTWARE_THREADS 16
+
+//NOTE: The pixels are stored as RGBA bytes, the first row is the top of the texture (the same as the GL textures)
+struct SoftwareTexture {
+	s32 width, height;
+	u32* pixels;
+};
+
+//NOTE: Every quad the renderer makes is a parallelogram, so a pixel is inside of it if both of its coordinates 
+//		along the edges (u and v) are in [0, 1). The positions are in pixels.
+struct SoftwareQuad {
+	float originX, originY;
+	float uRow[2], vRow[2]; //u = dot(uRow, p - origin), v = dot(vRow, p - origin)
+	float uvOrigin[2], uvU[2], uvV[2];
+	u8 color[4];
+	s32 texture;
+	s32 minX, minY, maxX, maxY; //The pixels which are covered, clipped to the scissor rect
+};
+
+//NOTE: The quads are collected for the whole frame and then binned into screen tiles, the tiles are drawn in
+//		parallel since each one only touches its own pixels. The framebuffer's first row is the bottom of the screen.
+struct SoftwareRenderer {
+	s32 width, height;
+	u32* framebuffer;
+	s32 tilesWidth, tilesHeight;
+
+	SoftwareTexture textures[MAX_SOFTWARE_TEXTURES]; //NOTE: The texture id is the index, 0 is the null texture
+
+	s32 numQuads;
+	SoftwareQuad quads[MAX_SOFTWARE_QUADS];
+
+	//NOTE: The quads of tile i are tileQuads[tileRanges[2 * i]] to tileQuads[tileRanges[2 * i] + tileRanges[2 * i + 1] - 1]
+	s32 tileRanges[MAX_SOFTWARE_TILES * 2];
+	s32 tileQuads[MAX_SOFTWARE_TILE_QUADS];
+
+	s32 numThreads;
+	SDL_Thread* threads[MAX_SOFTWARE_THREADS];
+	bool32 quit; //Set before workReady is posted to stop the threads
+	SDL_sem* workReady;
+	SDL_sem* workDone;
+	SDL_atomic_t nextTile;
+};
+
+//NOTE: This is everything which is pushed for one frame. The group has two of them, so one frame can be drawn on the
+//		render thread while the next one is being pushed (see submitRenderGroup). The elements only store values, the
+//		textures, fonts and static meshes which they point to are only changed once the render thread is idle.
+//NOTE: The elements are pushed into a list of blocks. An element (or a console field along with its elements) 
+//		never crosses into the next block. The blocks are taken from the group's pool and given back when the 
+//		frame is cleared, so after the first few frames pushing doesn't allocate any memory.
+#define RENDER_BLOCK_SIZE KILOBYTES(64)
+struct RenderBlock {
+	size_t size; //Of the data after the block, this can be more than RENDER_BLOCK_SIZE for a large console field
+	size_t used;
+	RenderBlock* next;
+};
+
+#define INITIAL_SORTED_RENDER_ELEMS 1024
+
+struct RenderFrame {
+	RenderBlock* firstBlock;
+	RenderBlock* lastBlock;
+
+	//NOTE: The text which wasn't interned is copied into these, they are given back along with the element blocks
+	RenderBlock* firstTextBlock;
+	RenderBlock* lastTextBlock;
+
+	//NOTE: sortKeys[i] is the key of sortPtrs[i], these are grown whenever they fill up
+	u64* sortKeys;
+	RenderHeader** sortPtrs;
+	s32 numSortPtrs;
+	s32 maxSortPtrs;
+
+	//NOTE: The elements starting at sortEndOffset in sortEndBlock were pushed after pushSortEnd
+	bool32 sortEnded;
+	RenderBlock* sortEndBlock;
+	size_t sortEndOffset;
+
+	PointLight pointLights[MAX_POINT_LIGHTS];
+	s32 numPointLights;
+
+	SpotLight spotLights[MAX_SPOT_LIGHTS];
+	s32 numSpotLights;
+
+	CullStats cullStats;
+
+	//NOTE: These are copied from the group when the frame is submitted
+	R2 defaultClipRect;
+	bool32 lightingEnabled;
+	GLfloat glowTime;
+	char* captureFileName;
+	s32 drawableWidth, drawableHeight; //NOTE: The size of the window in pixels, only set if there is a scene target
+};
+
+#define SCENE_TIMER_QUERIES 4
+#define RENDER_SCALE_FRAMES 30 //NOTE: The render scale is changed at most once every this many frames
+#define RENDER_SCALE_STEP 0.05
+#define TARGET_GPU_SECONDS (0.8 / 60.0)
+
+//NOTE: If this is enabled, the frames are drawn into an offscreen texture which is upscaled into the largest part of
+//		the window with the group's aspect ratio. The texture is drawn at scale times the size of that part, the scale
+//		goes down (to minScale) while the GPU takes longer than TARGET_GPU_SECONDS to draw a frame and back up once 
+//		it is fast enough again. The game only ever sees the group's window size, so nothing else changes with the 
+//		size of the window.
+struct SceneTarget {
+	bool32 enabled;
+	bool32 active; //Set while a frame is being drawn into the target
+
+	GLuint framebuffer;
+	GLuint texture;
+	s32 textureWidth, textureHeight;
+
+	double scale;
+	double minScale;
+	s32 width, height; //The part of the texture which the current frame is drawn into
+	s32 drawableWidth, drawableHeight;
+	SDL_Rect viewport; //Where the texture is upscaled to in the window
+
+	//NOTE: The GPU time of each frame is read a few frames later, so that the render thread doesn't wait for it
+	GLuint timerQueries[SCENE_TIMER_QUERIES];
+	s32 nextTimerQuery;
+	s32 pendingTimerQueries;
+	bool32 timingFrame;
+
+	double gpuSecondsSum;
+	s32 gpuSecondsCount;
+	double gpuSeconds;
+};
+
 struct RenderGroup {
+	RenderBackend backend;
+	SoftwareRenderer* software;
+	GLuint nullTexturesCount; //The null backend only hands out texture ids
+
 	ForwardShader forwardShader;
 	Shader basicShader;
 	Shader stencilShader;
-	Shader* currentShader;
+	Shader upscaleShader;
+	ShaderStartupStats shaderStartup;
 
 	Texture* whiteTex;
 
@@ -201,25 +648,129 @@ struct RenderGroup {
 	Camera* camera;
 
 	GLfloat ambient;
+	bool32 lightingEnabled; //Copied into the frame when it is submitted
+	LightTiles lightTiles;
 
 	bool32 enabled;
-	bool32 rendering;
 
-	R2 defaultClipRect;
+	//NOTE: While this is set, the pushed elements belong to this console field instead of being sorted.
+	//		recordingFieldOffset is where the field's header starts in the last block of the frame.
+	RenderConsoleField* recordingField;
+	size_t recordingFieldOffset;
+
+	CachedConsoleField cachedFields[MAX_CACHED_CONSOLE_FIELDS];
+	StringTable strings;
+
+	R2 defaultClipRect; //Copied into the frame when it is submitted
 	R2 clipRect;
 	bool32 hasClipRect;
 
-	RenderHeader* sortPtrs[5000];
-	s32 numSortPtrs;
-	size_t sortAddressCutoff;
-
-	void* base;
-	size_t allocated;
-	size_t maxSize;
+	GLuint vertexArray;
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	s32 vertexBufferOffset; //In vertices, the vertex buffer is orphaned when it fills up
+
+	BatchVertex batchVertices[MAX_BATCH_QUADS * 4];
+	s32 numBatchQuads;
+
+	StaticMesh staticMeshes[MAX_STATIC_MESHES];
+	BatchVertex staticMeshVertices[MAX_STATIC_MESH_QUADS * 4];
+	s32 buildingStaticMesh; //-1 if no static mesh is being built
+	GLfloat glowTime; //Copied into the frame when it is submitted
+
+	RenderState requestedState;
+	RenderState appliedState;
+
+	//NOTE: This is reset at the start of every drawRenderFrame. It is written by the render thread, so the game
+	//		should read lastFrameStats instead.
+	RenderStats stats;
+	RenderStats lastFrameStats;
+
+	RenderFrame frames[2];
+	RenderFrame* frame; //The frame which is being pushed
+	RenderFrame* drawingFrame; //The frame which the render thread is drawing
+
+	//NOTE: These are used by the radix sort, they are only touched by the thread which draws the frames
+	u64* sortKeysTemp;
+	RenderHeader** sortPtrsTemp;
+	s32 maxSortTemp;
+
+	//NOTE: This is shared by both frames, so it is locked
+	RenderBlock* freeBlocks;
+	SDL_SpinLock freeBlocksLock;
+
+	//NOTE: If threaded is set, the frames are drawn and presented on the render thread (see submitRenderGroup)
+	SDL_Window* window;
+	SDL_GLContext glContext;
+	bool32 threaded;
+	bool32 frameInFlight;
+	bool32 resourcesAcquired; //The game thread owns the GL context until the next frame is submitted
+	SDL_sem* frameReady;
+	SDL_sem* frameDone;
+	SDL_Thread* thread;
+	bool32 quitThread; //Set before frameReady is posted to stop the render thread
 
 	Texture* textures;
 	s32* texturesCount;
 
+	TextureAtlas atlas;
+	TextureResidency residency;
+	SceneTarget sceneTarget;
+
 	struct Assets* assets;
+
+	//NOTE: If this is set, the next frame is written to this file when it is drawn (see captureRenderGroup)
+	char* captureFileName;
+};
+
+#define RENDER_CAPTURE_MAGIC 0x43524648 //HFRC
+#define RENDER_CAPTURE_VERSION 4
+#define MAX_CAPTURE_GL_TEXTURES 256
+#define MAX_CAPTURE_TEXTURES 4096
+#define MAX_CAPTURE_FONTS 8
+
+struct CapturedGLTexture {
+	GLuint texId; //The id in the game while capturing, and the id in the replay once it has been loaded
+	s32 width, height;
+	bool32 srgb;
+};
+
+//NOTE: A capture is one frame of render elements in the order they were drawn, with every pointer replaced by an
+//		index into the tables in the capture. The GL textures and static meshes which the frame uses are read back 
+//		from GL, so the frame can be replayed without the game.
+struct RenderCapture {
+	//NOTE: While loading, the fonts are allocated from here
+	MemoryArena* arena;
+
+	s32 windowWidth, windowHeight;
+	double pixelsPerMeter;
+	bool32 lightingEnabled;
+	GLfloat glowTime;
+	R2 defaultClipRect;
+
+	s32 numElems;
+	s32 numSortedElems; //The elements after these were pushed after pushSortEnd
+
+	s32 numPointLights;
+	PointLight pointLights[MAX_POINT_LIGHTS];
+	s32 numSpotLights;
+	SpotLight spotLights[MAX_SPOT_LIGHTS];
+
+	s32 numGLTextures;
+	CapturedGLTexture glTextures[MAX_CAPTURE_GL_TEXTURES];
+
+	s32 numTextures;
+	Texture* texturePtrs[MAX_CAPTURE_TEXTURES]; //Only used while capturing
+	Texture textures[MAX_CAPTURE_TEXTURES];
+
+	s32 numFonts;
+	CachedFont* fonts[MAX_CAPTURE_FONTS];
+
+	s32 numStaticMeshes;
+	s32 staticMeshes[MAX_STATIC_MESHES]; //The mesh indices in the game
+	s32 firstStaticMesh; //While loading, the meshes are put into the render group starting at this index
+
+	//NOTE: This is the loaded frame, it keeps the blocks it was pushed into and is drawn directly when it is replayed
+	RenderFrame frame;
 };
 
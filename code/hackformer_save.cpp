@@ -240,7 +240,11 @@ void streamEntity(IOStream* stream, Entity* entity, s32 entityIndex, bool stream
 	streamElem(stream, entity->type);
 	streamElem(stream, entity->flags);
 
+	//NOTE: The sleep state is not saved, so everything starts out awake again
+	if(stream->reading) clearFlags(entity, EntityFlag_asleep);
+
 	streamV2(stream, &entity->p);
+	if(stream->reading) entity->prevP = entity->p;
 	streamV2(stream, &entity->dP);
 	streamElem(stream, entity->rotation);
 	streamElem(stream, entity->wheelRotation);
@@ -334,6 +338,27 @@ void streamArena(IOStream* stream, MemoryArena* arena) {
 
 void streamGameChanges(IOStream* stream);
 
+void streamProjectilePool(IOStream* stream, ProjectilePool* pool) {
+	streamElem(stream, pool->count);
+
+	if(stream->reading) {
+		assert(pool->count >= 0 && pool->count <= MAX_POOLED_PROJECTILES);
+		pool->count = max(0, min(pool->count, MAX_POOLED_PROJECTILES));
+	}
+
+	for(s32 i = 0; i < pool->count; i++) {
+		streamElem(stream, pool->kind[i]);
+		streamElem(stream, pool->ref[i]);
+		streamElem(stream, pool->spawnerRef[i]);
+		streamV2(stream, pool->p + i);
+		if(stream->reading) pool->prevP[i] = pool->p[i];
+		streamV2(stream, pool->dP + i);
+		streamElem(stream, pool->rotation[i]);
+		streamElem(stream, pool->animTime[i]);
+		streamElem(stream, pool->removed[i]);
+	}
+}
+
 void streamGame(IOStream* stream, bool streamingCheckpoint) {
 	GameState* gameState = stream->gameState;
 
@@ -376,6 +401,8 @@ void streamGame(IOStream* stream, bool streamingCheckpoint) {
 		streamEntity(stream, gameState->entities + i, i, streamingCheckpoint);
 	}
 
+	streamProjectilePool(stream, &gameState->projectiles);
+
 	if(getEntityByRef(gameState, gameState->consoleEntityRef)) {
 		MemoryArena* arena = &gameState->hackSaveStorage;
 		SaveMemoryHeader* header = (SaveMemoryHeader*)arena->base;
@@ -424,14 +451,46 @@ void streamGame(IOStream* stream, bool streamingCheckpoint) {
 	freeIostream(stream);	
 }
 
+bool32 streamSaveFileHeader(IOStream* stream) {
+	u32 magic = SAVE_FILE_MAGIC;
+	s32 version = SAVE_FILE_VERSION;
+
+	streamElem(stream, magic);
+	streamElem(stream, version);
+
+	bool32 result = magic == SAVE_FILE_MAGIC && version == SAVE_FILE_VERSION;
+	return result;
+}
+
 void saveCompleteGame(GameState* gameState, char* fileName) {
 	IOStream stream = createIostream(gameState, fileName, false);
+	if(!stream.file) return;
+
+	streamSaveFileHeader(&stream);
 	streamGame(&stream, false);	
+
+	freeIostream(&stream);
 }
 
-void loadCompleteGame(GameState* gameState, char* fileName) {
+//NOTE: The current level is only freed if the save can be loaded, returns false if it couldn't be
+bool32 loadCompleteGame(GameState* gameState, char* fileName) {
+	bool32 result = false;
+
 	IOStream stream = createIostream(gameState, fileName, true);
-	streamGame(&stream, false);	
+
+	if(stream.file) {
+		if(streamSaveFileHeader(&stream)) {
+			freeLevel(gameState);
+			streamGame(&stream, false);
+			result = true;
+		} else {
+			fprintf(stderr, "%s was saved by a different version of the game and can't be loaded\n", fileName);
+		}
+
+		freeIostream(&stream);
+	}
+
+	return result;
 }
 
 void saveCompleteGame(GameState* gameState, MemoryArena* arena) {
@@ -474,10 +533,16 @@ void streamConsoleFieldChanges(IOStream* stream, ConsoleField** fieldPtr) {
 
 void streamEntityChanges(IOStream* stream, Entity* entity) {
 	streamV2(stream, &entity->p); 
+	if(stream->reading) entity->prevP = entity->p;
 	streamElem(stream, entity->rotation);
 	streamElem(stream, entity->tileXOffset);
 	streamElem(stream, entity->tileYOffset);
 	streamElem(stream, entity->flags);
+
+	if(stream->reading) {
+		clearFlags(entity, EntityFlag_asleep);
+		entity->sleepTime = 0;
+	}
 	
 	if(entity->messages) {
 		streamElem(stream, entity->messages->selectedIndex);
@@ -1,5 +1,9 @@
 #define MAX_HACK_UNDOS 100
 
+//NOTE: Bump SAVE_FILE_VERSION whenever streamGame changes, saves with a different version aren't loaded
+#define SAVE_FILE_MAGIC 0x56534648 //HFSV
+#define SAVE_FILE_VERSION 1
+
 struct SaveReference {
 	s32 index;
 	size_t size;
@@ -13,7 +17,7 @@ struct SaveMemoryHeader {
 
 //Savegames
 void saveCompleteGame(GameState* gameState, char* fileName);
-void loadCompleteGame(GameState* gameState, char* fileName);
+bool32 loadCompleteGame(GameState* gameState, char* fileName);
 
 //Checkpoints
 void saveCompleteGame(GameState* gameState, MemoryArena* arena);
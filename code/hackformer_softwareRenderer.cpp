@@ -0,0 +1,359 @@
+//NOTE: This is the CPU backend of the renderer. It only supports what the sprites need: textured quads with a tint
+//		and alpha blending. Lighting and emissivity are ignored, which matches the forward shader with lighting off.
+//		The textures are sampled with the nearest texel instead of bilinear filtering.
+
+void drawSoftwareTile(SoftwareRenderer* software, s32 tileIndex) {
+	s32 tileX = tileIndex % software->tilesWidth;
+	s32 tileY = tileIndex / software->tilesWidth;
+
+	s32 tileMinX = tileX * SOFTWARE_TILE_SIZE;
+	s32 tileMinY = tileY * SOFTWARE_TILE_SIZE;
+	s32 tileMaxX = min(tileMinX + SOFTWARE_TILE_SIZE, software->width);
+	s32 tileMaxY = min(tileMinY + SOFTWARE_TILE_SIZE, software->height);
+
+	u32 clearColor = 0;
+	u8* clearBytes = (u8*)&clearColor;
+	clearBytes[3] = 255;
+
+	for(s32 y = tileMinY; y < tileMaxY; y++) {
+		u32* row = software->framebuffer + y * software->width;
+
+		for(s32 x = tileMinX; x < tileMaxX; x++) {
+			row[x] = clearColor;
+		}
+	}
+
+	s32 firstQuad = software->tileRanges[tileIndex * 2];
+	s32 numQuads = software->tileRanges[tileIndex * 2 + 1];
+
+	for(s32 tileQuadIndex = 0; tileQuadIndex < numQuads; tileQuadIndex++) {
+		SoftwareQuad* quad = software->quads + software->tileQuads[firstQuad + tileQuadIndex];
+		SoftwareTexture* texture = software->textures + quad->texture;
+		if(!texture->pixels) continue;
+
+		s32 minX = max(quad->minX, tileMinX);
+		s32 minY = max(quad->minY, tileMinY);
+		s32 maxX = min(quad->maxX, tileMaxX);
+		s32 maxY = min(quad->maxY, tileMaxY);
+
+		u32 tintR = quad->color[0], tintG = quad->color[1], tintB = quad->color[2], tintA = quad->color[3];
+
+		for(s32 y = minY; y < maxY; y++) {
+			u32* row = software->framebuffer + y * software->width;
+			float dy = (float)y + 0.5f - quad->originY;
+
+			for(s32 x = minX; x < maxX; x++) {
+				float dx = (float)x + 0.5f - quad->originX;
+
+				float u = quad->uRow[0] * dx + quad->uRow[1] * dy;
+				float v = quad->vRow[0] * dx + quad->vRow[1] * dy;
+				if(u < 0 || u >= 1 || v < 0 || v >= 1) continue;
+
+				float texU = quad->uvOrigin[0] + quad->uvU[0] * u + quad->uvV[0] * v;
+				float texV = quad->uvOrigin[1] + quad->uvU[1] * u + quad->uvV[1] * v;
+
+				s32 texelX = min(max((s32)(texU * texture->width), 0), texture->width - 1);
+				s32 texelY = min(max((s32)(texV * texture->height), 0), texture->height - 1);
+				u8* texel = (u8*)(texture->pixels + texelY * texture->width + texelX);
+
+				u32 srcA = texel[3] * tintA / 255;
+				if(!srcA) continue;
+
+				u32 invSrcA = 255 - srcA;
+				u8* dst = (u8*)(row + x);
+
+				dst[0] = (u8)(((texel[0] * tintR / 255) * srcA + dst[0] * invSrcA) / 255);
+				dst[1] = (u8)(((texel[1] * tintG / 255) * srcA + dst[1] * invSrcA) / 255);
+				dst[2] = (u8)(((texel[2] * tintB / 255) * srcA + dst[2] * invSrcA) / 255);
+			}
+		}
+	}
+}
+
+void drawSoftwareTiles(SoftwareRenderer* software) {
+	s32 numTiles = software->tilesWidth * software->tilesHeight;
+
+	while(true) {
+		s32 tileIndex = SDL_AtomicAdd(&software->nextTile, 1);
+		if(tileIndex >= numTiles) break;
+
+		drawSoftwareTile(software, tileIndex);
+	}
+}
+
+int softwareRenderThread(void* data) {
+	SoftwareRenderer* software = (SoftwareRenderer*)data;
+
+	while(true) {
+		SDL_SemWait(software->workReady);
+		if(software->quit) break;
+
+		drawSoftwareTiles(software);
+		SDL_SemPost(software->workDone);
+	}
+
+	return 0;
+}
+
+void initSoftwareRenderer(RenderGroup* group) {
+	SoftwareRenderer* software = (SoftwareRenderer*)calloc(1, sizeof(SoftwareRenderer));
+	assert(software);
+
+	software->width = group->windowWidth;
+	software->height = group->windowHeight;
+	software->framebuffer = (u32*)calloc(software->width * software->height, sizeof(u32));
+	assert(software->framebuffer);
+
+	software->tilesWidth = (software->width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	software->tilesHeight = (software->height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	assert(software->tilesWidth * software->tilesHeight <= MAX_SOFTWARE_TILES);
+
+	software->workReady = SDL_CreateSemaphore(0);
+	software->workDone = SDL_CreateSemaphore(0);
+	assert(software->workReady && software->workDone);
+
+	//NOTE: The main thread draws tiles as well
+	software->numThreads = min(max(SDL_GetCPUCount() - 1, 0), MAX_SOFTWARE_THREADS);
+
+	for(s32 threadIndex = 0; threadIndex < software->numThreads; threadIndex++) {
+		software->threads[threadIndex] = SDL_CreateThread(softwareRenderThread, "SoftwareRender", software);
+		assert(software->threads[threadIndex]);
+	}
+
+	group->software = software;
+}
+
+void shutdownSoftwareRenderer(SoftwareRenderer* software) {
+	software->quit = true;
+
+	for(s32 threadIndex = 0; threadIndex < software->numThreads; threadIndex++) {
+		SDL_SemPost(software->workReady);
+	}
+
+	for(s32 threadIndex = 0; threadIndex < software->numThreads; threadIndex++) {
+		SDL_WaitThread(software->threads[threadIndex], NULL);
+		software->threads[threadIndex] = NULL;
+	}
+
+	software->numThreads = 0;
+	SDL_DestroySemaphore(software->workReady);
+	SDL_DestroySemaphore(software->workDone);
+}
+
+GLuint createSoftwareTexture(SoftwareRenderer* software, s32 width, s32 height, s32 numComponents, void* pixels) {
+	GLuint result = 0;
+
+	for(GLuint textureIndex = 1; textureIndex < MAX_SOFTWARE_TEXTURES; textureIndex++) {
+		if(!software->textures[textureIndex].pixels) {
+			result = textureIndex;
+			break;
+		}
+	}
+
+	assert(result);
+
+	SoftwareTexture* texture = software->textures + result;
+	texture->width = width;
+	texture->height = height;
+	texture->pixels = (u32*)malloc(width * height * sizeof(u32));
+	assert(texture->pixels);
+
+	if(numComponents == 4) {
+		memcpy(texture->pixels, pixels, width * height * sizeof(u32));
+	} else {
+		assert(numComponents == 3);
+
+		//NOTE: The rows are padded to 4 bytes, the same as GL_UNPACK_ALIGNMENT
+		s32 pitch = (width * 3 + 3) & ~3;
+
+		for(s32 y = 0; y < height; y++) {
+			u8* src = (u8*)pixels + y * pitch;
+			u8* dst = (u8*)(texture->pixels + y * width);
+
+			for(s32 x = 0; x < width; x++) {
+				dst[0] = src[0];
+				dst[1] = src[1];
+				dst[2] = src[2];
+				dst[3] = 255;
+
+				src += 3;
+				dst += 4;
+			}
+		}
+	}
+
+	return result;
+}
+
+void updateSoftwareTexture(SoftwareRenderer* software, GLuint texId, s32 x, s32 y, s32 width, s32 height, void* pixels, s32 pitch) {
+	SoftwareTexture* texture = software->textures + texId;
+	assert(texture->pixels);
+	assert(x >= 0 && y >= 0 && x + width <= texture->width && y + height <= texture->height);
+
+	for(s32 row = 0; row < height; row++) {
+		memcpy(texture->pixels + (y + row) * texture->width + x, (u8*)pixels + row * pitch, width * sizeof(u32));
+	}
+}
+
+void freeSoftwareTexture(SoftwareRenderer* software, GLuint texId) {
+	SoftwareTexture* texture = software->textures + texId;
+
+	free(texture->pixels);
+	texture->pixels = NULL;
+}
+
+//NOTE: The quads use the render state which is currently applied. This does the same work as the vertex shaders.
+void addSoftwareQuads(RenderGroup* group, BatchVertex* vertices, s32 numQuads) {
+	SoftwareRenderer* software = group->software;
+	RenderState* state = &group->appliedState;
+
+	float pixelsPerMeter = (float)group->pixelsPerMeter;
+
+	float offsetX = 0, offsetY = 0;
+
+	if(state->shader == &group->forwardShader.shader) {
+		offsetX = (float)state->cameraOffset.x;
+		offsetY = (float)state->cameraOffset.y;
+	}
+
+	s32 clipMinX = 0, clipMinY = 0, clipMaxX = software->width, clipMaxY = software->height;
+
+	if(state->scissorEnabled) {
+		R2 rect = state->scissorRect;
+
+		//NOTE: This is the same box as glScissor gets in applyScissorRect, before it is clamped to the framebuffer
+		s32 scissorX = (s32)(rect.min.x * pixelsPerMeter);
+		s32 scissorY = (s32)(rect.min.y * pixelsPerMeter);
+		s32 scissorWidth = (s32)(getRectWidth(rect) * pixelsPerMeter);
+		s32 scissorHeight = (s32)(getRectHeight(rect) * pixelsPerMeter);
+
+		clipMinX = max(clipMinX, scissorX);
+		clipMinY = max(clipMinY, scissorY);
+		clipMaxX = min(clipMaxX, scissorX + scissorWidth);
+		clipMaxY = min(clipMaxY, scissorY + scissorHeight);
+	}
+
+	for(s32 quadIndex = 0; quadIndex < numQuads; quadIndex++) {
+		BatchVertex* v = vertices + quadIndex * 4;
+
+		float px[4], py[4];
+		float minX = 0, minY = 0, maxX = 0, maxY = 0;
+
+		for(s32 vertexIndex = 0; vertexIndex < 4; vertexIndex++) {
+			px[vertexIndex] = (v[vertexIndex].p[0] - offsetX) * pixelsPerMeter;
+			py[vertexIndex] = (v[vertexIndex].p[1] - offsetY) * pixelsPerMeter;
+
+			if(vertexIndex == 0 || px[vertexIndex] < minX) minX = px[vertexIndex];
+			if(vertexIndex == 0 || py[vertexIndex] < minY) minY = py[vertexIndex];
+			if(vertexIndex == 0 || px[vertexIndex] > maxX) maxX = px[vertexIndex];
+			if(vertexIndex == 0 || py[vertexIndex] > maxY) maxY = py[vertexIndex];
+		}
+
+		//NOTE: The vertices go counter clockwise, so 1 and 3 are the ends of the edges which start at 0
+		float uX = px[1] - px[0], uY = py[1] - py[0];
+		float vX = px[3] - px[0], vY = py[3] - py[0];
+		float det = uX * vY - uY * vX;
+		if(fabs(det) < 1e-6f) continue;
+
+		SoftwareQuad quad = {};
+		quad.minX = max(clipMinX, (s32)floor(minX));
+		quad.minY = max(clipMinY, (s32)floor(minY));
+		quad.maxX = min(clipMaxX, (s32)ceil(maxX));
+		quad.maxY = min(clipMaxY, (s32)ceil(maxY));
+		if(quad.minX >= quad.maxX || quad.minY >= quad.maxY) continue;
+
+		float invDet = 1.0f / det;
+		quad.originX = px[0];
+		quad.originY = py[0];
+		quad.uRow[0] = vY * invDet;
+		quad.uRow[1] = -vX * invDet;
+		quad.vRow[0] = -uY * invDet;
+		quad.vRow[1] = uX * invDet;
+
+		quad.uvOrigin[0] = v[0].uv[0];
+		quad.uvOrigin[1] = v[0].uv[1];
+		quad.uvU[0] = v[1].uv[0] - v[0].uv[0];
+		quad.uvU[1] = v[1].uv[1] - v[0].uv[1];
+		quad.uvV[0] = v[3].uv[0] - v[0].uv[0];
+		quad.uvV[1] = v[3].uv[1] - v[0].uv[1];
+
+		memcpy(quad.color, v[0].color, sizeof(quad.color));
+		quad.texture = state->texture;
+
+		assert(software->numQuads < MAX_SOFTWARE_QUADS);
+		software->quads[software->numQuads++] = quad;
+	}
+}
+
+void drawSoftwareFrame(SoftwareRenderer* software) {
+	s32 numTiles = software->tilesWidth * software->tilesHeight;
+
+	for(s32 tileIndex = 0; tileIndex < numTiles; tileIndex++) {
+		software->tileRanges[tileIndex * 2 + 1] = 0;
+	}
+
+	for(s32 quadIndex = 0; quadIndex < software->numQuads; quadIndex++) {
+		SoftwareQuad* quad = software->quads + quadIndex;
+
+		for(s32 tileY = quad->minY / SOFTWARE_TILE_SIZE; tileY <= (quad->maxY - 1) / SOFTWARE_TILE_SIZE; tileY++) {
+			for(s32 tileX = quad->minX / SOFTWARE_TILE_SIZE; tileX <= (quad->maxX - 1) / SOFTWARE_TILE_SIZE; tileX++) {
+				software->tileRanges[(tileY * software->tilesWidth + tileX) * 2 + 1]++;
+			}
+		}
+	}
+
+	s32 numTileQuads = 0;
+
+	for(s32 tileIndex = 0; tileIndex < numTiles; tileIndex++) {
+		software->tileRanges[tileIndex * 2] = numTileQuads;
+		numTileQuads += software->tileRanges[tileIndex * 2 + 1];
+		software->tileRanges[tileIndex * 2 + 1] = 0;
+	}
+
+	assert(numTileQuads <= MAX_SOFTWARE_TILE_QUADS);
+
+	//NOTE: The quads are added in order, so each tile draws them in the order they were submitted
+	for(s32 quadIndex = 0; quadIndex < software->numQuads; quadIndex++) {
+		SoftwareQuad* quad = software->quads + quadIndex;
+
+		for(s32 tileY = quad->minY / SOFTWARE_TILE_SIZE; tileY <= (quad->maxY - 1) / SOFTWARE_TILE_SIZE; tileY++) {
+			for(s32 tileX = quad->minX / SOFTWARE_TILE_SIZE; tileX <= (quad->maxX - 1) / SOFTWARE_TILE_SIZE; tileX++) {
+				s32* range = software->tileRanges + (tileY * software->tilesWidth + tileX) * 2;
+				software->tileQuads[range[0] + range[1]++] = quadIndex;
+			}
+		}
+	}
+
+	SDL_AtomicSet(&software->nextTile, 0);
+
+	for(s32 threadIndex = 0; threadIndex < software->numThreads; threadIndex++) {
+		SDL_SemPost(software->workReady);
+	}
+
+	drawSoftwareTiles(software);
+
+	for(s32 threadIndex = 0; threadIndex < software->numThreads; threadIndex++) {
+		SDL_SemWait(software->workDone);
+	}
+
+	software->numQuads = 0;
+}
+
+void presentSoftwareFrame(SoftwareRenderer* software, SDL_Window* window) {
+	SDL_Surface* surface = SDL_GetWindowSurface(window);
+	assert(surface);
+
+	s32 width = min(software->width, surface->w);
+	s32 height = min(software->height, surface->h);
+
+	//NOTE: The framebuffer's first row is the bottom of the screen, so it is flipped while it is copied
+	for(s32 y = 0; y < height; y++) {
+		u32* src = software->framebuffer + (software->height - 1 - y) * software->width;
+		u8* dst = (u8*)surface->pixels + y * surface->pitch;
+
+		SDL_ConvertPixels(width, 1, SDL_PIXELFORMAT_ABGR8888, src, software->width * sizeof(u32),
+						  surface->format->format, dst, surface->pitch);
+	}
+
+	SDL_UpdateWindowSurface(window);
+}
@@ -356,7 +356,22 @@ void initInputKeyCodes(Input* input) {
 	#undef INIT_NUM_KEY
 }
 
-void pollInput(Input* input, bool* running, double windowHeight, double pixelsPerMeter, Camera* camera) {
+//NOTE: This is the largest part of a width by height window which has the aspect ratio of the logical size. 
+//		It is centered, so it is the same whether y goes up or down.
+SDL_Rect getLetterboxRect(s32 width, s32 height, double logicalWidth, double logicalHeight) {
+	SDL_Rect result = {};
+
+	double scale = min(width / logicalWidth, height / logicalHeight);
+
+	result.w = max(1, (s32)(logicalWidth * scale + 0.5));
+	result.h = max(1, (s32)(logicalHeight * scale + 0.5));
+	result.x = (width - result.w) / 2;
+	result.y = (height - result.h) / 2;
+
+	return result;
+}
+
+void pollInput(Input* input, bool* running, double windowWidth, double windowHeight, double pixelsPerMeter, Camera* camera) {
 	input->dMouseMeters = v2(0, 0);
 	input->mouseScroll = 0;
 
@@ -386,11 +401,24 @@ void pollInput(Input* input, bool* running, double windowHeight, double pixelsPe
 				}
 			} break;
 			case SDL_MOUSEMOTION: {
-				s32 mouseX = event.motion.x;
-				s32 mouseY = event.motion.y;
+				double mouseX = event.motion.x;
+				double mouseY = event.motion.y;
 
-				input->mouseInPixels.x = (double)mouseX;
-				input->mouseInPixels.y = (double)(windowHeight - mouseY);
+				//NOTE: The window can be resized, but the game is always drawn into the letterboxed part of it at 
+				//		windowWidth by windowHeight pixels
+				SDL_Window* window = SDL_GetWindowFromID(event.motion.windowID);
+
+				if(window) {
+					s32 actualWidth, actualHeight;
+					SDL_GetWindowSize(window, &actualWidth, &actualHeight);
+
+					SDL_Rect viewport = getLetterboxRect(actualWidth, actualHeight, windowWidth, windowHeight);
+					mouseX = (mouseX - viewport.x) * (windowWidth / viewport.w);
+					mouseY = (mouseY - viewport.y) * (windowHeight / viewport.h);
+				}
+
+				input->mouseInPixels.x = mouseX;
+				input->mouseInPixels.y = windowHeight - mouseY;
 
 				V2 mouseInMeters = input->mouseInPixels * (1.0 / pixelsPerMeter);
 
@@ -452,65 +480,96 @@ bool controlZJustPressed(Input* input) {
 	return result;
 }
 
-SDL_Window* createWindow(s32 windowWidth, s32 windowHeight) {
+//NOTE: The null backend does all of the renderer's work up to submitting the quads, so it can be used to time 
+//		command generation on its own. The software backend draws on the CPU. Neither of them needs a GL context,
+//		and the null backend doesn't need a window.
+enum RenderBackend {
+	RenderBackend_gl,
+	RenderBackend_null,
+	RenderBackend_software,
+};
+
+SDL_Window* createWindow(s32 windowWidth, s32 windowHeight, RenderBackend backend = RenderBackend_gl, u32 windowFlags = 0) {
 	//TODO: Proper error handling if any of these libraries does not load
 	
 	u32 initFlags = SDL_INIT_EVENTS|SDL_INIT_AUDIO;
 
+	//NOTE: Headless machines usually don't have an audio device either
+	if(backend == RenderBackend_null) {
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+	}
+
 	if (SDL_Init(initFlags) < 0) {
 		fprintf(stderr, "Failed to initialize SDL. Error: %s", SDL_GetError());
 		InvalidCodePath;
 	}
 
-	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
-	SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
+	SDL_Window* window = NULL;
+
+	if(backend == RenderBackend_software) {
+		window = SDL_CreateWindow("Hackformer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, windowFlags);
 
-	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
-	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+		if (!window) {
+			fprintf(stderr, "Failed to create window. Error: %s", SDL_GetError());
+			InvalidCodePath;
+		}
+	}
+	else if(backend == RenderBackend_gl) {
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
+		SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
 
-	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+		//NOTE: The renderer only uses vertex buffers and shaders, so it can run on a core profile context
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
 
-	SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
-	SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
-	SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
-	SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
+		SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 
-	#if 0
-	SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1); 
-	SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
-	#endif
+		SDL_GL_SetAttribute(SDL_GL_RED_SIZE, 8);
+		SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 8);
+		SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE, 8);
+		SDL_GL_SetAttribute(SDL_GL_ALPHA_SIZE, 8);
 
-	SDL_GL_SetSwapInterval(1); //Enables vysnc
+		#if 0
+		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1); 
+		SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
+		#endif
 
-	SDL_Window* window = SDL_CreateWindow("Hackformer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 
-										  windowWidth, windowHeight, 
-										  SDL_WINDOW_ALLOW_HIGHDPI|SDL_WINDOW_OPENGL);
+		SDL_GL_SetSwapInterval(1); //Enables vysnc
 
-	SDL_GLContext glContext = SDL_GL_CreateContext(window);
-	assert(glContext);
+		window = SDL_CreateWindow("Hackformer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 
+								  windowWidth, windowHeight, 
+								  SDL_WINDOW_ALLOW_HIGHDPI|SDL_WINDOW_OPENGL|windowFlags);
 
-	SDL_GL_SetSwapInterval(1); //Enables vysnc
+		SDL_GLContext glContext = SDL_GL_CreateContext(window);
+		assert(glContext);
 
-	glDisable(GL_DEPTH_TEST);
+		SDL_GL_SetSwapInterval(1); //Enables vysnc
+
+		glDisable(GL_DEPTH_TEST);
 
 #ifdef USE_GLEW
-	GLenum glewStatus = glewInit();
+		//NOTE: Otherwise glew doesn't load the vertex array functions on a core profile context
+		glewExperimental = GL_TRUE;
+		GLenum glewStatus = glewInit();
 
-	if (glewStatus != GLEW_OK) {
-		fprintf(stderr, "Failed to initialize glew. Error: %s\n", glewGetErrorString(glewStatus));
-		InvalidCodePath;
-	}
+		if (glewStatus != GLEW_OK) {
+			fprintf(stderr, "Failed to initialize glew. Error: %s\n", glewGetErrorString(glewStatus));
+			InvalidCodePath;
+		}
 #endif
 
 #ifdef HACKFORMER_MAC
-    glViewport(0, 0, windowWidth*2, windowHeight*2);
+	    glViewport(0, 0, windowWidth*2, windowHeight*2);
 #else    
-    glViewport(0, 0, windowWidth, windowHeight);
+	    glViewport(0, 0, windowWidth, windowHeight);
 #endif
 
-	if (!window) {
-		fprintf(stderr, "Failed to create window. Error: %s", SDL_GetError());
-		InvalidCodePath;
+		if (!window) {
+			fprintf(stderr, "Failed to create window. Error: %s", SDL_GetError());
+			InvalidCodePath;
+		}
 	}
 
 	if (TTF_Init()) {
@@ -525,6 +584,10 @@ struct Texture {
 	GLuint texId;
 	R2 uv;
 	V2 size;
+
+	//NOTE: The part of the frame which is stored in the texture, from 0 to 1. This is only smaller than the whole frame
+	//		for atlas textures which had their transparent borders trimmed off.
+	R2 trim;
 };
 
 enum BackgroundType {
@@ -538,8 +601,11 @@ struct BackgroundTexture {
 	AssetId bgId;
 	AssetId mgId;
 
+	//NOTE: These are the first strips of the layers (see BACKGROUND_STRIP_WIDTH)
 	Texture* bg;
 	Texture* mg;
+	s32 numBgStrips;
+	s32 numMgStrips;
 };
 
 struct BackgroundTextures {
@@ -582,16 +648,17 @@ void initBackgroundTextures(BackgroundTextures* bgTextures) {
 
 struct RenderGroup;
 Texture* loadPNGTexture(RenderGroup*, AssetId, bool = false);
+Texture* extractTextures(RenderGroup*, AssetId, s32 frameWidth, s32 frameHeight, s32 frameSpacing, s32* numFrames);
 
 void setBackgroundTexture(BackgroundTextures* bgTextures, BackgroundType type, RenderGroup* group) {
 	BackgroundTexture* bt = bgTextures->textures + type;
 
 	if(!bt->bg) {
-		bt->bg = loadPNGTexture(group, bt->bgId);
+		bt->bg = extractTextures(group, bt->bgId, BACKGROUND_STRIP_WIDTH, BACKGROUND_LAYER_HEIGHT, 0, &bt->numBgStrips);
 	}
 
 	if(!bt->mg) {
-		bt->mg = loadPNGTexture(group, bt->mgId);
+		bt->mg = extractTextures(group, bt->mgId, MIDDLEGROUND_STRIP_WIDTH, BACKGROUND_LAYER_HEIGHT, 0, &bt->numMgStrips);
 	}
 
 	bgTextures->curBackgroundType = type;
@@ -652,19 +719,36 @@ V2 getDrawSize(Texture* texture, double height) {
 void pushTexture(RenderGroup* group, Texture* texture, R2 bounds, bool flipX, bool flipY, DrawOrder drawOrder, bool moveIntoCameraSpace = false,
 	 		Orientation orientation = Orientation_0, Color color = WHITE, float emissivity = 0);
 
+//NOTE: The strips split bounds evenly, only the ones which are on screen are pushed
+void drawBackgroundLayer(RenderGroup* group, Texture* strips, s32 numStrips, R2 bounds, Camera* camera, V2 windowSize,
+						 DrawOrder drawOrder) {
+	double stripWidth = getRectWidth(bounds) / numStrips;
+	if(stripWidth <= 0) return;
+
+	s32 firstStrip = max(0, (s32)floor((camera->p.x - bounds.min.x) / stripWidth));
+	s32 endStrip = min(numStrips, (s32)ceil((camera->p.x + windowSize.x - bounds.min.x) / stripWidth));
+
+	for(s32 stripIndex = firstStrip; stripIndex < endStrip; stripIndex++) {
+		double stripX = bounds.min.x + stripIndex * stripWidth;
+		R2 stripBounds = r2(v2(stripX, bounds.min.y), v2(stripX + stripWidth, bounds.max.y));
+
+		pushTexture(group, strips + stripIndex, translateRect(stripBounds, -camera->p), false, false, drawOrder);
+	}
+}
+
 void drawBackgroundTexture(BackgroundTexture* backgroundTexture, RenderGroup* group, Camera* camera, V2 windowSize, double mapWidth) {
 	Texture* bg = backgroundTexture->bg;
 	Texture* mg = backgroundTexture->mg;
 
-	double bgTexWidth = (double)bg->size.x;
-	double mgTexWidth = (double)mg->size.x;
+	double bgTexWidth = (double)bg->size.x * backgroundTexture->numBgStrips;
+	double mgTexWidth = (double)mg->size.x * backgroundTexture->numMgStrips;
 	//double mgTexHeight = (double)mg->size.y;
 
 	double bgScrollRate = bgTexWidth / mgTexWidth;
 
 	double bgHeight = windowSize.y;
-	double bgWidth = getDrawSize(bg, bgHeight).x;
-	double mgWidth = getDrawSize(mg, bgHeight).x;
+	double bgWidth = getDrawSize(bg, bgHeight).x * backgroundTexture->numBgStrips;
+	double mgWidth = getDrawSize(mg, bgHeight).x * backgroundTexture->numMgStrips;
 
 	//double mgWidth = max(mapWidth, mgTexWidth);
 	//double bgWidth = mgWidth / bgScrollRate - 1;
@@ -674,8 +758,8 @@ void drawBackgroundTexture(BackgroundTexture* backgroundTexture, RenderGroup* gr
 	R2 bgBounds = r2(v2(bgX, 0), v2(bgWidth, bgHeight));
 	R2 mgBounds = r2(v2(0, 0), v2(mgWidth, bgHeight));
 
-	pushTexture(group, bg, translateRect(bgBounds, -camera->p), false, false, DrawOrder_background);
-	pushTexture(group, mg, translateRect(mgBounds, -camera->p), false, false, DrawOrder_middleground);
+	drawBackgroundLayer(group, bg, backgroundTexture->numBgStrips, bgBounds, camera, windowSize, DrawOrder_background);
+	drawBackgroundLayer(group, mg, backgroundTexture->numMgStrips, mgBounds, camera, windowSize, DrawOrder_middleground);
 }
 
 struct IOStream {
@@ -1,16 +1,18 @@
-#version 110
+#version 330 core
 
 uniform sampler2D diffuseTexture;
-uniform vec4 tint;
 
-varying vec2 texCoord;
+in vec2 texCoord;
+in vec4 tint;
+
+out vec4 fragColor;
 
 void main() {
-	vec4 texColor = texture2D(diffuseTexture, texCoord);
+	vec4 texColor = texture(diffuseTexture, texCoord);
 	
 	vec3 gamma = vec3(1.0 / 2.2);
 	vec3 result = pow(texColor.xyz, gamma); 
 
-	gl_FragColor = vec4(result.xyz * tint.xyz, texColor.a * tint.a);
+	fragColor = vec4(result.xyz * tint.xyz, texColor.a * tint.a);
 }
 //end
\ No newline at end of file
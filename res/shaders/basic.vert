@@ -1,13 +1,20 @@
-#version 110 
+#version 330 core
 
 uniform vec2 twoOverScreenSize;
 
-varying vec2 texCoord;
+in vec2 p;
+in vec2 uv;
+in vec4 color;
+in float emissivity;
+
+out vec2 texCoord;
+out vec4 tint;
 
 void main() {
-    texCoord = gl_MultiTexCoord0.xy;
+    texCoord = uv;
+    tint = color;
 
-	vec2 pos = gl_Vertex.xy * twoOverScreenSize - vec2(1.0, 1.0);
+	vec2 pos = p * twoOverScreenSize - vec2(1.0, 1.0);
 	gl_Position = vec4(pos, 0.0, 1.0);
 }
 //end
\ No newline at end of file
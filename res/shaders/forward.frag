@@ -1,74 +1,73 @@
-#version 110
+#version 330 core
 
-#define NUM_POINT_LIGHTS 8
-#define NUM_SPOT_LIGHTS 8
+//NOTE: Each light is 3 texels, (p, range), (color, cutoff) and (dir, 0, 0)
+uniform samplerBuffer lightData;
 
-struct PointLight {
-	vec3 p;
-	vec3 color;
-	float range;
-};
+//NOTE: The (offset, count) into lightIndices of each screen tile
+uniform isamplerBuffer lightTiles;
+uniform isamplerBuffer lightIndices;
 
-struct SpotLight {
-	PointLight base;
-	vec2 dir;
-	float cutoff;
-};
+uniform float lightTileSize;
+uniform ivec2 lightTilesSize;
+uniform bool lightingEnabled;
 
-uniform PointLight pointLights[NUM_POINT_LIGHTS];
-uniform SpotLight spotLights[NUM_SPOT_LIGHTS];
 uniform vec3 ambient;
 
 uniform sampler2D diffuseTexture;
 
-uniform vec4 tint;
+in vec2 texCoord;
+in vec2 worldP;
+in vec4 tint;
+in float texEmissivity;
 
-varying vec2 texCoord;
-varying vec2 worldP;
+out vec4 fragColor;
 
 void main() {
-	vec4 texColor = texture2D(diffuseTexture, texCoord);
+	vec4 texColor = texture(diffuseTexture, texCoord);
 
-	vec3 result = ambient;
+	vec3 result = ambient + (vec3(1.0) - ambient) * texEmissivity;
 
-	for(int lightIndex = 0; lightIndex < NUM_POINT_LIGHTS; lightIndex++) {
-		vec3 lightDir = vec3(worldP, 0.0) - pointLights[lightIndex].p;
+	if(lightingEnabled) {
+		ivec2 tile = clamp(ivec2(worldP / lightTileSize), ivec2(0, 0), lightTilesSize - ivec2(1, 1));
+		ivec2 tileLights = texelFetch(lightTiles, tile.x + tile.y * lightTilesSize.x).xy;
 
-		float lightDistanceSquared = (lightDir.x * lightDir.x) + (lightDir.y * lightDir.y) + (lightDir.z * lightDir.z);
-		float lightDistance = sqrt(lightDistanceSquared);
+		for(int tileLightIndex = 0; tileLightIndex < tileLights.y; tileLightIndex++) {
+			int lightIndex = texelFetch(lightIndices, tileLights.x + tileLightIndex).x;
 
-		float intensity = max(0.0, (pointLights[lightIndex].range - lightDistance) / pointLights[lightIndex].range);
+			vec4 pRange = texelFetch(lightData, lightIndex * 3);
+			vec4 colorCutoff = texelFetch(lightData, lightIndex * 3 + 1);
 
-		result += pointLights[lightIndex].color * intensity;
-	}
+			vec3 lightDir = vec3(worldP, 0.0) - pRange.xyz;
+			float lightDistance = length(lightDir);
 
-	for(int lightIndex = 0; lightIndex < NUM_SPOT_LIGHTS; lightIndex++) {
-		vec3 spotLightP = spotLights[lightIndex].base.p;
-		vec3 lightDir = vec3(worldP, 0.0) - spotLightP;
+			float intensity = max(0.0, (pRange.w - lightDistance) / pRange.w);
 
-		float lightDistanceSquared = (lightDir.x * lightDir.x) + (lightDir.y * lightDir.y) + (lightDir.z * lightDir.z);
-		float lightDistance = sqrt(lightDistanceSquared);
-		lightDir *= (1.0 / lightDistance);
+			//NOTE: Point lights have a cutoff of -2
+			if(colorCutoff.w > -1.0) {
+				vec2 spotDir = texelFetch(lightData, lightIndex * 3 + 2).xy;
+				lightDir *= (1.0 / lightDistance);
 
-		float intensity = max(0.0, (spotLights[lightIndex].base.range - lightDistance) / spotLights[lightIndex].base.range);
+				float conePercent = spotDir.x * lightDir.x + spotDir.y * lightDir.y;
+				intensity *= max(0.0, (conePercent - colorCutoff.w) / (1.0 - colorCutoff.w));
+			}
 
-		float conePercent = spotLights[lightIndex].dir.x * lightDir.x + spotLights[lightIndex].dir.y * lightDir.y;
-		float brightness = max(0.0, (conePercent - spotLights[lightIndex].cutoff) / (1.0 - spotLights[lightIndex].cutoff));
-		
-		result += spotLights[lightIndex].base.color * (brightness * intensity);
+			result += colorCutoff.rgb * intensity;
+		}
 	}
 
 	result *= result * result;
 	//result = clamp(result, vec3(0.0), vec3(1.0));
 
-#if 0 
-	//NOTE: This does the lighting in srgb space
-	vec3 gamma = vec3(1.0 / 2.2);
-	vec3 gammaCorrectedDiffuse = pow(texColor.xyz, gamma) * tint.xyz;
-	result *= gammaCorrectedDiffuse; 
+	if(lightingEnabled) {
+		//NOTE: This does the lighting in srgb space
+		vec3 gamma = vec3(1.0 / 2.2);
+		vec3 gammaCorrectedDiffuse = pow(texColor.xyz, gamma) * tint.xyz;
+		result *= gammaCorrectedDiffuse; 
+
+		fragColor = vec4(result, texColor.a * tint.a);
+		return;
+	}
 
-	gl_FragColor = vec4(result, texColor.a * tint.a);
-#else 
 	result = texColor.xyz * tint.xyz; 
 	vec3 gamma = vec3(1.0 / 2.2);
 	vec3 gammaCorrectedResult = pow(result.xyz, gamma);
@@ -77,9 +76,8 @@ void main() {
 	//gammaCorrectedResult.y = gammaCorrectedResult.y / (gammaCorrectedResult.y + 1.0);
 	//gammaCorrectedResult.z = gammaCorrectedResult.z / (gammaCorrectedResult.z + 1.0);
 
-	gl_FragColor = vec4(gammaCorrectedResult, texColor.a * tint.a);
-#endif
+	fragColor = vec4(gammaCorrectedResult, texColor.a * tint.a);
 
-    //gl_FragColor = vec4(normal * 0.5 + vec3(0.5), texColor.a);
+    //fragColor = vec4(normal * 0.5 + vec3(0.5), texColor.a);
 }
 //end
\ No newline at end of file
@@ -1,16 +1,29 @@
-#version 110 
+#version 330 core
 
 uniform vec2 twoOverScreenSize;
+uniform vec2 cameraOffset;
+uniform float glowTime;
 
-//attribute vec4 gl_Vertex;
-//attribute vec4 gl_MultiTexCoord0;
+in vec2 p;
+in vec2 uv;
+in vec4 color;
+in float emissivity;
 
-varying vec2 texCoord;
-varying vec2 worldP;
+out vec2 texCoord;
+out vec2 worldP;
+out vec4 tint;
+out float texEmissivity;
 
 void main() {
-    worldP = gl_Vertex.xy;
-    texCoord = gl_MultiTexCoord0.xy;
+    worldP = p - cameraOffset;
+    texCoord = uv;
+    tint = color;
+    texEmissivity = emissivity;
+
+    //NOTE: A negative emissivity is -1 - the phase of a glowing tile in a static mesh
+    if(emissivity < 0.0) {
+        texEmissivity = (sin(glowTime - emissivity - 1.0) + 1.0) * 0.5;
+    }
 
 	vec2 pos = worldP * twoOverScreenSize - vec2(1.0, 1.0);
 	gl_Position = vec4(pos, 0.0, 1.0);
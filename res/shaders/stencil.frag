@@ -1,12 +1,14 @@
-#version 110
+#version 330 core
 
 uniform sampler2D stencilTexture;
-uniform vec4 tint;
 
-varying vec2 texCoord;
+in vec2 texCoord;
+in vec4 tint;
+
+out vec4 fragColor;
 
 void main() {
-	vec4 stencilColor = texture2D(stencilTexture, texCoord);
-	gl_FragColor = stencilColor * tint;
+	vec4 stencilColor = texture(stencilTexture, texCoord);
+	fragColor = stencilColor * tint;
 }
 //end
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 330 core
+
+uniform sampler2D diffuseTexture;
+
+in vec2 texCoord;
+in vec4 tint;
+
+out vec4 fragColor;
+
+void main() {
+	//NOTE: The scene was already gamma corrected when it was drawn into the texture
+	fragColor = vec4(texture(diffuseTexture, texCoord).xyz, 1.0);
+}
+//end
\ No newline at end of file